@@ -41,8 +41,8 @@ fzgraphsearch fzgs;
  * For `add_usage_top`, add command line option usage format specifiers.
  */
 fzgraphsearch::fzgraphsearch() : formalizer_standard_program(false), config(*this) { //ga(*this, add_option_args, add_usage_top)
-    add_option_args += "s:l:i:I:zc:C:m:M:t:T:rRp:P:b:d:D:S:B:N:F:f:X:";
-    add_usage_top += " [-s <search-string>] [-z] [-i <date-time>] [-I <date-time>] [-c <comp_min>] [-C <comp_max>] [-m <mins_min>]"
+    add_option_args += "s:aol:i:I:zc:C:m:M:t:T:rRp:P:b:d:D:S:B:N:F:f:X:";
+    add_usage_top += " [-s <search-string>] [-a|-o] [-z] [-i <date-time>] [-I <date-time>] [-c <comp_min>] [-C <comp_max>] [-m <mins_min>]"
                      " [-M <mins_max>] [-t <TD_min>] [-T <TD_max>] [-p <tdprop_1>] [-P <tdprop_2>] [-b <tdprop-list>] [-r|-R]"
                      " [-d <tdpatt_1>] [-D <tdpatt_2>] [-S <sup-spec>] [-B <top-node>] [-N <listname>] [-F <BTF-category>] [-f <BTF-NNL>]"
                      " [-X <N[:order]]"
@@ -61,6 +61,8 @@ void fzgraphsearch::usage_hook() {
     //ga.usage_hook();
     FZOUT("    -l Named Node List to receive the search results.\n"
           "    -s Description contains <search-string>.\n"
+          "    -a Description contains all space separated terms of <search-string>.\n"
+          "    -o Description contains any space separated term of <search-string>.\n"
           "    -z Not case sensitive.\n"
           "    -i Nodes created from <date-time>.\n"
           "    -I Nodes created through <date-time>.\n"
@@ -215,6 +217,16 @@ bool fzgraphsearch::options_hook(char c, std::string cargs) {
         return true;
     }
 
+    case 'a': {
+        nodefilter.text_mode = text_match_all_terms;
+        return true;
+    }
+
+    case 'o': {
+        nodefilter.text_mode = text_match_any_term;
+        return true;
+    }
+
     case 'z': {
         nodefilter.case_sensitive = false;
         return true;
@@ -326,6 +326,20 @@ void onopen_onclose::try_call() {
     }
 }
 
+/**
+ * Note that the Log in the database was modified, so that a resident Log
+ * server is notified when fzlog exits (see notify_Log_server_on_exit()).
+ * 
+ * This is called right after each successful Log database write, so that
+ * the notification also happens if fzlog exits with an error afterwards.
+ * 
+ * @param tail_only If true, only the newest Log chunks were modified.
+ */
+void Log_modified(bool tail_only) {
+    fzl.log_modified = true;
+    fzl.log_modified_tail_only &= tail_only;
+}
+
 void check_specific_node(entry_data & edata) {
     if (edata.specific_node_id.empty()) {
         edata.node_ptr = nullptr;
@@ -408,6 +422,7 @@ bool replace_entry(entry_data & edata) {
     if (!update_Log_entry_pq(*new_entry, fzl.ga)) {
         standard_exit_error(exit_database_error, "Unable to update Log entry", __func__);
     }
+    Log_modified(false);
     VERBOSEOUT("Log entry "+new_entry->get_id_str()+" modified.\n");
 
     return true;
@@ -467,6 +482,7 @@ bool make_entry(entry_data & edata) {
     if (!append_Log_entry_pq(*new_entry, fzl.ga)) {
         standard_exit_error(exit_database_error, "Unable to append Log entry", __func__);
     }
+    Log_modified(true);
     VERBOSEOUT("Log entry "+new_entry->get_id_str()+" appended.\n");
 
     return true;
@@ -524,6 +540,7 @@ bool insert_entry(entry_data & edata) {
     if (!insert_Log_entry_pq(*new_entry, fzl.ga)) {
         standard_exit_error(exit_database_error, "Unable to insert Log entry", __func__);
     }
+    Log_modified(false);
     VERBOSEOUT("Log entry "+new_entry->get_id_str()+" inserted.\n");
 
     return true;
@@ -568,6 +585,7 @@ bool delete_entry(entry_data & edata) {
     if (!delete_Log_entry_pq(*edata.e_newest, fzl.ga)) {
         standard_exit_error(exit_database_error, "Unable to delete Log entry", __func__);
     }
+    Log_modified(false);
     VERBOSEOUT("Log entry "+edata.e_newest->get_id_str()+" deleted.\n");
 
     return true;
@@ -590,6 +608,41 @@ bool port_API_request(const std::string api_url) {
     return true;
 }
 
+/**
+ * Let a running memory-resident Log server (fzserverpq-log) know that the
+ * Log in the database was modified.
+ * 
+ * This is best-effort. If no Log server is running then there is nothing
+ * to do, and a failed notification only produces a warning, since the
+ * database modification itself succeeded.
+ * 
+ * @param tail_only If true, only the newest Log chunks were modified.
+ * @return True if there was no Log server or the notification succeeded.
+ */
+bool notify_Log_server(bool tail_only) {
+    uint16_t port_number;
+    if (!find_Log_server(port_number)) {
+        return true;
+    }
+
+    std::string api_url(tail_only ? "/fz/log/refresh" : "/fz/log/reload");
+    VERYVERBOSEOUT("Notifying Log server: "+api_url+'\n');
+    std::string response_str;
+    if (!http_GET("127.0.0.1", port_number, api_url, response_str)) {
+        ADDWARNING(__func__, "Log server notification failed: "+api_url);
+        return false;
+    }
+
+    return true;
+}
+
+/// Exit hook that notifies a resident Log server if the Log was modified.
+void notify_Log_server_on_exit() {
+    if (fzl.log_modified) {
+        notify_Log_server(fzl.log_modified_tail_only);
+    }
+}
+
 bool update_Node_completion(const std::string & node_idstr, time_t add_seconds) {
     if (add_seconds <= 0) {
         return true; // nothing to add
@@ -824,6 +877,7 @@ bool close_chunk(time_t closing_time) {
     if (!close_Log_chunk_pq(*fzl.edata.c_newest, fzl.ga)) {
         standard_exit_error(exit_database_error, "Unable to close Log chunk "+fzl.edata.c_newest->get_tbegin_str(), __func__);
     }
+    Log_modified(true);
 
     if (!fzl.edata.c_newest) {
         standard_exit_error(exit_missing_data, "Unable to obtain Node of closed Log chunk, because Log chunk pointer is null pointer.", __func__);
@@ -894,6 +948,7 @@ bool reopen_chunk() {
     if (!close_Log_chunk_pq(*fzl.edata.c_newest, fzl.ga)) {
         standard_exit_error(exit_database_error, "Unable to reopen Log chunk "+fzl.edata.c_newest->get_tbegin_str(), __func__);
     }
+    Log_modified(true);
 
     if (!fzl.edata.c_newest) {
         standard_exit_error(exit_missing_data, "Unable to obtain Node of reopened Log chunk, because Log chunk pointer is null pointer.", __func__);
@@ -985,6 +1040,7 @@ bool replace_chunk_close(time_t t_close_new) {
     if (!close_Log_chunk_pq(chunk_container, fzl.ga)) {
         standard_exit_error(exit_database_error, "Unable to modify Log chunk "+fzl.chunk_id_str+" in database", __func__);
     }
+    Log_modified(false);
 
     VERBOSEOUT("Log chunk "+fzl.chunk_id_str+" close-time modified to "+TimeStampYmdHM(t_close_new)+".\n");
 
@@ -1074,6 +1130,7 @@ bool replace_chunk_open(time_t t_open_new) {
     if (!modify_Log_chunk_id_pq(*chunk_ptr, t_open_new, fzl.ga)) {
         standard_exit_error(exit_database_error, "Unable to modify Log chunk "+fzl.chunk_id_str+" in database", __func__);
     }
+    Log_modified(false);
 
     VERBOSEOUT("Log chunk "+fzl.chunk_id_str+" open-time (ID) modified to "+TimeStampYmdHM(t_open_new)+".\n");
 
@@ -1119,6 +1176,7 @@ bool replace_chunk_node(const std::string & chunk_id_str) {
     if (!modify_Log_chunk_nid_pq(chunk, fzl.ga)) {
         standard_exit_error(exit_database_error, "Unable to modify Log chunk "+chunk.get_tbegin_str(), __func__);
     }
+    Log_modified(false);
 
     VERBOSEOUT("Log chunk "+chunk.get_tbegin_str()+" modified.\n");
     std::cout.flush();
@@ -1227,6 +1285,7 @@ bool insert_chunk(entry_data & edata) {
     if (!insert_Log_chunk_pq(*new_chunk, fzl.ga)) {
         standard_exit_error(exit_database_error, "Unable to insert Log chunk", __func__);
     }
+    Log_modified(false);
     VERBOSEOUT("Log chunk "+new_chunk->get_tbegin_str()+" inserted.\n");
 
     return true;
@@ -1290,6 +1349,7 @@ bool open_chunk() {
     if (!append_Log_chunk_pq(new_chunk, fzl.ga)) {
         standard_exit_error(exit_database_error, "Unable to append Log chunk", __func__);
     }
+    Log_modified(true);
     VERBOSEOUT("Log chunk "+new_chunk.get_tbegin_str()+" appended.\n");
     // auto t4 = std::chrono::high_resolution_clock::now(); // PROFILING (remove this)
     // profiling_us.emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(t4 - t3).count()); // PROFILING (remove this)
@@ -1322,6 +1382,9 @@ int main(int argc, char *argv[]) {
 
     fzl.init_top(argc, argv);
 
+    // Any Log modifications are announced on every path to exit, including errors.
+    standard.add_to_exit_stack(&notify_Log_server_on_exit, "notify_Log_server_on_exit");
+
     switch (fzl.flowcontrol) {
 
     case flow_make_entry: {
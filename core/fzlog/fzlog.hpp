@@ -69,6 +69,9 @@ struct fzlog: public formalizer_standard_program {
 
     bool override_precautions = false;
 
+    bool log_modified = false;          ///< set by Log_modified() after a successful Log database write
+    bool log_modified_tail_only = true; ///< only the newest Log chunks were modified
+
     fzlog();
 
     virtual void usage_hook();
@@ -36,7 +36,7 @@ fzquerypq fzq;
 fzquerypq::fzquerypq() : formalizer_standard_program(true), output_format(output_txt), ga(*this, add_option_args, add_usage_top, true), flowcontrol(flow_unknown) {
     COMPILEDPING(std::cout, "PING-fzquerypq().1\n");
     add_option_args += "n:F:R:Z:T";
-    add_usage_top += " [-n <Node-ID>] [-F txt|html] [-R histories] [-Z <serialized-request>] [-T]";
+    add_usage_top += " [-n <Node-ID>] [-F txt|html] [-R histories|compacthistories|namedlists|logsearch] [-Z <serialized-request>] [-T]";
 }
 
 void fzquerypq::usage_hook() {
@@ -48,7 +48,9 @@ void fzquerypq::usage_hook() {
           "       html = HTML template\n"
           "    -R refresh:\n"
           "         histories = Node histories cache table\n"
+          "         compacthistories = sort and deduplicate Node histories cache table\n"
           "         namedlists = Named Node Lists cache table\n"
+          "         logsearch = Log entry text index\n"
           "    -Z make serialized data request <serialized_request> (see fzserverpq -h)\n"
           "    -T show current time time-stamp in Formalizer format and UNIX epoch seconds\n"
     );
@@ -89,10 +91,18 @@ bool fzquerypq::options_hook(char c, std::string cargs) {
             flowcontrol = flow_refresh_histories;
             return true;
         }
+        if (cargs=="compacthistories") {
+            flowcontrol = flow_compact_histories;
+            return true;
+        }
         if (cargs=="namedlists") {
             flowcontrol = flow_refresh_namedlists;
             return true;
         }
+        if (cargs=="logsearch") {
+            flowcontrol = flow_refresh_logsearch;
+            return true;
+        }
         return standard_error("Unknown option -R "+cargs, __func__);
     }
 
@@ -155,11 +165,21 @@ int main(int argc, char *argv[]) {
         break;
     }
 
+    case flow_compact_histories: {
+        compact_Node_histories_cache_table();
+        break;
+    }
+
     case flow_refresh_namedlists: {
         refresh_Named_Node_Lists_cache_table();
         break;
     }
 
+    case flow_refresh_logsearch: {
+        refresh_Log_search_index();
+        break;
+    }
+
     case flow_serialized_request: {
         make_serialized_data_API_request();
         break;
@@ -26,6 +26,8 @@ enum flow_options {
     flow_refresh_namedlists = 3, /// refresh Named Node Lists cache table
     flow_serialized_request = 4, /// make serialized data API request
     flow_formalizer_time = 5,    /// show current time in Formalizer time-stamp format and UNIX epoch seconds
+    flow_refresh_logsearch = 6,  /// rebuild Log entry text index
+    flow_compact_histories = 7,  /// sort and deduplicate Node histories cache table
     flow_NUMoptions
 };
 
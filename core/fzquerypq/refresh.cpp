@@ -40,6 +40,16 @@ void refresh_Node_histories_cache_table() {
     VERBOSEOUT(histories_refresh_note);
 }
 
+void compact_Node_histories_cache_table() {
+    ERRTRACE;
+    VERBOSEOUT("Compacting Node histories cache table...\n");
+    if (!compact_Node_history_cache_pq(fzq.ga)) {
+        standard_error("Unable to compact Node histories cache table." , __func__);
+        return;
+    }
+    VERBOSEOUT("Done.\n");
+}
+
 const char * nnl_refresh_note = R"NOTE(
 Done.
 
@@ -59,3 +69,13 @@ void refresh_Named_Node_Lists_cache_table() {
     }
     VERBOSEOUT(nnl_refresh_note);
 }
+
+void refresh_Log_search_index() {
+    ERRTRACE;
+    VERBOSEOUT("Rebuilding Log entry text index...\n");
+    if (!refresh_Log_text_index_pq(fzq.ga)) {
+        standard_error("Unable to rebuild Log entry text index." , __func__);
+        return;
+    }
+    VERBOSEOUT("Done.\n");
+}
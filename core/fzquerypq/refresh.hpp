@@ -14,6 +14,10 @@
 
 void refresh_Node_histories_cache_table();
 
+void compact_Node_histories_cache_table();
+
 void refresh_Named_Node_Lists_cache_table();
 
+void refresh_Log_search_index();
+
 #endif // __REFRESH_HPP
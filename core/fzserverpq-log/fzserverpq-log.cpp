@@ -20,12 +20,14 @@
 #include "general.hpp"
 #include "stringio.hpp"
 #include "proclock.hpp"
+#include "TimeStamp.hpp"
+#include "Logtypes.hpp"
+#include "Logpostgres.hpp"
 
 // local
 #include "version.hpp"
 #include "fzserverpq-log.hpp"
-// *** #include "shm_server_handlers.hpp"
-// *** #include "tcp_server_handlers.hpp"
+#include "tcp_server_handlers.hpp"
 
 
 using namespace fz;
@@ -35,109 +37,59 @@ fzserverpqlog fzsl;
 
 static const char usage_tail_str_A[] = R"UTAIL(
 The limited number of command line options are generally used only to start
-the server. The server interacts with clients through the combination of a
-TCP socket at the specified port and shared memory data exchanges.
+the server. The server holds the Log in memory and interacts with clients
+through a TCP socket at the specified port.
 
 API AT TCP TOP LEVEL
 --------------------
 The following are recognized requests:
 
   'GET '   followed by a path such as '/fz/status', browser HTTP-like request
-  'PATCH ' is much like GET, but used to request a modification
-  'FZ '    followed by request directives, serialized data request
-  'STOP'   stops and terminates the server (`fzlog -z` sends this)
+  'STOP'   stops and terminates the server
   'PING'   requests a readiness response from the server
 
-Any other string read at the socket is interpreted as the name of a shared
-memory segment that contains a Log_modifications object named 'logmod'
-with a stack of modification requests.
-
-API USING 'GET' AND 'PATCH' REQUESTS
-------------------------------------
+API USING 'GET' REQUESTS
+------------------------
 The '/fz/' paths are special Formalizer handles for which the response
-content in HTML format is generated dynamically. (This is somewhat analogous
-to file content read at /proc.)
+content is generated dynamically. (This is somewhat analogous to file
+content read at /proc.)
 
-The GET/PATCH port API includes the following:
+The GET port API includes the following:
 
   /fz/status
+  /fz/ipport
   /fz/ErrQ
   /fz/ReqQ
   /fz/_stop
   /fz/verbosity?set=<normal|quiet|very>
-  /fz/db/mode
-  /fz/db/mode?set=<run|log|sim>
-  /fz/log/logtime?<node-id>=<mins>[&T=<emulated-time>]
-  /fz/log/chunks/logtime?<node-id>=<mins>[&T=<emulated-time>]
-  /fz/log/chunks/<chunk-id>?(TBD)
-  /fz/log/chunks/<chunk-id>/(TBD)
-  /fz/log/namedlists/<list-name>?add=<entry-id>[&FEATURES/MAXSIZE]
-  /fz/log/namedlists/<list-name>?remove=<entry-id>
-  /fz/log/namedlists/<list-name>?delete=
-  /fz/log/namedlists/<list-name>?copy=<from_name>[&from_max=N][&to_max=M]
-  /fz/log/namedlists/_select?id=<entry-id>
-  /fz/log/namedlists/_set?persistent=
-  /fz/log/namedlists/_reload
-
-Note A: The 'persistent' switch is only available through port requests and
-        through the configuration file. There is no command line option.
-Note C: Both <list-name>?add and <list-name>?copy can receive optional
-        arguments to specify FEATURES and MAXSIZE if the <list-name> is new.
-        The available specifiers are:
-          [&maxsize=N], [&unique=true|false], [&fifo=true|false],
-          [&prepend=true|false]
-Note D: Using the direct TCP-port API, absolute URLs are translated so that
-        the root '/' is at the actual filesystem location specified by the
-        configuration variable 'www_file_root'. It presently evaluates to
-        )UTAIL";
+  /fz/log/excerpt?[from=<epoch-time>][&to=<epoch-time>][&node=<node-id>]
+                  [&limit=<n>][&back=true][&chunks_only=true]
+  /fz/log/minutes?[to=<epoch-time>&]nodes=<node-id>[,<node-id>...]
+  /fz/log/refresh
+  /fz/log/reload
+
+Note A: A Log excerpt contains the same Log chunks and entries that would be
+        loaded from the database with the same Log filter, e.g. an interval,
+        the n most recent chunks (limit=n&back=true), or the history of a
+        Node (node=<node-id>, optionally with limit=n). The response is in a
+        serialized format intended for rapid communication, not for display.
+        Programs that use Graph_access::request_Log_excerpt() obtain their
+        Log excerpts here automatically while this server is running.
+        Similarly, /fz/log/minutes returns a line `<node-id> <minutes>` with
+        the total time logged in the history of each Node (see
+        Graph_access::request_Nodes_logged_minutes()).
+Note B: fzlog requests /fz/log/refresh after appending to the Log, which
+        reloads only the newest Log chunks from the database. Modifications
+        elsewhere in the Log are applied with /fz/log/reload.
+Note C: When the server exits, the log of requests received (ReqQ) is
+        flushed to: )UTAIL";
 static const char usage_tail_str_B[] = R"UTAIL(.
 
-API USING 'FZ' REQUEST
-----------------------
-The API requests are in many ways similar to those used with 'GET' or 'PATCH',
-but the response is a serialized data format intended for rapid communication,
-not for formatted display.
-
-Recognized requests are:
-
-  NELlen(list-name)
-    Returns the number of Entries in NEL 'list-name' (or 0).
-  entries_match(node=node-id,lower_t_open=202101292346,upper_t_open=202101292346)
-    Returns a comma-separated list of Entries matching specified conditions.
-    Recognized filter arguments are: node, chunkminutes, lower_chunkminutes,
-    upper_chunkminutes, t_open, lower_t_open, upper_t_open.
-    The special t_open times 'NOW', 'MIN' and 'MAX' are also recognized.
-    The singular (not lower_ or upper_) arguments can take one value that
-    is applied to both bounds, or can take a range, e.g. '[MIN,NOW]'.
-  NELadd_match(a_list,t_open=[202101292346,202101292346])
-    Adds to `a_list` the Entries that match specified conditions and returns
-    the number that were added.
-  NELedit_nodes(extreme_intervals,node,20171128203820.1)
-    Edit the specified parameter (e.g. node) to the specified value
-    (e.g. 20171128203820.1) on all Entries in the specified List (e.g.
-    extreme_intervals).
-
-FZ serialized data requests can be batched via simple concatenation, e.g.:
-
-  FZ NELlen(burningman);NNLlen(workshops)
-
-Extra spacing and a terminating semicolon are possible and ignored.
-
-Any TCP client, TCP library function, or a special-purpose Formalizer query
-utility can be used to make FZ requests. Some examples:
-
-  |~$ nc 127.0.0.1 8091
-  |FZ NELlen(burningman);NELlen(workshops)
-
-  |~$ fzquerypq -Z -p 8091 'NNLlen(dependencies);NNLlen(superiors)'
-
-  |~$ python3
-  |>> import socket
-  |>> s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
-  |>> s.connect(("127.0.0.1",8091))
-  |>> s.send('NELlen(burningman);NELlen(workshops)'.encode()) 
-  |>> data = ''
-  |>> data = s.recv(1024).decode()
+Examples:
+
+  |~$ curl 'http://127.0.0.1:8091/fz/log/excerpt?limit=5&back=true'
+
+  |~$ curl http://127.0.0.1:8091/fz/status
 )UTAIL";
 
 
@@ -145,10 +97,10 @@ utility can be used to make FZ requests. Some examples:
  * For `add_option_args`, add command line option identifiers as expected by `optarg()`.
  * For `add_usage_top`, add command line option usage format specifiers.
  */
-fzserverpqlog::fzserverpqlog() : formalizer_standard_program(false), config(*this), flowcontrol(flow_unknown), log_ptr(nullptr), ReqQ(config.reqqfilepath) { //ga(*this, add_option_args, add_usage_top)
+fzserverpqlog::fzserverpqlog() : formalizer_standard_program(false), config(*this), flowcontrol(flow_unknown), ga(*this, add_option_args, add_usage_top, true), ReqQ(config.reqqfilepath) {
     add_option_args += "lp:L:";
     add_usage_top += " [-l] [-p <port-number>] [-L <request-log>]";
-    usage_tail.push_back(usage_tail_str_A+fzsl.config.www_file_root+usage_tail_str_B);
+    usage_tail.push_back(usage_tail_str_A+config.request_log+usage_tail_str_B);
 }
 
 /**
@@ -156,7 +108,7 @@ fzserverpqlog::fzserverpqlog() : formalizer_standard_program(false), config(*thi
  * help for program specific command line options.
  */
 void fzserverpqlog::usage_hook() {
-    //ga.usage_hook();
+    ga.usage_hook();
     FZOUT("    -l Load Log and stay resident in memory\n"
           "    -p Specify <port-number> on which the sever will listen\n"
           "    -L Log requests received in <request-log> (or STDOUT), currently set\n"
@@ -174,8 +126,8 @@ void fzserverpqlog::usage_hook() {
  * @param cargs is the optional parameter value provided for the option.
  */
 bool fzserverpqlog::options_hook(char c, std::string cargs) {
-    //if (ga.options_hook(c,cargs))
-    //    return true;
+    if (ga.options_hook(c,cargs))
+        return true;
 
     switch (c) {
 
@@ -200,8 +152,10 @@ bool fzsl_configurable::set_parameter(const std::string & parlabel, const std::s
     // *** You could also implement try-catch here to gracefully report problems with configuration files.
     CONFIG_TEST_AND_SET_PAR(port_number, "port_number", parlabel, std::stoi(parvalue));
     CONFIG_TEST_AND_SET_PAR(persistent_NEL, "persistent_NEL", parlabel, (parvalue != "false"));
+    CONFIG_TEST_AND_SET_PAR(default_to_localhost, "default_to_localhost", parlabel, (parvalue != "false"));
     CONFIG_TEST_AND_SET_PAR(www_file_root, "www_file_root", parlabel, parvalue);
     CONFIG_TEST_AND_SET_PAR(request_log, "request_log", parlabel, parvalue);
+    CONFIG_TEST_AND_SET_PAR(histories_compaction_interval, "histories_compaction_interval", parlabel, std::stol(parvalue));
     //CONFIG_TEST_AND_SET_FLAG(example_flagenablefunc, example_flagdisablefunc, "exampleflag", parlabel, parvalue);
     CONFIG_PAR_NOT_FOUND(parlabel);
 }
@@ -225,15 +179,106 @@ void fzserverpqlog::init_top(int argc, char *argv[]) {
     ReqQ.set_errfilepath(config.request_log);
 }
 
-/* (uncomment to include access to memory-resident Graph)
-Graph & fzgraphsearch::graph() {
+/**
+ * Load the complete Log from the database and prepare it for requests.
+ * 
+ * The Node prev/next chains and the Node histories are set up here, once,
+ * instead of by each client that needs a Log excerpt. The previously
+ * resident Log (if any) is replaced only if loading succeeded.
+ * 
+ * @return True if the Log was loaded.
+ */
+bool fzserverpqlog::load_Log() {
+    ERRTRACE;
+
+    ga.access_initialize();
+
+    std::unique_ptr<Log> new_log_ptr = std::make_unique<Log>();
+    if (!load_Log_pq(*new_log_ptr, ga)) {
+        return standard_error("Unable to load Log from database", __func__);
+    }
+    new_log_ptr->setup_Chain_nodeprevnext();
+
+    log_ptr = std::move(new_log_ptr);
+    histories.clear();
+    histories.init(*log_ptr);
+
+    VERYVERBOSEOUT("Resident Log: "+std::to_string(log_ptr->num_Chunks())+" chunks, "+std::to_string(log_ptr->num_Entries())+" entries, "+std::to_string(histories.size())+" Node histories.\n");
+    return true;
+}
+
+/**
+ * Apply Log appends incrementally.
+ * 
+ * The newest resident Log chunk and every Log chunk after it are reloaded
+ * from the database. That captures new entries in the newest chunk, a
+ * change of its close time, and new chunks. Node histories are updated
+ * for the reloaded chunks only.
+ * 
+ * Modifications of older parts of the Log need a full `load_Log()`.
+ * 
+ * @return True if the Log was refreshed.
+ */
+bool fzserverpqlog::refresh_Log_tail() {
     ERRTRACE;
-    if (!graphmemman.get_Graph(graph_ptr)) {
-        standard_exit_error(exit_resident_graph_missing, "Memory resident Graph not found.", __func__);
+
+    if (!log_ptr) {
+        return load_Log();
     }
-    return *graph_ptr;
+    Log & log = *log_ptr;
+
+    Log_filter filter;
+    Log_chunk * newest = log.get_newest_Chunk();
+    if (newest) {
+        filter.t_from = newest->get_open_time();
+    }
+
+    Log tail;
+    if (!load_partial_Log_pq(tail, ga, filter)) {
+        return standard_error("Unable to load newest Log chunks from database", __func__);
+    }
+
+    if (newest) {
+        const Log_chunk_ID_key newest_key(newest->get_tbegin_key());
+        histories.remove_chunk(*newest);
+        log.remove_Chunk(newest_key);
+    }
+
+    for (const auto & [chunk_key, chunkptr] : tail.get_Chunks()) {
+        histories.add_chunk(*chunkptr);
+    }
+    for (const auto & [entry_key, entryptr] : tail.get_Entries()) {
+        histories.add_entry(*entryptr);
+    }
+    log.append_Log(tail);
+    log.setup_Chain_nodeprevnext();
+
+    VERYVERBOSEOUT("Refreshed Log from "+TimeStampYmdHM(filter.t_from)+".\n");
+    return true;
+}
+
+/**
+ * The Log modification functions update the Node histories cache table
+ * incrementally (see `append_Log_chunk_pq()`). Those updates are compacted
+ * here periodically, after a request has been responded to, so that
+ * clients do not wait for it.
+ */
+void fzserverpqlog::compact_histories_when_due() {
+    if (config.histories_compaction_interval <= 0) {
+        return;
+    }
+    time_t t_now = ActualTime();
+    if ((t_now - t_histories_compacted) < config.histories_compaction_interval) {
+        return;
+    }
+    t_histories_compacted = t_now;
+
+    if (!compact_Node_history_cache_pq(ga)) {
+        ADDWARNING(__func__, "Unable to compact Node histories cache table");
+        return;
+    }
+    log("PQ", "Compacted Node histories cache table");
 }
-*/
 
 void load_Log_and_stay_resident() {
     ERRTRACE;
@@ -254,29 +299,26 @@ void load_Log_and_stay_resident() {
         return; \
     }
 
-    // Load the log and make the pointer available for handlers to use.
-    fzsl.log_ptr = fzsl.ga.request_Log_copy(true, fzsl.config.persistent_NEL);
-    if (!fzsl.log_ptr) {
-        standard_error("Unable to load Log", __func__);
+    // Load the Log and make it available for handlers to use.
+    if (!fzsl.load_Log()) {
         RETURN_AFTER_UNLOCKING;
     }
-
-    VERYVERBOSEOUT(logmemman.info_str());
-    VERYVERBOSEOUT(Log_Info_str(*fzsl.log_ptr));
-
-    std::string ipaddrstr;
-    if (!find_server_address(ipaddrstr)) {
-        standard_error("Unable to determine server IP address", __func__);
-        RETURN_AFTER_UNLOCKING;   
+    fzsl.t_histories_compacted = ActualTime();
+
+    if (fzsl.config.default_to_localhost) {
+        VERYVERBOSEOUT("Configured to default to localhost. Local server access only.");
+        fzsl.ipaddrstr = "127.0.0.1";
+    } else {
+        if (!find_server_address(fzsl.ipaddrstr)) {
+            standard_error("Unable to determine server IP address (launching only for localhost)", __func__);
+            fzsl.ipaddrstr = "127.0.0.1";
+        }
     }
 
-    fzsl.log_ptr->set_server_IPaddr(ipaddrstr);
-    fzsl.log_ptr->set_server_port(fzsl.config.port_number);
-    VERYVERBOSEOUT("The server will be available on:\n  localhost:"+fzsl.log_ptr->get_server_port_str()+"\n  "+fzsl.log_ptr->get_server_full_address()+'\n');
-    std::string serveraddresspath(FORMALIZER_ROOT "/logserver_address");
-    ipaddrstr = fzsl.log_ptr->get_server_full_address();
-    if (!string_to_file(serveraddresspath, ipaddrstr)) {
-        standard_error("Unable to store server IP address in ", __func__);
+    std::string port_str(std::to_string(fzsl.config.port_number));
+    VERYVERBOSEOUT("The server will be available on:\n  localhost:"+port_str+"\n  "+fzsl.ipaddrstr+':'+port_str+'\n');
+    if (!string_to_file(LOGSERVER_ADDRESSFILE, fzsl.ipaddrstr+':'+port_str)) {
+        standard_error("Unable to store server IP address in "+std::string(LOGSERVER_ADDRESSFILE), __func__);
         RETURN_AFTER_UNLOCKING;
     }
 
@@ -290,9 +332,6 @@ int main(int argc, char *argv[]) {
 
     fzsl.init_top(argc, argv);
 
-    FZOUT("\nThis is a stub.\n\n");
-    key_pause();
-
     switch (fzsl.flowcontrol) {
 
     case flow_resident_log: {
@@ -15,8 +15,8 @@
 #include "config.hpp"
 #include "standard.hpp"
 #include "tcpserver.hpp"
-#include "Logaccess.hpp"
-// #include "Graphaccess.hpp"
+#include "Logtypes.hpp"
+#include "Graphaccess.hpp"
 
 #ifndef FORMALIZER_ROOT
     #define FORMALIZER_ROOT this_breaks
@@ -26,7 +26,7 @@ using namespace fz;
 
 enum flow_options {
     flow_unknown = 0, /// no recognized request
-    flow_resident_log = 1, /// request: load the Log into shared memory and stay resident
+    flow_resident_log = 1, /// request: load the Log into memory and stay resident
     flow_NUMoptions
 };
 
@@ -40,26 +40,33 @@ public:
 
     uint16_t port_number = 8091;   ///< Default port number to listen on.
     bool persistent_NEL = true;    ///< Default Named Entry Lists are synchronized in-memory and database.
+    bool default_to_localhost = false; ///< Serve only local clients, e.g. if there is no network.
     std::string www_file_root = "/var/www/html"; ///< Root as presented for direct TCP-port API file serving.
     std::string request_log = reqqfilepath;
+    time_t histories_compaction_interval = 3600; ///< Seconds between compactions of the Node histories cache table (0 = never).
 };
 
 
 struct fzserverpqlog: public formalizer_standard_program, public shared_memory_server {
 
-    static constexpr const char * lockfilepath = FORMALIZER_ROOT "/.fzserverpq-log.lock";
+    static constexpr const char * lockfilepath = LOGSERVER_LOCKFILE;
 
     fzsl_configurable config;
 
     flow_options flowcontrol;
 
-    Log * log_ptr;
+    Graph_access ga;
+
+    std::unique_ptr<Log> log_ptr;  ///< The memory-resident Log.
+    Node_histories histories;      ///< Node histories of the resident Log, for by-Node requests.
+
+    std::string ipaddrstr;
+
+    time_t t_histories_compacted = 0; ///< Time of the most recent Node histories cache compaction.
 
     // *** A v0.1 simplistic server request log (see https://trello.com/c/dnKYchIu for the better way).
     Errors ReqQ;
 
-    // Graph_access ga; // to include Graph or Log access support
-
     fzserverpqlog();
 
     virtual void usage_hook();
@@ -68,17 +75,20 @@ struct fzserverpqlog: public formalizer_standard_program, public shared_memory_s
 
     void init_top(int argc, char *argv[]);
 
-    virtual void handle_request_with_data_share(int new_socket, const std::string & segment_name); // see shm_server_handlers.cpp
+    bool load_Log();
+
+    bool refresh_Log_tail();
+
+    void compact_histories_when_due();
+
+    virtual std::string identify() const { return "Using single-threaded immediate requests with a memory-resident Log.\n"; }
+
+    virtual void handle_request_with_data_share(int new_socket, const std::string & segment_name);
 
     virtual void handle_special_purpose_request(int new_socket, const std::string & request_str); // see tcp_server_handlers.cpp
 
     void log(std::string request, std::string update) { ReqQ.push(request, update); }
 
-    /* (uncomment to include access to memory-resident Graph)
-    Graph_ptr graph_ptr = nullptr;
-    Graph & graph();
-    */
-
 };
 
 extern fzserverpqlog fzsl;
@@ -0,0 +1,344 @@
+// Copyright 2020 Randal A. Koene
+// License TBD
+
+/**
+ * TCP port direct API handler functions for fzserverpq-log.
+ *
+ * For more about this, see https://trello.com/c/6obEcUJS.
+ */
+
+// std
+#include <sys/socket.h>
+
+// core
+#include "error.hpp"
+#include "standard.hpp"
+#include "Logtypes.hpp"
+
+// local
+#include "tcp_server_handlers.hpp"
+#include "fzserverpq-log.hpp"
+
+using namespace fz;
+
+typedef std::map<std::string, unsigned int> Command_Token_Map;
+
+const Command_Token_Map general_noargs_commands = {
+    {"status", fznoargcmd_status},
+    {"ipport", fznoargcmd_ipport},
+    {"ReqQ", fznoargcmd_reqq},
+    {"ErrQ", fznoargcmd_errq},
+    {"_stop", fznoargcmd_stop},
+    {"verbosity?set=normal",fznoargcmd_verbosity_normal},
+    {"verbosity?set=quiet",fznoargcmd_verbosity_quiet},
+    {"verbosity?set=very",fznoargcmd_verbosity_very}
+};
+
+const Command_Token_Map log_noargs_commands = {
+    {"refresh", fzlognoargcmd_refresh},
+    {"reload", fzlognoargcmd_reload}
+};
+
+unsigned int find_in_command_map(const std::string & cmd_candidate, const Command_Token_Map & CTmap) {
+    auto CT_it = CTmap.find(cmd_candidate);
+    if (CT_it != CTmap.end()) {
+        return CT_it->second;
+    }
+    return 0;
+}
+
+std::string standard_HTML_header(const std::string& titlestr) {
+    return "<html>\n<head>\n<title>"+titlestr+"</title>\n</head>\n<body>\n<h3>"+titlestr+"</h3>\n";
+}
+
+bool handle_request_response(int socket, const std::string & text, std::string msg) {
+    server_response_text srvtxt(text);
+    fzsl.log("TCP", msg);
+    VERYVERBOSEOUT(msg+'\n');
+    return (srvtxt.respond(socket) >= 0);
+}
+
+void handle_request_error(int socket, http_response_code code, std::string error_msg) {
+    server_response_text srvtxt(code, error_msg);
+    srvtxt.respond(socket); // a VERYVERBOSEOUT is in the respond() function
+    fzsl.log("TCP",srvtxt.error_msg);
+}
+
+bool handle_status(int new_socket) {
+    std::string status_html(standard_HTML_header("fz: Log Server Status") + "Server status: LISTENING\n");
+    if (fzsl.log_ptr) {
+        Log & log = *fzsl.log_ptr;
+        status_html += "<p>Resident Log:</p>\n<ul>\n";
+        status_html += "<li>Log chunks: "+std::to_string(log.num_Chunks())+"</li>\n";
+        status_html += "<li>Log entries: "+std::to_string(log.num_Entries())+"</li>\n";
+        status_html += "<li>Node histories: "+std::to_string(fzsl.histories.size())+"</li>\n";
+        status_html += "<li>Newest Log chunk: "+TimeStampYmdHM(log.newest_chunk_t())+"</li>\n</ul>\n";
+    }
+    status_html += "</body>\n</html>\n";
+    return handle_request_response(new_socket, status_html, "Status reported");
+}
+
+bool handle_ipport(int new_socket) {
+    std::string ipport_html(standard_HTML_header("fz: Log Server Address") + "Server address: "+fzsl.ipaddrstr+"\n</body>\n</html>\n");
+    return handle_request_response(new_socket, ipport_html, "IPPort reported");
+}
+
+bool show_ReqQ(int new_socket) {
+    ERRTRACE;
+    std::string reqq_html(standard_HTML_header("fz: ReqQ"));
+    reqq_html += "<p>When fzserverpq-log exits, ReqQ will be flushed to: "+fzsl.ReqQ.get_errfilepath()+"</p>\n\n";
+    reqq_html += "<p>Current status of ReqQ:</p>\n<hr>\n<pre>\n" + fzsl.ReqQ.pretty_print() + "</pre>\n<hr>\n</body>\n</html>\n";
+    return handle_request_response(new_socket, reqq_html, "ReqQ request sucessful");
+}
+
+bool show_ErrQ(int new_socket) {
+    ERRTRACE;
+    std::string errq_html(standard_HTML_header("fz: ErrQ"));
+    errq_html += "<p>When fzserverpq-log exits, ErrQ will be flushed to: "+ErrQ.get_errfilepath()+"</p>\n\n";
+    errq_html += "<p>Current status of ErrQ:</p>\n<hr>\n<pre>\n" + ErrQ.pretty_print() + "</pre>\n<hr>\n</body>\n</html>\n";
+    return handle_request_response(new_socket, errq_html, "ErrQ request sucessful");
+}
+
+bool handle_stop(int new_socket) {
+    fzsl.listen = false;
+    std::string status_html(standard_HTML_header("fz: Log Server Stop") + "Server status: STOPPING\n</body>\n</html>\n");
+    return handle_request_response(new_socket, status_html, "Stopping");
+}
+
+bool handle_set_verbosity(int new_socket, std::string verbosity_str, bool veryverbose, bool quiet) {
+    standard.veryverbose = veryverbose;
+    standard.quiet = quiet;
+    std::string success_msg("Setting verbosity: "+verbosity_str);
+    std::string status_html(standard_HTML_header("fz: Verbosity") + success_msg+"\n</body>\n</html>\n");
+    return handle_request_response(new_socket, status_html, success_msg);
+}
+
+bool handle_Log_excerpt(int new_socket, const std::string & argstr) {
+    ERRTRACE;
+    if (!fzsl.log_ptr) {
+        return false;
+    }
+
+    Log_filter filter;
+    try {
+        for (const auto & GETel : GET_token_values(argstr)) {
+            if (GETel.token == "from") {
+                filter.t_from = std::stol(GETel.value);
+            } else if (GETel.token == "to") {
+                filter.t_to = std::stol(GETel.value);
+            } else if (GETel.token == "node") {
+                filter.nkey = Node_ID_key(GETel.value);
+            } else if (GETel.token == "limit") {
+                filter.limit = std::stoul(GETel.value);
+            } else if (GETel.token == "back") {
+                filter.back_to_front = (GETel.value == "true");
+            } else if (GETel.token == "chunks_only") {
+                filter.chunks_only = (GETel.value == "true");
+            } else {
+                handle_request_error(new_socket, http_bad_request, "Unrecognized Log excerpt argument: "+GETel.token);
+                return true;
+            }
+        }
+    } catch (std::exception & e) {
+        handle_request_error(new_socket, http_bad_request, "Invalid Log excerpt argument: "+argstr);
+        return true;
+    } catch (ID_exception idexception) {
+        handle_request_error(new_socket, http_bad_request, "Invalid Node ID in Log excerpt arguments: "+idexception.what());
+        return true;
+    }
+
+    Log_chunk_ID_key_set chunks = Log_excerpt_chunks(*fzsl.log_ptr, fzsl.histories, filter);
+    server_response_plaintext srvtxt(serialize_Log_excerpt(*fzsl.log_ptr, chunks, filter.chunks_only));
+    std::string msg("Log excerpt with "+std::to_string(chunks.size())+" chunks");
+    fzsl.log("TCP", msg);
+    VERYVERBOSEOUT(msg+'\n');
+    return (srvtxt.respond(new_socket) >= 0);
+}
+
+bool handle_Nodes_logged_minutes(int new_socket, const std::string & argstr) {
+    ERRTRACE;
+    if (!fzsl.log_ptr) {
+        return false;
+    }
+
+    base_Node_Set nodes;
+    time_t t_to = RTt_unspecified;
+    try {
+        for (const auto & GETel : GET_token_values(argstr)) {
+            if (GETel.token == "to") {
+                t_to = std::stol(GETel.value);
+            } else if (GETel.token == "nodes") {
+                for (const auto & nodeid_str : split(GETel.value, ',')) {
+                    nodes.emplace(nodeid_str);
+                }
+            } else {
+                handle_request_error(new_socket, http_bad_request, "Unrecognized logged minutes argument: "+GETel.token);
+                return true;
+            }
+        }
+    } catch (std::exception & e) {
+        handle_request_error(new_socket, http_bad_request, "Invalid logged minutes argument: "+argstr);
+        return true;
+    } catch (ID_exception idexception) {
+        handle_request_error(new_socket, http_bad_request, "Invalid Node ID in logged minutes arguments: "+idexception.what());
+        return true;
+    }
+
+    Node_minutes_map minutes;
+    Nodes_logged_minutes(*fzsl.log_ptr, fzsl.histories, nodes, t_to, minutes);
+    std::string minutes_str;
+    minutes_str.reserve(minutes.size()*24);
+    for (const auto & [nkey, node_minutes] : minutes) {
+        minutes_str += nkey.str()+' '+std::to_string(node_minutes)+'\n';
+    }
+
+    server_response_plaintext srvtxt(minutes_str);
+    std::string msg("Logged minutes of "+std::to_string(minutes.size())+" Nodes");
+    fzsl.log("TCP", msg);
+    VERYVERBOSEOUT(msg+'\n');
+    return (srvtxt.respond(new_socket) >= 0);
+}
+
+/**
+ * Handle a Log request in the Formalizer /fz/ virtual filesystem.
+ *
+ * Examples:
+ *   /fz/log/excerpt?from=1617123600&limit=5
+ *   /fz/log/minutes?to=1617123600&nodes=20200901061505.1,20210102101010.1
+ *   /fz/log/refresh
+ *   /fz/log/reload
+ *
+ * @param new_socket The communication socket file handler to respond to.
+ * @param fzrequesturl The URL-like string containing the request to handle.
+ * @return True if the request was handled successfully.
+ */
+bool handle_fz_vfs_log_request(int new_socket, const std::string & fzrequesturl) {
+    ERRTRACE;
+
+    std::string logrequeststr(fzrequesturl.substr(8));
+    if (logrequeststr.substr(0,8) == "excerpt?") {
+        return handle_Log_excerpt(new_socket, logrequeststr.substr(8));
+    }
+    if (logrequeststr == "excerpt") {
+        return handle_Log_excerpt(new_socket, "");
+    }
+    if (logrequeststr.substr(0,8) == "minutes?") {
+        return handle_Nodes_logged_minutes(new_socket, logrequeststr.substr(8));
+    }
+
+    fz_log_noarg_cmd lognoargs_cmd = static_cast<fz_log_noarg_cmd>(find_in_command_map(logrequeststr, log_noargs_commands));
+    switch (lognoargs_cmd) {
+
+        case fzlognoargcmd_refresh: {
+            if (!fzsl.refresh_Log_tail()) {
+                return false;
+            }
+            std::string response_html(standard_HTML_header("fz: Log Refresh") + "<p>Refreshed the newest Log chunks from database.</p>\n</body>\n</html>\n");
+            return handle_request_response(new_socket, response_html, "Log tail refreshed");
+        }
+
+        case fzlognoargcmd_reload: {
+            if (!fzsl.load_Log()) {
+                return false;
+            }
+            std::string response_html(standard_HTML_header("fz: Log Reload") + "<p>Reloaded the Log from database.</p>\n</body>\n</html>\n");
+            return handle_request_response(new_socket, response_html, "Log reloaded");
+        }
+
+        default: {
+            // nothing to do here
+        }
+    }
+
+    return false;
+}
+
+bool handle_fz_vfs_request(int new_socket, const std::string & fzrequesturl) {
+
+    fz_general_noarg_cmd fznoargs_cmd = static_cast<fz_general_noarg_cmd>(find_in_command_map(fzrequesturl.substr(4), general_noargs_commands));
+    switch (fznoargs_cmd) {
+
+        case fznoargcmd_status: {
+            return handle_status(new_socket);
+        }
+
+        case fznoargcmd_ipport: {
+            return handle_ipport(new_socket);
+        }
+
+        case fznoargcmd_reqq: {
+            return show_ReqQ(new_socket);
+        }
+
+        case fznoargcmd_errq: {
+            return show_ErrQ(new_socket);
+        }
+
+        case fznoargcmd_stop: {
+            return handle_stop(new_socket);
+        }
+
+        case fznoargcmd_verbosity_normal: {
+            return handle_set_verbosity(new_socket, "normal", false, false);
+        }
+
+        case fznoargcmd_verbosity_quiet: {
+            return handle_set_verbosity(new_socket, "quiet", false, true);
+        }
+
+        case fznoargcmd_verbosity_very: {
+            return handle_set_verbosity(new_socket, "very verbose", true, false);
+        }
+
+        default: {
+            // nothing to do here
+        }
+    }
+
+    if (fzrequesturl.substr(4,4) == "log/") {
+        return handle_fz_vfs_log_request(new_socket, fzrequesturl);
+    }
+
+    return false;
+}
+
+void fzserverpqlog::handle_special_purpose_request(int new_socket, const std::string & request_str) {
+    ERRTRACE;
+
+    VERYVERBOSEOUT("Received Special Purpose request "+request_str+".\n");
+    log("TCP","Received: "+request_str);
+    auto requestvec = split(request_str,' ');
+    if (requestvec.size()<2) {
+        handle_request_error(new_socket, http_bad_request, "Missing request.");
+        return;
+    }
+
+    if (requestvec[1].substr(0,4) == "/fz/") { // (one type of) recognized Formalizer special purpose request
+
+        if (handle_fz_vfs_request(new_socket, requestvec[1])) {
+            compact_histories_when_due();
+            return;
+        } else {
+            handle_request_error(new_socket, http_not_found, "Formalizer Virtual Filesystem /fz/ request failed.");
+            return;
+        }
+
+    }
+
+    // no known request encountered and handled
+    handle_request_error(new_socket, http_bad_request, "Request unrecognized: "+request_str);
+}
+
+/**
+ * Log modifications through shared memory are not (yet) supported. Clients
+ * such as fzlog modify the Log in the database and then notify this server
+ * with `/fz/log/refresh` or `/fz/log/reload`.
+ */
+void fzserverpqlog::handle_request_with_data_share(int new_socket, const std::string & segment_name) {
+    ERRTRACE;
+
+    VERYVERBOSEOUT("Received unsupported Log request with data share "+segment_name+".\n");
+    log("SHM", "Log request with data share not supported");
+    std::string response_str("ERROR");
+    send(new_socket, response_str.c_str(), response_str.size()+1, 0);
+}
@@ -0,0 +1,81 @@
+// Copyright 2020 Randal A. Koene
+// License TBD
+
+/**
+ * This header file is used for declarations specific to the TCP port direct API server handler
+ * functions of the fzserverpq-log program.
+ *
+ * Versioning is based on https://semver.org/ and the C++ header defines __TCP_SERVER_HANDLERS_HPP.
+ */
+
+#ifndef __TCP_SERVER_HANDLERS_HPP
+#include "version.hpp"
+#define __TCP_SERVER_HANDLERS_HPP (__VERSION_HPP)
+
+// std
+#include <string>
+
+// core
+#include "tcpserver.hpp"
+
+using namespace fz;
+
+enum fz_general_noarg_cmd {
+    fznoargcmd_unknown = 0,
+    fznoargcmd_status = 1,
+    fznoargcmd_ipport = 2,
+    fznoargcmd_reqq = 3,
+    fznoargcmd_errq = 4,
+    fznoargcmd_stop = 5,
+    fznoargcmd_verbosity_normal = 6,
+    fznoargcmd_verbosity_quiet = 7,
+    fznoargcmd_verbosity_very = 8,
+    fznoargcmd_NUM
+};
+
+enum fz_log_noarg_cmd {
+    fzlognoargcmd_unknown = 0,
+    fzlognoargcmd_refresh = 1,
+    fzlognoargcmd_reload = 2,
+    fzlognoargcmd_NUM
+};
+
+bool handle_request_response(int socket, const std::string & text, std::string msg);
+
+void handle_request_error(int socket, http_response_code code, std::string error_msg);
+
+/**
+ * Respond with a serialized excerpt of the memory-resident Log.
+ *
+ * The excerpt is selected as `load_partial_Log_pq()` would select it
+ * (see `Log_excerpt_chunks()`). Recognized arguments are:
+ * from=<epoch-time>, to=<epoch-time>, node=<node-id>, limit=<n>,
+ * back=true, chunks_only=true.
+ *
+ * @param new_socket The communication socket file handler to respond to.
+ * @param argstr The arguments that follow '?' in the request URL.
+ * @return True if the excerpt was sent.
+ */
+bool handle_Log_excerpt(int new_socket, const std::string & argstr);
+
+/**
+ * Respond with the total time logged for each of a set of Nodes, one
+ * line `<node-id> <minutes>` per Node (see `Nodes_logged_minutes()`).
+ * Recognized arguments are: to=<epoch-time>, nodes=<node-id>,<node-id>,...
+ *
+ * @param new_socket The communication socket file handler to respond to.
+ * @param argstr The arguments that follow '?' in the request URL.
+ * @return True if the totals were sent.
+ */
+bool handle_Nodes_logged_minutes(int new_socket, const std::string & argstr);
+
+/**
+ * Handle a request in the Formalizer /fz/ virtual filesystem.
+ *
+ * @param new_socket The communication socket file handler to respond to.
+ * @param fzrequesturl The URL-like string containing the request to handle.
+ * @return True if the request was handled successfully.
+ */
+bool handle_fz_vfs_request(int new_socket, const std::string & fzrequesturl);
+
+#endif // __TCP_SERVER_HANDLERS_HPP
@@ -29,6 +29,7 @@
 #include "Graphinfo.hpp"
 #include "Graphmodify.hpp"
 #include "Graphpostgres.hpp"
+#include "instrument.hpp"
 
 // local
 #include "fzserverpq.hpp"
@@ -50,6 +51,8 @@ using namespace fz;
     fzserverpq fzs;
 #endif
 
+Instrument_Histogram graph_load_seconds("fzserverpq_graph_load_seconds", "Time spent loading the Graph at server start.");
+
 static const char usage_tail_str_A[] = R"UTAIL(
 The limited number of command line options are generally used only to start
 the server. The server interacts with clients through the combination of a
@@ -84,6 +87,8 @@ The GET/PATCH port API includes the following:
   /fz/ReqQ
   /fz/_stop
   /fz/verbosity?set=<normal|quiet|very>
+  /fz/metrics
+  /fz/metrics?format=json
 
   /fz/db/mode
   /fz/db/mode?set=<run|log|sim>
@@ -256,51 +261,203 @@ fzserverpq::fzserverpq(bool handles_close):
 queing_fzserverpq::queing_fzserverpq(): fzserverpq(true) {
 }
 
+void fzs_request_counters::queued() {
+    unsigned long depth = ++queue_depth;
+    unsigned long prev_max = max_queue_depth;
+    while ((depth > prev_max) && !max_queue_depth.compare_exchange_weak(prev_max, depth)) {}
+}
+
+void fzs_request_counters::completed(fzs_lock_type locktype, uint64_t wait_us, uint64_t handling_us) {
+    ++handled[locktype];
+    total_wait_us += wait_us;
+    total_handling_us += handling_us;
+    uint64_t latency = wait_us + handling_us;
+    uint64_t prev_max = max_latency_us;
+    while ((latency > prev_max) && !max_latency_us.compare_exchange_weak(prev_max, latency)) {}
+}
+
+std::string fzs_request_counters::html() const {
+    unsigned long total = handled[fzs_lock_none] + handled[fzs_lock_shared] + handled[fzs_lock_exclusive];
+    std::string html_str("<table>\n");
+    auto row = [&html_str](const std::string & label, const std::string & value) {
+        html_str += "<tr><td>"+label+"</td><td>"+value+"</td></tr>\n";
+    };
+    row("workers", std::to_string(fzs.config.worker_threads));
+    row("busy workers", std::to_string(busy_workers));
+    row("queued", std::to_string(queue_depth));
+    row("max queued", std::to_string(max_queue_depth));
+    row("handled without lock", std::to_string(handled[fzs_lock_none]));
+    row("handled with shared lock", std::to_string(handled[fzs_lock_shared]));
+    row("handled with exclusive lock", std::to_string(handled[fzs_lock_exclusive]));
+    if (total > 0) {
+        row("mean queue wait (us)", std::to_string(total_wait_us / total));
+        row("mean handling time (us)", std::to_string(total_handling_us / total));
+    }
+    row("max latency (us)", std::to_string(max_latency_us));
+    html_str += "</table>\n";
+    return html_str;
+}
+
 /**
- * This is run regularly within a separate thread.
+ * Add a request to one of the FIFO queues and wake up a worker.
+ * 
+ * @param fifo Either special_FIFO or shm_FIFO.
+ * @param new_socket The communication socket file handler to respond to.
+ * @param request_str The request or the shared memory segment name.
  */
-void queing_fzserverpq::handle_queued_request() {
-    if (!special_FIFO.empty()) {
-        fzs_request safe_copy;
-        {
-            std::lock_guard<std::mutex> lock(queueMutex); // thread-safety for pushing to special_FIFO and shm_FIFO
-            safe_copy.comms_socket = special_FIFO.front().comms_socket;
-            safe_copy.req = special_FIFO.front().req;
+void queing_fzserverpq::enqueue(std::queue<fzs_request> & fifo, int new_socket, const std::string & request_str) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex); // thread-safety for pushing to special_FIFO and shm_FIFO
+        fifo.emplace(new_socket, request_str);
+        counters.queued();
+        if (fifo.size() > 10) {
+            ADDWARNING(__func__, "Request queue size > 10");
         }
-        fzserverpq::handle_special_purpose_request(safe_copy.comms_socket, safe_copy.req);
-        close(safe_copy.comms_socket);
-        {
-            std::lock_guard<std::mutex> lock(queueMutex); // thread-safety for pushing to special_FIFO and shm_FIFO
+    }
+    queueCondition.notify_one();
+}
+
+/// Returns true if all directives of a serialized data request only read the Graph.
+bool read_only_serialized_request(const std::string & request_str) {
+    auto directives = split(request_str.substr(3), ';');
+    for (const auto & directive : directives) {
+        std::string name(directive.substr(0, directive.find('(')));
+        if ((name != "NNLlen") && (name != "nodes_match")) {
+            return false;
+        }
+    }
+    return !directives.empty();
+}
+
+/**
+ * Determine how a queued request needs to lock the Graph.
+ * 
+ * Only requests that are known to leave the Graph and server state unchanged
+ * run with a shared lock. Anything unrecognized, including all requests with
+ * shared memory data share, runs with an exclusive lock.
+ * 
+ * @param request_str The request string of a special purpose request.
+ * @return The lock type.
+ */
+fzs_lock_type request_lock_type(const std::string & request_str) {
+    if (request_str.substr(0,3) == "FZ ") {
+        return read_only_serialized_request(request_str) ? fzs_lock_shared : fzs_lock_exclusive;
+    }
+
+    auto requestvec = split(request_str,' ');
+    if (requestvec.size()<2) {
+        return fzs_lock_none;
+    }
+    const std::string & url = requestvec[1];
+    bool has_args = (url.find('?') != std::string::npos);
+
+    if (url.substr(0,4) != "/fz/") {
+        return (url.substr(0,1) == "/") ? fzs_lock_none : fzs_lock_exclusive; // file serving and CGI proxy
+    }
+
+    std::string fzpath(url.substr(4));
+    if ((fzpath == "status") || (fzpath == "ipport") || (fzpath == "tzadjust") || (fzpath == "ReqQ") || (fzpath == "ErrQ") || (fzpath == "metrics") || (fzpath == "metrics?format=json")) {
+        return fzs_lock_none;
+    }
+    if (has_args) {
+        return fzs_lock_exclusive;
+    }
+    if ((fzpath.substr(0,12) == "graph/nodes/") && (fzpath.find("logtime") == std::string::npos)) {
+        return fzs_lock_shared;
+    }
+    if ((fzpath.substr(0,17) == "graph/namedlists/") && (fzpath.substr(17,1) != "_")) {
+        return fzs_lock_shared;
+    }
+    if (fzpath == "db/mode") {
+        return fzs_lock_shared;
+    }
+    return fzs_lock_exclusive;
+}
+
+/**
+ * Wait for a queued request and handle it.
+ * 
+ * Special purpose requests are served before shared memory requests.
+ * The Graph is locked according to request_lock_type().
+ * 
+ * @return False if listening has stopped and the queues are empty.
+ */
+bool queing_fzserverpq::handle_queued_request() {
+    fzs_request req;
+    bool shm = false;
+    {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueCondition.wait(lock, [this]() { return (!listen) || (!special_FIFO.empty()) || (!shm_FIFO.empty()); });
+        if (!special_FIFO.empty()) {
+            req = std::move(special_FIFO.front());
             special_FIFO.pop();
+        } else if (!shm_FIFO.empty()) {
+            req = std::move(shm_FIFO.front());
+            shm_FIFO.pop();
+            shm = true;
+        } else {
+            return false;
         }
-    } else if (!shm_FIFO.empty()) {
-        fzs_request safe_copy;
-        {
-            std::lock_guard<std::mutex> lock(queueMutex); // thread-safety for pushing to special_FIFO and shm_FIFO
-            safe_copy.comms_socket = shm_FIFO.front().comms_socket;
-            safe_copy.req = shm_FIFO.front().req;
+        --counters.queue_depth;
+    }
+
+    ++counters.busy_workers;
+    auto t_start = std::chrono::steady_clock::now();
+    fzs_lock_type locktype = shm ? fzs_lock_exclusive : request_lock_type(req.req);
+    switch (locktype) {
+        case fzs_lock_shared: {
+            std::shared_lock<std::shared_mutex> glock(graphMutex);
+            fzserverpq::handle_special_purpose_request(req.comms_socket, req.req);
+            break;
         }
-        fzserverpq::handle_request_with_data_share(safe_copy.comms_socket, safe_copy.req);
-        close(safe_copy.comms_socket);
-        {
-            std::lock_guard<std::mutex> lock(queueMutex); // thread-safety for pushing to special_FIFO and shm_FIFO
-            shm_FIFO.pop();
+        case fzs_lock_exclusive: {
+            std::unique_lock<std::shared_mutex> glock(graphMutex);
+            if (shm) {
+                fzserverpq::handle_request_with_data_share(req.comms_socket, req.req);
+            } else {
+                fzserverpq::handle_special_purpose_request(req.comms_socket, req.req);
+            }
+            break;
+        }
+        default: {
+            fzserverpq::handle_special_purpose_request(req.comms_socket, req.req);
         }
     }
+    close(req.comms_socket);
+    auto t_end = std::chrono::steady_clock::now();
+    --counters.busy_workers;
+
+    counters.completed(locktype,
+        std::chrono::duration_cast<std::chrono::microseconds>(t_start - req.t_queued).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(t_end - t_start).count());
+    return true;
 }
 
-constexpr unsigned int reqs_interval_ms = 50;
-
 void queue_handling_thread_func(queing_fzserverpq* fzs_ptr) {
-    while (fzs_ptr->listen) {
-        fzs_ptr->handle_queued_request();
-        std::this_thread::sleep_for(std::chrono::milliseconds(reqs_interval_ms));
-    }
+    while (fzs_ptr->handle_queued_request()) {}
 
     // In case this exits for some reason when the listening thread is still active
     fzs_ptr->listen = false;
 }
 
+constexpr unsigned int ring_wakeup_ms = 1000;
+
+/// Handle requests submitted through the modification request ring in order of submission.
+void ring_handling_thread_func(queing_fzserverpq* fzs_ptr) {
+    while (fzs_ptr->listen) {
+        std::string requestname = wait_Graphmod_ring_request(*fzs_ptr->ring_ptr, ring_wakeup_ms);
+        if (requestname.empty()) {
+            continue;
+        }
+        auto t_start = std::chrono::steady_clock::now();
+        {
+            std::unique_lock<std::shared_mutex> glock(fzs_ptr->graphMutex);
+            fzs_ptr->handle_ring_request(requestname);
+        }
+        fzs_ptr->counters.completed(fzs_lock_exclusive, 0, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t_start).count());
+    }
+}
+
 #endif // USE_MULTI_THREADING
 
 Graph & fzserverpq::graph() {
@@ -363,9 +520,14 @@ bool fzs_configurable::set_parameter(const std::string & parlabel, const std::st
     // *** You could also implement try-catch here to gracefully report problems with configuration files.
     CONFIG_TEST_AND_SET_PAR(default_to_localhost, "default_to_localhost", parlabel, (parvalue == "true"));
     CONFIG_TEST_AND_SET_PAR(port_number, "port_number", parlabel, std::stoi(parvalue));
+    CONFIG_TEST_AND_SET_PAR(listen_backlog, "listen_backlog", parlabel, std::stoi(parvalue));
+    CONFIG_TEST_AND_SET_PAR(worker_threads, "worker_threads", parlabel, std::stoul(parvalue));
+    CONFIG_TEST_AND_SET_PAR(graphmod_ring_size, "graphmod_ring_size", parlabel, std::stoul(parvalue));
     CONFIG_TEST_AND_SET_PAR(www_file_root, "www_file_root", parlabel, parse_www_file_roots(parvalue));
     CONFIG_TEST_AND_SET_PAR(request_log, "request_log", parlabel, parvalue);
     CONFIG_TEST_AND_SET_PAR(predefined_CGIbg, "predefined_CGIbg", parlabel, parse_predefined_CGIbg(parvalue)); // E.g. from "fzbackup-mirror-to-github.sh,fzinfo"
+    CONFIG_TEST_AND_SET_PAR(pq_pool_size, "pq_pool_size", parlabel, std::stoi(parvalue));
+    CONFIG_TEST_AND_SET_PAR(graph_snapshot, "graph_snapshot", parlabel, parvalue);
     CONFIG_TEST_AND_SET_PAR(graphconfig.persistent_NNL, "persistent_NNL", parlabel, (parvalue != "false"));    
     CONFIG_TEST_AND_SET_PAR(graphconfig.tzadjust_seconds, "timezone_offset_hours", parlabel, -3600*std::stoi(parvalue));
     CONFIG_TEST_AND_SET_PAR(graphconfig.batchmode_constraints_active, "batchmode_constraints_active", parlabel, (parvalue != "false"));
@@ -454,12 +616,51 @@ void load_Graph_and_stay_resident() {
         return; \
     }
 
+    // Identify this server's connections, so that the Graph change stamp can tell its writes apart.
+    pq_application_name = PQ_SERVER_APPLICATION_NAME;
+
+    // Keep database connections open for reuse by request handlers.
+    if (fzs.config.pq_pool_size > 0) {
+        pq_pool.enable(fzs.config.pq_pool_size);
+    }
+
     // Load the graph and make the pointer available for handlers to use.
-    fzs.graph_ptr = fzs.ga.request_Graph_copy(true, &fzs.config.graphconfig);
+    // A snapshot of the Graph is used instead of loading from the database if it is still up to date.
+    if (SimPQ.SimulatingPQChanges()) {
+        fzs.snapshot_allowed = false;
+    }
+    int64_t dbstamp = -1;
+    int64_t dbexternal = -1;
+    std::string snapshotpath(fzs.snapshot_allowed ? fzs.config.graph_snapshot : "");
+    {
+        Scoped_Timer timer(graph_load_seconds); // load_Graph_pq() or snapshot
+        fzs.graph_ptr = fzs.ga.request_Graph_copy_or_snapshot(snapshotpath, dbstamp, true, &fzs.config.graphconfig, &dbexternal);
+    }
+    unsigned long failed_changes_at_load = pq_failed_changes;
     if (!fzs.graph_ptr) {
         standard_error("Unable to load Graph", __func__);
         RETURN_AFTER_UNLOCKING;
     }
+    std::string graph_segname(graphmemman.get_active_name());
+
+    // Only this server stores inherited target dates in the shared Graph (also if it was restored from a snapshot).
+    fzs.graph_ptr->own_targetdate_cache();
+    // Node and Edge lookups by ID use this index (see Node_by_id()). It is maintained from the moment the
+    // Graph is constructed, but it may have been dropped while loading or in the run that saved the snapshot.
+    if ((!fzs.graph_ptr->id_index_is_active()) && (!fzs.graph_ptr->build_id_index())) {
+        VERBOSEOUT("Node and Edge index not available, lookups by ID will search the ordered maps.\n");
+    }
+    // Clients can use this index instead of scanning all Nodes (see Nodes_incomplete_by_targetdate()).
+    // It is kept up to date by the Node and Graph modification functions used in request handlers.
+    fzs.graph_ptr->build_targetdate_index();
+    // Likewise, Node text searches use this index to find candidate Nodes (see Nodes_subset()).
+    if (!fzs.graph_ptr->build_text_index()) {
+        VERBOSEOUT("Node text index not available, text searches will scan all Nodes.\n");
+    }
+    // And prerequisite checks use this index instead of parsing @PREREQS and @PROVIDES tags (see get_prerequisites()).
+    if (!fzs.graph_ptr->build_capability_index()) {
+        VERBOSEOUT("Capability index not available, prerequisite checks will parse Node text.\n");
+    }
 
     VERYVERBOSEOUT(graphmemman.info_str());
     VERYVERBOSEOUT(Graph_Info_str(*fzs.graph_ptr));
@@ -487,14 +688,59 @@ void load_Graph_and_stay_resident() {
     }
 
     #ifdef USE_MULTI_THREADING
-        // Launch a query stack and thread
-        std::thread queue_handling_thread(queue_handling_thread_func, &fzs);
+        // Launch a query stack and worker threads
+        std::vector<std::thread> queue_handling_threads;
+        for (unsigned int i = 0; i < std::max(fzs.config.worker_threads, 1u); ++i) {
+            queue_handling_threads.emplace_back(queue_handling_thread_func, &fzs);
+        }
+
+        // Let clients submit modification requests without a segment and TCP request each
+        std::thread ring_handling_thread;
+        if (fzs.config.graphmod_ring_size > 0) {
+            fzs.ring_ptr = create_Graphmod_ring(fzs.config.graphmod_ring_size);
+            if (fzs.ring_ptr) {
+                ring_handling_thread = std::thread(ring_handling_thread_func, &fzs);
+            } else {
+                standard_error("Unable to create modification request ring, clients will use a segment per request", __func__);
+            }
+        }
     #endif
 
     // Keep this thread listening to input on specified port until STOP is received
-    server_socket_listen(fzs.config.port_number, fzs);
+    server_socket_listen(fzs.config.port_number, fzs, fzs.config.listen_backlog);
 
-    queue_handling_thread.join();
+    #ifdef USE_MULTI_THREADING
+        // Let the workers finish what is queued and exit
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            fzs.listen = false;
+        }
+        fzs.queueCondition.notify_all();
+        for (auto & queue_handling_thread : queue_handling_threads) {
+            queue_handling_thread.join();
+        }
+        if (fzs.ring_ptr) {
+            close_Graphmod_ring(*fzs.ring_ptr);
+            ring_handling_thread.join();
+        }
+    #endif
+
+    // Update the snapshot so that the next start can skip loading from the database.
+    // The stamp read at load is advanced only by this server's own successful writes.
+    // If anything else changed the database, or if a write failed, then the Graph in
+    // memory may differ from the database and no snapshot is saved.
+    if ((!snapshotpath.empty()) && fzs.snapshot_allowed && (dbstamp >= 0) && graphmemman.set_active(graph_segname)) {
+        int64_t stamp, external;
+        if (Graph_change_stamp_pq(fzs.ga.dbname(), fzs.ga.pq_schemaname(), stamp, &external)) {
+            if (external != dbexternal) {
+                ADDWARNING(__func__, "The database was modified by other programs, Graph snapshot not saved");
+            } else if (pq_failed_changes != failed_changes_at_load) {
+                ADDWARNING(__func__, "Some database changes failed, Graph snapshot not saved");
+            } else if (!graphmemman.save_Graph_snapshot(snapshotpath, stamp)) {
+                standard_error("Unable to save Graph snapshot to "+snapshotpath, __func__);
+            }
+        }
+    }
 
     RETURN_AFTER_UNLOCKING;
 }
@@ -17,6 +17,10 @@
     // std
     #include <queue>
     #include <mutex>
+    #include <shared_mutex>
+    #include <condition_variable>
+    #include <atomic>
+    #include <chrono>
 #endif
 
 // core
@@ -24,6 +28,7 @@
 #include "standard.hpp"
 #include "tcpserver.hpp"
 #include "Graphaccess.hpp"
+#include "Graphmodify.hpp"
 
 /**
  * FORMALIZER_ROOT must be supplied by -D during make.
@@ -52,9 +57,14 @@ public:
 
     bool default_to_localhost = false; ///< If true the use localhost as server IP address (no remote access).
     uint16_t port_number = 8090;       ///< Default port number to listen on.
+    int listen_backlog = 64;           ///< Connections that can wait to be accepted.
+    unsigned int worker_threads = 4;   ///< Threads that handle queued requests.
+    unsigned long graphmod_ring_size = graphmod_ring_default_size; ///< Size of the modification request ring segment (0 to disable).
     root_path_map_type www_file_root;  // = { {"", "/var/www/html"} }; ///< Root as presented for direct TCP-port API file serving.
     std::string request_log = reqqfilepath;
     std::vector<std::string> predefined_CGIbg;
+    unsigned int pq_pool_size = 4;     ///< Database connections kept open for reuse (0 to open one per request).
+    std::string graph_snapshot = FORMALIZER_ROOT "/fzgraph.snapshot"; ///< Graph snapshot for warm start (empty to disable).
     Graph_Config_Options graphconfig;  ///< Default Named Node Lists are synchronized in-memory and database. (See defaults in Graphtypes.hpp.)
 };
 
@@ -75,6 +85,8 @@ struct fzserverpq: public formalizer_standard_program, public shared_memory_serv
 
     std::unique_ptr<Graphmod_unshared_results> modifications_ptr;
 
+    bool snapshot_allowed = true; ///< Cleared when in-memory changes may not have reached the database (e.g. simulated database changes).
+
     std::string ipaddrstr; // After load_Graph_and_stay_resident() is called this contains both the IP address and Port number, e.g. "127.0.0.0:8090".
 
     fzserverpq(bool handles_close = false);
@@ -103,10 +115,39 @@ struct fzserverpq: public formalizer_standard_program, public shared_memory_serv
 struct fzs_request {
     int comms_socket; // Open socket used with the requesting client.
     std::string req;  // Cached request string.
+    std::chrono::steady_clock::time_point t_queued;
+
+    fzs_request(): comms_socket(-1) {}
+    fzs_request(int _socket, const std::string & _req): comms_socket(_socket), req(_req), t_queued(std::chrono::steady_clock::now()) {}
+};
+
+/// How a request needs to lock the Graph while it is handled.
+enum fzs_lock_type {
+    fzs_lock_none,      ///< does not use the Graph (e.g. file serving, status)
+    fzs_lock_shared,    ///< only reads the Graph, can run in parallel with other readers
+    fzs_lock_exclusive  ///< may modify the Graph or server state
+};
+
+/// Request handling statistics, as reported by /fz/status.
+struct fzs_request_counters {
+    std::atomic<unsigned long> handled[3] = {0, 0, 0}; ///< by fzs_lock_type
+    std::atomic<unsigned long> queue_depth = 0;
+    std::atomic<unsigned long> max_queue_depth = 0;
+    std::atomic<unsigned long> busy_workers = 0;
+    std::atomic<uint64_t> total_wait_us = 0;      ///< time spent in the queue
+    std::atomic<uint64_t> total_handling_us = 0;  ///< time spent handling (including waiting for a lock)
+    std::atomic<uint64_t> max_latency_us = 0;     ///< longest time from queueing to response
+
+    void queued();
+    void completed(fzs_lock_type locktype, uint64_t wait_us, uint64_t handling_us);
+    std::string html() const;
 };
 
 /**
- * Requests received are placed into a FIFO queue for handling by a separate thread.
+ * Requests received are placed into a FIFO queue for handling by a pool of worker threads.
+ * 
+ * Requests that only read the Graph run in parallel under a shared lock, while
+ * requests that may modify it take an exclusive lock (see request_lock_type()).
  * 
  * Note: At present, there is no method in place to deal with queues growing excessively.
  */
@@ -114,15 +155,23 @@ struct queing_fzserverpq: public fzserverpq {
 
     std::queue<fzs_request> special_FIFO;
     std::queue<fzs_request> shm_FIFO;
+    std::condition_variable queueCondition; // Signals workers when a request was queued or listening stopped.
+    std::shared_mutex graphMutex;           // Readers share, modifications are exclusive.
+    fzs_request_counters counters;
+    Graphmod_ring * ring_ptr = nullptr;     // Modification request ring, if enabled.
 
     queing_fzserverpq();
 
-    virtual std::string identify() const { return "Using multi-threaded request queue.\n"; }
+    virtual std::string identify() const { return "Using multi-threaded request queue with "+std::to_string(config.worker_threads)+" workers.\n"; }
 
-    void handle_queued_request();
+    void enqueue(std::queue<fzs_request> & fifo, int new_socket, const std::string & request_str);
+
+    bool handle_queued_request();
 
     virtual void handle_request_with_data_share(int new_socket, const std::string & segment_name); // see shm_server_handlers.cpp
 
+    void handle_ring_request(const std::string & requestname); // see shm_server_handlers.cpp
+
     virtual void handle_special_purpose_request(int new_socket, const std::string & request_str); // see tcp_server_handlers.cpp
 
 };
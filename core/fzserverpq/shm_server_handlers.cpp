@@ -20,6 +20,7 @@
 #include "Graphtypes.hpp"
 #include "Graphinfo.hpp"
 #include "Graphpostgres.hpp"
+#include "instrument.hpp"
 
 // local
 #include "shm_server_handlers.hpp"
@@ -27,6 +28,11 @@
 
 using namespace fz;
 
+Instrument_Histogram request_stack_seconds("fzserverpq_request_stack_seconds", "Time spent handling a Graph modifications request stack.");
+Instrument_Histogram graph_modifications_pq_seconds("fzserverpq_graph_modifications_pq_seconds", "Time spent sending in-memory Graph modifications to the database.");
+Instrument_Counter graph_modifications_total("fzserverpq_graph_modifications_total", "Graph modification requests received in request stacks.");
+Instrument_Counter request_stack_errors_total("fzserverpq_request_stack_errors_total", "Graph modifications request stacks that failed.");
+
 /// See if a Node ID key is one of the Nodes being added in this request.
 bool node_id_in_request_stack(Graph_modifications & graphmod, const Node_ID_key & nkey) {
     for (const auto & gmoddata : graphmod.data) {
@@ -208,6 +214,7 @@ bool request_stack_valid(Graph_modifications & graphmod, std::string segname) {
  */
 bool handle_request_stack(std::string segname) {
     ERRTRACE;
+    Scoped_Timer timer(request_stack_seconds);
     bool nodes_modified = false; // Tracks modification times relevant to things like BTF (see Map_of_Subtrees::node_in_heads_or_any_subtree())
     time_t modification_time = ActualTime();
 
@@ -219,6 +226,7 @@ bool handle_request_stack(std::string segname) {
     if (!graphmod_ptr)
         ERRRETURNFALSE(__func__, "Unable to find and access shared segment "+segname);
 
+    graph_modifications_total.add(graphmod_ptr->data.size());
     if (!request_stack_valid(*graphmod_ptr, segname))
         ERRRETURNFALSE(__func__, "Request stack contains invalid request data");
 
@@ -373,6 +381,7 @@ bool handle_request_stack(std::string segname) {
         fzs.graph_ptr->update_t_modified(modification_time);
     }
     // Here is the call to the database-dependent library for modifications in the database.
+    Scoped_Timer pq_timer(graph_modifications_pq_seconds);
     if (!handle_Graph_modifications_pq(*fzs.graph_ptr, fzs.ga.config.dbname, fzs.ga.config.pq_schemaname, *results_ptr)) {
         ERRRETURNFALSE(__func__, "Unable to send in-memory Graph changes to storage.");
     }
@@ -393,6 +402,7 @@ void fzserverpq::handle_request_with_data_share(int new_socket, const std::strin
         send(new_socket, response_str.c_str(), response_str.size()+1, 0);
     } else {
         // send back error
+        request_stack_errors_total.add();
         VERYVERBOSEOUT("Sending error response. An 'error' data structure may or may not exist.\n");
         log("SHM","Graph request error");
         std::string response_str("ERROR");
@@ -406,12 +416,34 @@ void fzserverpq::handle_request_with_data_share(int new_socket, const std::strin
 void queing_fzserverpq::handle_request_with_data_share(int new_socket, const std::string & segment_name) {
     ERRTRACE;
 
-    std::lock_guard<std::mutex> lock(queueMutex); // thread-safety for pushing to special_FIFO and shm_FIFO
     VERYVERBOSEOUT("Adding shm request to queue.\n");
-    shm_FIFO.emplace(new_socket, segment_name);
-    if (special_FIFO.size() > 10) {
-        ADDWARNING(__func__, "Shm requests queue size > 10");
+    enqueue(shm_FIFO, new_socket, segment_name);
+}
+
+/**
+ * Handle a Graph modification request that was submitted through the
+ * request ring. The ring segment stays mapped, and the client is woken
+ * through the ring instead of with a TCP response.
+ * 
+ * @param requestname The ring request name (see Graphmodify.hpp).
+ */
+void queing_fzserverpq::handle_ring_request(const std::string & requestname) {
+    ERRTRACE;
+
+    VERYVERBOSEOUT("Received Graph request in request ring slot "+requestname+".\n");
+    log("SHM", "Graph ring request received");
+    graphmemman.cache();
+    bool success = handle_request_stack(requestname);
+    graphmemman.uncache();
+    if (success) {
+        VERYVERBOSEOUT("Signaling successful results data.\n");
+        log("SHM", "Graph request successful");
+    } else {
+        request_stack_errors_total.add();
+        VERYVERBOSEOUT("Signaling error. An 'error' data structure may or may not exist.\n");
+        log("SHM","Graph request error");
     }
+    complete_Graphmod_ring_request(*ring_ptr, requestname, success);
 }
 
 #endif // USE_MULTI_THREADING
@@ -34,6 +34,7 @@
 #include "binaryio.hpp"
 #include "apiclient.hpp"
 #include "tcpclient.hpp"
+#include "instrument.hpp"
 
 // local
 #include "tcp_server_handlers.hpp"
@@ -46,6 +47,11 @@ Set_Debug_LogFile("/dev/shm/fzserverpq-debug.log");
 
 using namespace fz;
 
+Instrument_Histogram graph_logtime_seconds("fzserverpq_graph_request_seconds", "Time spent handling /fz/graph/ requests.", "path=\"logtime\"");
+Instrument_Histogram graph_nodes_seconds("fzserverpq_graph_request_seconds", "Time spent handling /fz/graph/ requests.", "path=\"nodes\"");
+Instrument_Histogram graph_namedlists_seconds("fzserverpq_graph_request_seconds", "Time spent handling /fz/graph/ requests.", "path=\"namedlists\"");
+Instrument_Counter graph_request_failures_total("fzserverpq_graph_request_failures_total", "/fz/graph/ requests that were not handled successfully.");
+
 std::string standard_HTML_header(const std::string& titlestr, const std::string& bodytag = "") {
     std::string serverIPaddrstr(fzs.graph_ptr->get_server_IPaddr());
     std::string htmlstr("<html>\n<head>\n<link rel=\"icon\" href=\"/favicon-32x32.png\">\n<link rel=\"stylesheet\" href=\"http://");
@@ -1953,6 +1959,7 @@ bool handle_fz_vfs_database_request(int new_socket, const std::string & fzreques
                 return true;
             } else if (fzrequesturl.substr(11,8) == "?set=sim") {
                 SimPQ.SimulateChanges();
+                fzs.snapshot_allowed = false; // the in-memory Graph can now differ from the database
                 show_db_mode(new_socket);
                 return true;
             }
@@ -1987,6 +1994,7 @@ bool handle_fz_vfs_graph_request(int new_socket, const std::string & fzrequestur
 
     if ((fzrequesturl.substr(10,8) == "logtime?") && (fzrequesturl.size()>35)) {
 
+        Scoped_Timer timer(graph_logtime_seconds);
         std::string response_html;
         if (node_add_logged_time(fzrequesturl.substr(18))) {
             response_html = standard_HTML_header("fz: Add Logged Time") + "Logged time added to Node.\n</body>\n</html>\n";
@@ -1997,6 +2005,7 @@ bool handle_fz_vfs_graph_request(int new_socket, const std::string & fzrequestur
 
     if (fzrequesturl.substr(10,6) == "nodes/") {
         To_Debug_LogFile("Received /fz/graph/nodes/ request "+fzrequesturl);
+        Scoped_Timer timer(graph_nodes_seconds);
         std::string response_html;
         if (handle_node_direct_request(fzrequesturl.substr(16), response_html)) {
             return handle_request_response(new_socket, response_html, "Node request successful");
@@ -2004,6 +2013,7 @@ bool handle_fz_vfs_graph_request(int new_socket, const std::string & fzrequestur
     }
 
     if (fzrequesturl.substr(10,11) == "namedlists/") {
+        Scoped_Timer timer(graph_namedlists_seconds);
         std::string response_html;
         if (handle_named_list_direct_request(fzrequesturl.substr(21), response_html)) {
             return handle_request_response(new_socket, response_html, "NNL request successful");
@@ -2022,14 +2032,38 @@ const Command_Token_Map general_noargs_commands = {
     {"_stop", fznoargcmd_stop},
     {"verbosity?set=normal",fznoargcmd_verbosity_normal},
     {"verbosity?set=quiet",fznoargcmd_verbosity_quiet},
-    {"verbosity?set=very",fznoargcmd_verbosity_very}
+    {"verbosity?set=very",fznoargcmd_verbosity_very},
+    {"metrics", fznoargcmd_metrics},
+    {"metrics?format=json", fznoargcmd_metrics_json}
 };
 
 bool handle_status(int new_socket) {
-    std::string status_html(standard_HTML_header("fz: Server Status") + "Server status: LISTENING\n</body>\n</html>\n");
+    std::string status_html(standard_HTML_header("fz: Server Status") + "Server status: LISTENING\n");
+#ifdef USE_MULTI_THREADING
+    status_html += "<p>Request handling:</p>\n" + fzs.counters.html();
+#endif
+    status_html += "</body>\n</html>\n";
     return handle_request_response(new_socket, status_html, "Status reported");
 }
 
+/**
+ * Respond with the instrumentation metrics of this server (see instrument.hpp).
+ * 
+ * @param new_socket The communication socket file handler to respond to.
+ * @param json If true, respond in JSON format, otherwise in Prometheus text format.
+ * @return True if the metrics were sent.
+ */
+bool handle_metrics(int new_socket, bool json) {
+    if (json) {
+        server_response_json srvjson(metrics_json());
+        fzs.log("TCP", "Metrics reported");
+        return (srvjson.respond(new_socket) >= 0);
+    }
+    server_response_plaintext srvtxt(metrics_prometheus());
+    fzs.log("TCP", "Metrics reported");
+    return (srvtxt.respond(new_socket) >= 0);
+}
+
 bool handle_ipport(int new_socket) {
     std::string ipport_html(standard_HTML_header("fz: Server Address") + "Server address: "+fzs.ipaddrstr+"\n</body>\n</html>\n");
     return handle_request_response(new_socket, ipport_html, "IPPort reported");
@@ -2065,6 +2099,7 @@ bool handle_set_verbosity(int new_socket, std::string verbosity_str, bool veryve
  *   /fz/ErrQ
  *   /fz/_stop
  *   /fz/verbosity?set=<normal|quiet|very>
+ *   /fz/metrics[?format=json]
  *   /fz/db/...
  *   /fz/graph/...
  * 
@@ -2114,6 +2149,14 @@ bool handle_fz_vfs_request(int new_socket, const std::string & fzrequesturl) {
                 return handle_set_verbosity(new_socket, "very verbose", true, false);
             }
 
+            case fznoargcmd_metrics: {
+                return handle_metrics(new_socket, false);
+            }
+
+            case fznoargcmd_metrics_json: {
+                return handle_metrics(new_socket, true);
+            }
+
             default: {
                 // nothing to do here
             }
@@ -2126,7 +2169,11 @@ bool handle_fz_vfs_request(int new_socket, const std::string & fzrequesturl) {
 
     if (fzrequesturl.substr(4,6) == "graph/") {
         To_Debug_LogFile("Received /fz/graph/ request"+fzrequesturl);
-        return handle_fz_vfs_graph_request(new_socket, fzrequesturl);
+        if (!handle_fz_vfs_graph_request(new_socket, fzrequesturl)) {
+            graph_request_failures_total.add();
+            return false;
+        }
+        return true;
     }
 
     return false;
@@ -2353,12 +2400,8 @@ void fzserverpq::handle_special_purpose_request(int new_socket, const std::strin
 void queing_fzserverpq::handle_special_purpose_request(int new_socket, const std::string & request_str) {
     ERRTRACE;
 
-    std::lock_guard<std::mutex> lock(queueMutex); // thread-safety for pushing to special_FIFO and shm_FIFO
     VERYVERBOSEOUT("Adding special request to queue.\n");
-    special_FIFO.emplace(new_socket, request_str);
-    if (special_FIFO.size() > 10) {
-        ADDWARNING(__func__, "Special requests queue size > 10");
-    }
+    enqueue(special_FIFO, new_socket, request_str);
 }
 
 #endif // USE_MULTI_THREADING
@@ -66,6 +66,8 @@ enum fz_general_noarg_cmd {
     fznoargcmd_verbosity_very = 7,
     fznoargcmd_ipport = 8,
     fznoargcmd_tzadjust = 9,
+    fznoargcmd_metrics = 10,
+    fznoargcmd_metrics_json = 11,
     fznoargcmd_NUM
 };
 
@@ -125,6 +125,119 @@ eps_data_vec::eps_data_vec(const targetdate_sorted_Nodes & _incomplete_repeating
     updvar_chunks_required(_incomplete_repeating);
 }
 
+/**
+ * Allocate free slots from `_t_first` up to `t_beyond` and prepare the
+ * day-of-week bitmaps. Day boundaries are found with time_add_day(), so
+ * that they match time_day_of_week() of each slot, even across daylight
+ * savings changes.
+ */
+void eps_slots_array::init(time_t _t_first, time_t t_beyond) {
+    t_first = _t_first;
+    size_t num_slots = (t_beyond > t_first) ? (t_beyond - t_first + five_minutes_in_seconds - 1) / five_minutes_in_seconds : 0;
+    size_t num_words = (num_slots + word_bits - 1) / word_bits;
+
+    nodes.assign(num_slots, nullptr);
+    free_bits.assign(num_words, ~word_t(0));
+    if ((num_slots % word_bits) != 0) {
+        free_bits.back() = (word_t(1) << (num_slots % word_bits)) - 1; // slots beyond the map are never free
+    }
+
+    for (auto & dowvec : dow_bits) {
+        dowvec.assign(num_words, 0);
+    }
+    size_t idx = 0;
+    for (time_t t_day = day_start_time(t_first); idx < num_slots; ) {
+        time_t t_nextday = time_add_day(t_day);
+        if (t_nextday <= t_day) {
+            t_nextday = t_day + seconds_per_day;
+        }
+        auto & dowvec = dow_bits[time_day_of_week(t_day)];
+        for (; (idx < num_slots) && (t(idx) < t_nextday); ++idx) {
+            dowvec[idx / word_bits] |= word_t(1) << (idx % word_bits);
+        }
+        t_day = t_nextday;
+    }
+}
+
+/**
+ * @return Index of the first slot at or after `t`, or size() if there is none.
+ */
+size_t eps_slots_array::lower_bound(time_t t) const {
+    if (t <= t_first) {
+        return 0;
+    }
+    size_t idx = (t - t_first + five_minutes_in_seconds - 1) / five_minutes_in_seconds;
+    return (idx < size()) ? idx : size();
+}
+
+/**
+ * @return Index of the first free slot at or after `from`, or size() if there is none.
+ */
+size_t eps_slots_array::find_next_free(size_t from) const {
+    if (from >= size()) {
+        return size();
+    }
+    size_t w = from / word_bits;
+    word_t bits = free_bits[w] & (~word_t(0) << (from % word_bits));
+    while (bits == 0) {
+        if (++w >= free_bits.size()) {
+            return size();
+        }
+        bits = free_bits[w];
+    }
+    return w*word_bits + __builtin_ctzll(bits);
+}
+
+/**
+ * @return Index of the first free slot at or after `from` that falls on one of
+ *         the days of the week in `dow_mask`, or size() if there is none.
+ */
+size_t eps_slots_array::find_next_free(size_t from, dow_mask_t dow_mask) const {
+    if ((from >= size()) || (dow_mask == 0)) {
+        return size();
+    }
+    auto masked_free = [&](size_t w) {
+        word_t days = 0;
+        for (unsigned int d = 0; d < 7; ++d) {
+            if (dow_mask & (1 << d)) {
+                days |= dow_bits[d][w];
+            }
+        }
+        return free_bits[w] & days;
+    };
+    size_t w = from / word_bits;
+    word_t bits = masked_free(w) & (~word_t(0) << (from % word_bits));
+    while (bits == 0) {
+        if (++w >= free_bits.size()) {
+            return size();
+        }
+        bits = masked_free(w);
+    }
+    return w*word_bits + __builtin_ctzll(bits);
+}
+
+/**
+ * @return Index of the last free slot at or before `from`, or npos if there is none.
+ */
+size_t eps_slots_array::find_prev_free(size_t from) const {
+    if (from >= size()) {
+        if (empty()) {
+            return npos;
+        }
+        from = size() - 1;
+    }
+    size_t w = from / word_bits;
+    size_t shift = (word_bits - 1) - (from % word_bits);
+    word_t bits = free_bits[w] & (~word_t(0) >> shift);
+    while (bits == 0) {
+        if (w == 0) {
+            return npos;
+        }
+        bits = free_bits[--w];
+    }
+    return w*word_bits + (word_bits - 1) - __builtin_clzll(bits);
+}
+
 std::string EPS_map::show() {
     // *** So far, this version does not place old and new side by side. It only shows new.
     Node_twochar_encoder codebook(nodelist);
@@ -204,8 +317,8 @@ std::vector<std::string> EPS_map::html(const Node_twochar_encoder & codebook) {
         add_map_code(t, "##", maphtmlvec);
     }
 
-    for (const auto & [t, node_ptr] : slots) {
-        add_map_code(t, codebook.html_link_str(node_ptr, *this).c_str(), maphtmlvec);
+    for (size_t idx = 0; idx < slots.size(); ++idx) {
+        add_map_code(slots.t(idx), codebook.html_link_str(slots[idx], *this).c_str(), maphtmlvec);
         if ((fzu.config.showmaps_days>0) && (showmap_day >= fzu.config.showmaps_days)) {
             break;
         }
@@ -230,9 +343,7 @@ EPS_map::EPS_map(time_t _t, unsigned long days_in_map, targetdate_sorted_Nodes &
     firstday_slotspassed += ((t_diff % five_minutes_in_seconds) != 0) ? 1 : 0;
     first_slot_td = firstdaystart + (firstday_slotspassed+1)*five_minutes_in_seconds;
 
-    for (time_t t = first_slot_td; t < epochtime_aftermap; t += five_minutes_in_seconds) {
-        slots.emplace_hint(slots.end(), t, nullptr);
-    }
+    slots.init(first_slot_td, epochtime_aftermap);
     init_next_slot(); // This should be done at the start of any Placer function that uses next_slot.
 
     size_t vector_index = 0;
@@ -247,10 +358,9 @@ EPS_map::EPS_map(time_t _t, unsigned long days_in_map, targetdate_sorted_Nodes &
 }
 
 size_t EPS_map::bytes_estimate() {
-    size_t t_element_bytes = sizeof(time_t);
     size_t nodeptr_element_bytes = sizeof(Node_ptr);
-    size_t est_bytes = (t_element_bytes + nodeptr_element_bytes) * slots.size();
-    return est_bytes;
+    size_t bitmap_bytes = sizeof(eps_slots_array::word_t) * slots.free_bits.size() * 8; // free bits and 7 day-of-week masks
+    return (nodeptr_element_bytes * slots.size()) + bitmap_bytes;
 }
 
 /**
@@ -304,23 +414,23 @@ void EPS_map::process_chain(std::string& chain) {
  */
 bool EPS_map::reserve_exact(Node_ptr n_ptr, int chunks_req, time_t td) {
     bool overlap = false;
-    auto slot_it = slots.lower_bound(td); // at td or earlier
-    if (slot_it == slots.end()) {
+    size_t idx = slots.lower_bound(td); // at td or earlier
+    if (idx >= slots.size()) {
         return false;
     }
 
     for (size_t slots_req = chunks_req * slots_per_chunk; slots_req > 0; --slots_req) {
 
-        if (slot_it->second) {
+        if (!slots.is_free(idx)) {
             overlap = true;
         } else {
-            slot_it->second = n_ptr;
+            slots.assign(idx, n_ptr);
         }
 
-        if (slot_it == slots.begin()) {
+        if (idx == 0) {
             return overlap;
         }
-        --slot_it;
+        --idx;
     }
 
     return overlap;
@@ -337,24 +447,26 @@ bool EPS_map::reserve_exact(Node_ptr n_ptr, int chunks_req, time_t td) {
  */
 bool EPS_map::reserve_fixed(Node_ptr n_ptr, int chunks_req, time_t td) {
     size_t slots_req = chunks_req * slots_per_chunk;
-    auto slot_it = slots.lower_bound(td); // at td or earlier
-    if (slot_it == slots.end()) {
+    size_t idx = slots.lower_bound(td); // at td or earlier
+    if (idx >= slots.size()) {
         return false;
     }
 
-    do {
-        if (!slot_it->second) {
-            slot_it->second = n_ptr;
-            --slots_req;
+    while (slots_req > 0) {
+        idx = slots.find_prev_free(idx);
+        if (idx == eps_slots_array::npos) {
+            return true;
         }
+        slots.assign(idx, n_ptr);
+        --slots_req;
 
-        if (slot_it == slots.begin()) {
+        if (idx == 0) {
             return (slots_req > 0);
         }
-        --slot_it;            
-    } while (slots_req > 0);
+        --idx;
+    }
 
-    return false;            
+    return false;
 }
 
 /**
@@ -446,14 +558,12 @@ time_t EPS_map::UTD_end_of_day_adjusted(time_t td_raw) {
 time_t EPS_map::reserve(Node_ptr n_ptr, int chunks_req, bool is_UTD) {
     size_t slots_req = chunks_req * slots_per_chunk;
     time_t new_targetdate = RTt_unspecified;
-    for (; next_slot != slots.end(); ++next_slot) {
-        if (!next_slot->second) {
-            next_slot->second = n_ptr;
-            --slots_req;
-            if (slots_req == 0) {
-                new_targetdate = next_slot->first; // These are all unique target dates.
-                break;
-            }
+    for (next_slot = slots.find_next_free(next_slot); next_slot < slots.size(); next_slot = slots.find_next_free(next_slot + 1)) {
+        slots.assign(next_slot, n_ptr);
+        --slots_req;
+        if (slots_req == 0) {
+            new_targetdate = slots.t(next_slot); // These are all unique target dates.
+            break;
         }
     }
     if (new_targetdate == RTt_unspecified) {
@@ -485,27 +595,20 @@ time_t EPS_map::reserve_specific_days(Node_ptr n_ptr, int chunks_req, const std:
     size_t slots_req = chunks_req * slots_per_chunk;
     time_t new_targetdate = RTt_unspecified;
 
-    // VERYVERBOSEOUT("  Search from "+TimeStampYmdHM(next_slot->first)+'\n');
-    // bool slots_started = false;
-
-    for (; next_slot != slots.end(); ++next_slot) {
-        if (!next_slot->second) {
-            auto day_of_week = time_day_of_week(next_slot->first);
-            auto it = std::find(dayindices.begin(), dayindices.end(), day_of_week);
-            if (it != dayindices.end()) { // only apply slots on the right days
-
-                // if (!slots_started) {
-                //     VERYVERBOSEOUT("  First slot "+TimeStampYmdHM(next_slot->first)+'\n');
-                //     slots_started = true;
-                // }
+    eps_slots_array::dow_mask_t dow_mask = 0;
+    for (const auto & dayindex : dayindices) {
+        if ((dayindex >= 0) && (dayindex < 7)) {
+            dow_mask |= (1 << dayindex);
+        }
+    }
 
-                next_slot->second = n_ptr;
-                --slots_req;
-                if (slots_req == 0) {
-                    new_targetdate = next_slot->first; // These are all unique target dates.
-                    break;
-                }
-            }
+    // only apply slots on the right days
+    for (next_slot = slots.find_next_free(next_slot, dow_mask); next_slot < slots.size(); next_slot = slots.find_next_free(next_slot + 1, dow_mask)) {
+        slots.assign(next_slot, n_ptr);
+        --slots_req;
+        if (slots_req == 0) {
+            new_targetdate = slots.t(next_slot); // These are all unique target dates.
+            break;
         }
     }
     if (new_targetdate == RTt_unspecified) {
@@ -12,6 +12,7 @@
 #define __EPSMAP_HPP (__VERSION_HPP)
 
 #include <memory>
+#include <cstdint>
 
 // core
 #include "config.hpp"
@@ -23,8 +24,6 @@
 // local
 #include "fzupdate.hpp"
 
-#define USE_MAP_FOR_MAPPING
-
 using namespace fz;
 
 #define UNAVAILABLE_SLOT (Node_ptr)1
@@ -123,7 +122,43 @@ struct eps_data_vec: public eps_data_vec_t {
     size_t updvar_total_chunks_required_nonperiodic(const targetdate_sorted_Nodes & nodelist);
 };
 
-typedef std::map<time_t, Node_ptr> eps_slots_map_t;
+/**
+ * Contiguous storage of the 5 minute slots of an EPS map.
+ * 
+ * Slot `idx` begins at `t(idx)`. Occupancy is mirrored in a bitmap
+ * (bit set = free), so that searches for the next free slot skip 64
+ * slots at a time. Per-day-of-week bitmaps (by local time, like
+ * time_day_of_week()) are prepared once, so that day restricted
+ * searches never need to convert slot times.
+ */
+struct eps_slots_array {
+    typedef std::uint64_t word_t;
+    static constexpr size_t word_bits = 64;
+    static constexpr size_t npos = (size_t)-1;
+    typedef std::uint8_t dow_mask_t; ///< Bit d set means day of week d (0 = Sunday).
+
+    time_t t_first = 0;
+    std::vector<Node_ptr> nodes;
+    std::vector<word_t> free_bits;
+    std::vector<word_t> dow_bits[7];
+
+    void init(time_t _t_first, time_t t_beyond);
+
+    size_t size() const { return nodes.size(); }
+    bool empty() const { return nodes.empty(); }
+    time_t t(size_t idx) const { return t_first + (time_t)idx*five_minutes_in_seconds; }
+    Node_ptr operator[](size_t idx) const { return nodes[idx]; }
+    bool is_free(size_t idx) const { return (free_bits[idx / word_bits] >> (idx % word_bits)) & 1; }
+    void assign(size_t idx, Node_ptr n_ptr) {
+        nodes[idx] = n_ptr;
+        free_bits[idx / word_bits] &= ~(word_t(1) << (idx % word_bits));
+    }
+
+    size_t lower_bound(time_t t) const;
+    size_t find_next_free(size_t from) const;
+    size_t find_next_free(size_t from, dow_mask_t dow_mask) const;
+    size_t find_prev_free(size_t from) const;
+};
 
 struct btf_results {
     Boolean_Tag_Flags::boolean_flag btf;
@@ -156,8 +191,8 @@ struct EPS_map {
 
     std::map<Node_ID_key, size_t> node_vector_index;
 
-    eps_slots_map_t slots;
-    eps_slots_map_t::iterator next_slot;
+    eps_slots_array slots;
+    size_t next_slot = 0; ///< Index into slots, equal to slots.size() when the map is exhausted.
     bool slots_past_t_btf_limit = false;
     time_t t_previous_adjusted = RTt_unspecified;
 
@@ -168,7 +203,7 @@ struct EPS_map {
 
     size_t bytes_estimate();
 
-    void init_next_slot() { next_slot = slots.begin(); }
+    void init_next_slot() { next_slot = 0; }
 
     void process_chain(std::string& chain);
     void prepare_day_separator();
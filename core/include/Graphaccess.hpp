@@ -23,6 +23,15 @@
 #include "Logtypes.hpp"
 #include "fzpostgres.hpp"
 
+#ifndef FORMALIZER_ROOT
+    #define FORMALIZER_ROOT DEFAULTHOMEDIR "/.formalizer"
+#endif
+
+/// The memory-resident Log server (fzserverpq-log) indicates its presence with this lockfile.
+#define LOGSERVER_LOCKFILE FORMALIZER_ROOT "/.fzserverpq-log.lock"
+/// The memory-resident Log server stores its address and port here.
+#define LOGSERVER_ADDRESSFILE FORMALIZER_ROOT "/logserver_address"
+
 namespace fz {
 
 // foward declarations of classes external to this file
@@ -54,14 +63,27 @@ struct Graph_access: public Postgres_access {
 public:
     //std::unique_ptr<Graph> request_Graph_copy();
     Graph * request_Graph_copy(bool remove_on_exit = true, Graph_Config_Options * graph_config_ptr = nullptr); // *** switched to this, because Boost Interprocess has difficulty with smart pointers
+    Graph * request_Graph_copy_or_snapshot(const std::string & snapshotpath, int64_t & dbstamp, bool remove_on_exit = true, Graph_Config_Options * graph_config_ptr = nullptr, int64_t * dbexternal = nullptr); ///< Server warm start.
     std::unique_ptr<Log> request_Log_copy();
     std::unique_ptr<Log> request_Log_excerpt(const Log_filter & filter);
+    std::unique_ptr<Log> request_Log_search_excerpt(const Log_search & search);
+    bool request_Log_excerpt_from_server(const Log_filter & filter, Log & log);
+    bool request_Nodes_logged_minutes(const base_Node_Set & nodes, time_t t_to, Node_minutes_map & minutes); ///< Batched alternative to per-Node Log excerpts.
     void rapid_access_init(Graph &graph, Log &log);                                                  ///< Once both Graph and Log instances have been loaded.
     //std::pair<std::unique_ptr<Graph>, std::unique_ptr<Log>> request_Graph_and_Log_copies_and_init(); ///< Combine the three functions above.
     std::pair<Graph*, std::unique_ptr<Log>> request_Graph_and_Log_copies_and_init(bool remove_on_exit = true, Graph_Config_Options * graph_config_ptr = nullptr); ///< Combine the three functions above.
     std::pair<Graph *, std::unique_ptr<Log>> access_shared_Graph_and_request_Log_copy_with_init();
 };
 
+/**
+ * Determine if a memory-resident Log server (fzserverpq-log) is running on
+ * this machine, and at which port it listens.
+ * 
+ * @param[out] port_number Receives the port number of the Log server.
+ * @return True if a Log server is running.
+ */
+bool find_Log_server(uint16_t & port_number);
+
 } // namespace fz
 
 #endif // __GRAPHACCESS_HPP
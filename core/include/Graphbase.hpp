@@ -185,18 +185,34 @@ struct ID_TimeStamp {
     GraphIDyear year;
 
     /// Initializes as NODE_NULL_IDSTAMP.
-    ID_TimeStamp(): minor_id(0), second(0), minute(0), hour(0), day(0), month(0), year(0) {}
+    constexpr ID_TimeStamp(): minor_id(0), second(0), minute(0), hour(0), day(0), month(0), year(0) {}
     //ID_TimeStamp(const ID_TimeStamp & _idT): minor_id(_idT.minor_id), second(_idT.second), hour(_idT.hour), day(_idT.day), month(_idT.month), year(_idT.year) {}
 
     /// standardization functions and operators
     bool isnullstamp() const { return (month == 0) || (year<1900); }
-    bool operator< (const ID_TimeStamp& rhs) const {
-        return std::tie(year,month,day,hour,minute,second,minor_id)
-             < std::tie(rhs.year,rhs.month,rhs.day,rhs.hour,rhs.minute,rhs.second,rhs.minor_id);
+    bool operator< (const ID_TimeStamp& rhs) const { return packed() < rhs.packed(); }
+    bool operator== (const ID_TimeStamp& rhs) const { return packed() == rhs.packed(); }
+
+    /**
+     * All components packed into one 64-bit integer, from the year (most
+     * significant) to the minor_id (least significant), so that comparing
+     * packed values orders ID stamps the same way as lexicographical
+     * comparison of the components.
+     */
+    constexpr uint64_t packed() const {
+        return (uint64_t(year) << 48) | (uint64_t(month) << 40) | (uint64_t(day) << 32)
+             | (uint64_t(hour) << 24) | (uint64_t(minute) << 16) | (uint64_t(second) << 8) | uint64_t(minor_id);
     }
-    bool operator== (const ID_TimeStamp& rhs) const {
-        return std::tie(year,month,day,hour,minute,second,minor_id)
-             == std::tie(rhs.year,rhs.month,rhs.day,rhs.hour,rhs.minute,rhs.second,rhs.minor_id);
+    static constexpr ID_TimeStamp from_packed(uint64_t p) {
+        ID_TimeStamp idT;
+        idT.year = p >> 48;
+        idT.month = (p >> 40) & 0xff;
+        idT.day = (p >> 32) & 0xff;
+        idT.hour = (p >> 24) & 0xff;
+        idT.minute = (p >> 16) & 0xff;
+        idT.second = (p >> 8) & 0xff;
+        idT.minor_id = p & 0xff;
+        return idT;
     }
     std::tm get_local_time();
     time_t get_epoch_time(); // inlined below
@@ -245,8 +261,8 @@ struct ID_TimeStamp {
  * 
  * In various containers, the ordering of Node ID keys is determined
  * by the provided operator<(). It calls its equivalent in ID_TimeStamp,
- * where std::tie() enables lexicographical comparison, from the largest
- * temporal component to the smallest.
+ * which compares packed 64-bit values that order lexicographically, from
+ * the largest temporal component to the smallest.
  * 
  * The default constructor is provided for various special use cases such
  * as initialization of containers. The `isnullkey()` function can test
@@ -284,9 +300,8 @@ typedef std::set<Node_ID_key, std::less<Node_ID_key>> base_Node_Set; // Unshared
  * and can throw an ID_exception.
  * 
  * In various containers, the ordering of Edge ID keys is determined
- * by the provided operator<(). It uses std::tie() to sequentially
- * call its equivalent in ID_TimeStamp for sup and then for dep, where
- * std::tie() is used again to enable lexicographical comparison, from
+ * by the provided operator<(). It compares the packed ID_TimeStamp
+ * values of sup and then of dep, which order lexicographically, from
  * the largest temporal component to the smallest.
  * 
  * The default constructor is provided for various special use cases such
@@ -305,7 +320,10 @@ struct Edge_ID_key {
 
     /// standardization functions and operators
     bool isnullkey() const { return dep.idT.month == 0; }
-    bool operator<(const Edge_ID_key &rhs) const { return std::tie(sup,dep) < std::tie(rhs.sup,rhs.dep); }
+    bool operator<(const Edge_ID_key &rhs) const {
+        uint64_t sup_p = sup.idT.packed(), rhs_sup_p = rhs.sup.idT.packed();
+        return (sup_p < rhs_sup_p) || ((sup_p == rhs_sup_p) && (dep.idT.packed() < rhs.dep.idT.packed()));
+    }
     std::string str() const; // inlined below
 
     friend bool identical_Edge_ID_key(const Edge_ID_key & key1, const Edge_ID_key & key2, std::string & trace);
@@ -553,8 +571,11 @@ time_t Add_to_Date(time_t t, td_pattern pattern, int every);
  * @return UNIX epoch time equivalent of Node ID time stamp.
  */
 inline time_t ID_TimeStamp::get_epoch_time() {
-    std::tm tm = get_local_time();
-    return mktime(&tm);
+    if (isnullstamp()) {
+        std::tm tm = get_local_time();
+        return mktime(&tm);
+    }
+    return local_epoch_time(year, month, day, hour, minute, second);
 }
 
 /**
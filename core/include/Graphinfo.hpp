@@ -15,6 +15,7 @@
 
 // std
 #include <memory>
+#include <vector>
 
 // core
 #include "ReferenceTime.hpp"
@@ -99,7 +100,7 @@ bool Node_Dependencies_fulldepth(const Node* node_ptr, Subtree_Branch_Map & full
 
 /**
  * Collect the subtrees that are the full dependencies of all Nodes in a
- * Named Nodes List.
+ * Named Nodes List. All subtrees are collected in one traversal.
  * 
  * @param nnl_str Named Nodes List.
  * @return A map in which the keys are the Node IDs of Nodes in the NNL and
@@ -122,6 +123,7 @@ enum BTF_source {
 class Map_of_Subtrees {
 protected:
     Graph * graph_ptr = nullptr; // Populated during collect().
+    std::map<Node_ID_key, Node_ID_key> subtree_heads; // Subtree head of each head and subtree Node, populated during collect().
 
 public:
     map_of_subtrees_t map_of_subtrees;
@@ -164,8 +166,6 @@ enum Prerequisite_States {
 };
 
 // *** TODO: Could use maps instead of vectors.
-// *** TODO: Further speed-up is possible by caching prerequisites and provides
-//           for each Node.
 struct Prerequisite {
     std::string prereq;
     Prerequisite_States _state = unsolved;
@@ -177,15 +177,46 @@ struct Prerequisite {
 
     Prerequisite_States state() const { return _state; }
 
+    void update(Node * provider);
+
     void update(const std::vector<std::string> & provided_vec, Node * provider);
 };
 
+/**
+ * Returns the prerequisites in the @PREREQS:...@ tag of a Node. If the Graph
+ * capability index is active (see Graph::build_capability_index()) then
+ * they are taken from there instead of being parsed from the Node text.
+ * 
+ * @param node A Node.
+ * @param check_prerequisites If true then determine the state of each prerequisite.
+ * @return A vector of prerequisites.
+ */
 std::vector<Prerequisite> get_prerequisites(const Node & node, bool check_prerequisites = false);
 
+/**
+ * Returns the capabilities in the @PROVIDES:...@ tag of a Node, from the
+ * Graph capability index if that is active.
+ */
 std::vector<std::string> get_provides_capabilities(const Node & node);
 
+/**
+ * Determine which prerequisites are provided by dependencies of a Node, up
+ * to `go_deeper` levels below its direct dependencies. A prerequisite is
+ * fulfilled if a completed dependency provides it.
+ * 
+ * If the Graph capability index is active then the known providers of the
+ * prerequisites are matched against the set of dependencies, which are
+ * collected once. Otherwise, the text of each dependency is parsed.
+ */
 void check_prerequisites_provided_by_dependencies(const Node & node, std::vector<Prerequisite> & prereqs, int go_deeper = 10);
 
+/**
+ * Ways to apply the text of a Node_Filter. The phrase is searched for as is.
+ * Otherwise, the text is split into space separated terms and all of them,
+ * or any one of them, must be found.
+ */
+enum text_match_mode { text_match_phrase, text_match_all_terms, text_match_any_term };
+
 /**
  * Filter class that helps construct filter specifications. This can be
  * used to search for Node subsets, for example.
@@ -198,6 +229,7 @@ struct Node_Filter {
     bool has_invalid_targetdate = false;
     tdproperty_binary_pattern tdpropbinpattern;
     bool case_sensitive = true;
+    text_match_mode text_mode = text_match_phrase;
     Edit_flags filtermask;
     bool self_is_superior = false; // supspec_match filter
     bool has_no_superiors = false; // supspec_match filter
@@ -205,12 +237,17 @@ struct Node_Filter {
     std::unique_ptr<Subtree_Branch_Map> subtree_uptr; // must be valid for Edit_subtreematch()
     std::unique_ptr<Map_of_Subtrees> nnltree_uptr; // must be valid for Edit_nnltreematch()
 
+    std::vector<std::string> text_terms() const;
+
     std::string str();
 };
 
 /**
  * Finds all Nodes that match a specified Node_Filter.
  * 
+ * If the Graph text index is active (see Graph::build_text_index()) then
+ * a text filter only tests the candidate Nodes found in that index.
+ * 
  * @param graph A valid Graph data structure.
  * @param nodefilter A specified Node_Filter.
  * @param excerpt size limit, 0 means unlimited.
@@ -227,6 +264,88 @@ targetdate_sorted_Nodes Nodes_subset(Graph & graph, const Node_Filter & nodefilt
  */
 targetdate_sorted_Nodes Nodes_incomplete_by_targetdate(Graph & graph);
 
+/**
+ * A range within one of the shared memory target date indices of a Graph
+ * (see Graph::build_targetdate_index()). This can be iterated directly, e.g.
+ * `for (const auto & [tdkey, node_ptr] : range)`, without allocating a copy.
+ * The keys are unadjusted effective target dates (see Graph::tz_adjust()).
+ */
+struct Targetdate_Index_range {
+    Targetdate_Index_Map::const_iterator first;
+    Targetdate_Index_Map::const_iterator last;
+
+    Targetdate_Index_Map::const_iterator begin() const { return first; }
+    Targetdate_Index_Map::const_iterator end() const { return last; }
+    bool empty() const { return first == last; }
+};
+
+/**
+ * Obtain a range of incomplete Nodes with effective target dates in the
+ * interval [t_from, t_before) from the Graph target date index.
+ * 
+ * Note: This returns an empty range if the index is not active. Use
+ *       `graph.targetdate_index_is_active()` to decide if a fallback
+ *       to Nodes_incomplete_by_targetdate() is needed.
+ * 
+ * @param graph A valid Graph data structure.
+ * @param t_from Earliest effective target date to include.
+ * @param t_before Effective target date beyond the range (RTt_maxtime includes all remaining).
+ * @param repeating_only If true then use the index of incomplete and repeating Nodes.
+ * @return A range of Targetdate_Index_Map elements.
+ */
+Targetdate_Index_range Nodes_incomplete_by_targetdate_range(const Graph & graph, time_t t_from = std::numeric_limits<time_t>::min(), time_t t_before = RTt_maxtime, bool repeating_only = false);
+
+/**
+ * Merges a list of target date sorted Nodes with the repeat instances of the
+ * repeating Nodes in it, one instance at a time.
+ * 
+ * The instances are produced in the same order as they appear in the list
+ * returned by `Nodes_with_repeats_by_targetdate()`. Each repeating Node that
+ * has been reached in `sortednodes` has one entry in a min-heap, holding its
+ * next repeat target date. Obtaining the first N instances therefore takes work
+ * proportional to N (and the Nodes passed over), not to all instances up to
+ * `t_max`, and no memory is allocated per instance.
+ * 
+ * Note that `t_max < 0 ` is interpreted as `t_max = RTt_maxtime`, and that the
+ * referenced `sortednodes` must remain unchanged while the merge is in use.
+ * 
+ * For example, to process the next 50 instances:
+ *   Targetdate_Repeats_Merge merged(sortednodes, t_max);
+ *   time_t t;
+ *   Node_ptr node_ptr;
+ *   for (size_t i = 0; (i < 50) && merged.next(t, node_ptr); ++i) { ... }
+ */
+class Targetdate_Repeats_Merge {
+protected:
+    struct Repeat_Instance {
+        time_t t;
+        size_t order;  ///< Position of the Node in sortednodes, orders equal target dates.
+        Node_ptr node_ptr;
+        int span;      ///< Remaining instances (ignored if unlimited).
+        bool unlimited;
+    };
+
+    const targetdate_sorted_Nodes & sortednodes;
+    targetdate_sorted_Nodes::const_iterator base_it;
+    size_t base_order = 0;
+    time_t t_max;
+    bool limit_repeats_only;
+    std::vector<Repeat_Instance> heap;
+
+    static bool later(const Repeat_Instance & a, const Repeat_Instance & b) {
+        return (a.t > b.t) || ((a.t == b.t) && (a.order > b.order));
+    }
+    bool base_available() const;
+    bool heap_is_next() const;
+    void add_repeating();
+
+public:
+    Targetdate_Repeats_Merge(const targetdate_sorted_Nodes & _sortednodes, time_t _t_max, bool _limit_repeats_only = false);
+
+    bool next(time_t & t, Node_ptr & node_ptr);
+    time_t next_targetdate();
+};
+
 /**
  * Add virtual Nodes to produce a list where repeating Nodes appear at their
  * pattern-specified repeat target dates.
@@ -237,6 +356,9 @@ targetdate_sorted_Nodes Nodes_incomplete_by_targetdate(Graph & graph);
  * be prepared with `Nodes_incomplete_by_targetdate()`. Otherwise, use an alternative
  * preparation.
  * 
+ * Instances are generated with `Targetdate_Repeats_Merge`, so that the work done
+ * is proportional to `N_max` when that is the tighter limit.
+ * 
  * @param sortednodes A list of target date sorted Node pointers.
  * @param t_max Limit to which to generate the resulting list of Node pointers.
  * @param N_max Maximum size of list to return (zero means no size limit).
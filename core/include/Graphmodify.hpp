@@ -14,7 +14,8 @@
 //#define USE_COMPILEDPING
 
 // std
-//#include <>
+#include <atomic>
+#include <sys/types.h>
 
 // core
 #include "error.hpp"
@@ -296,6 +297,87 @@ Graphmod_results * initialized_results_response(std::string segname);
 /// See for example how this is used in fzgraph.
 Graphmod_results * find_results_response_in_shared_memory(std::string segment_name);
 
+/**
+ * Graph modification request ring
+ * 
+ * Instead of creating a new shared memory segment and sending its name over
+ * TCP for each request, clients can submit Graph modification requests through
+ * a long-lived segment that `fzserverpq` creates at startup. The segment holds
+ * a fixed number of request slots. Each slot is claimed and released without
+ * locks (by atomic state changes), and the client and server wake each other
+ * with futexes on the slot state and the submission counter.
+ * 
+ * A request in slot N is identified by a request name "<ring-segment>#N". The
+ * functions above that take a segment name accept such request names as well,
+ * in which case the request objects are named "graphmod#N", "results#N" and
+ * "error#N" in the ring segment.
+ * 
+ * Clients use the ring transparently: allocate_Graph_modifications_in_shared_memory()
+ * claims a slot when the server provides the ring, and server_request_with_shared_data()
+ * then submits through the ring. Otherwise, both fall back to a segment per request.
+ */
+constexpr const char * graphmod_ring_segname = "fzgraphmod.ring";
+constexpr unsigned int graphmod_ring_slots = 16;
+constexpr unsigned long graphmod_ring_default_size = 16*1024*1024;
+
+enum Graphmod_slot_state: uint32_t {
+    graphmod_slot_free,
+    graphmod_slot_claimed,   ///< A client is building a request.
+    graphmod_slot_submitted, ///< Waiting for or being handled by the server.
+    graphmod_slot_results,   ///< Handled, results available.
+    graphmod_slot_error      ///< Handled, error available (if any).
+};
+
+struct Graphmod_ring_slot {
+    std::atomic<uint32_t> state = graphmod_slot_free; ///< Graphmod_slot_state, also the futex word the client waits on.
+    std::atomic<uint32_t> seq = 0;                    ///< Submission order.
+    std::atomic<pid_t> client_pid = 0;                ///< Used to reclaim slots of clients that exited.
+};
+
+struct Graphmod_ring {
+    std::atomic<pid_t> server_pid;       ///< Zero when no server handles requests.
+    std::atomic<uint32_t> next_seq = 0;
+    std::atomic<uint32_t> submitted = 0; ///< Incremented after each submission, the futex word the server waits on.
+    Graphmod_ring_slot slots[graphmod_ring_slots];
+
+    Graphmod_ring(pid_t _server_pid): server_pid(_server_pid) {}
+};
+
+/// Returns the name of the segment in which the request or request slot resides.
+std::string graphmod_request_segment(const std::string & requestname);
+
+/// Server: create the request ring segment. Returns nullptr if that failed.
+Graphmod_ring * create_Graphmod_ring(unsigned long ringsize = graphmod_ring_default_size);
+
+/**
+ * Server: wait for the next submitted request in the ring.
+ * 
+ * @param ring The request ring.
+ * @param timeout_ms Maximum time to wait.
+ * @return The request name of the oldest submitted request, or empty if none arrived in time.
+ */
+std::string wait_Graphmod_ring_request(Graphmod_ring & ring, unsigned int timeout_ms);
+
+/// Server: set the outcome of a ring request and wake the client.
+void complete_Graphmod_ring_request(Graphmod_ring & ring, const std::string & requestname, bool success);
+
+/// Server: stop accepting ring requests (clients fall back to segments per request).
+void close_Graphmod_ring(Graphmod_ring & ring);
+
+/// Client: returns the ring request name that replaced a segment, or the segment name itself.
+std::string graphmod_request_name(const std::string & segname);
+
+/**
+ * Client: submit a request prepared in a ring slot and wait for the server.
+ * 
+ * @param requestname The ring request name (see graphmod_request_name()).
+ * @return "RESULTS" or "ERROR" as with a TCP request, or empty if the server became unavailable.
+ */
+std::string submit_Graphmod_ring_request(const std::string & requestname);
+
+/// Client: free the request objects in a ring slot and release the slot.
+void release_Graphmod_ring_request(const std::string & requestname);
+
 /// Create a Node in the Graph's shared segment and add it to the Graph.
 Node_ptr Graph_modify_add_node(Graph & graph, const std::string & graph_segname, const Graphmod_data & gmoddata);
 
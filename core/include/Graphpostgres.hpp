@@ -37,8 +37,9 @@
  * (be it the Graph table, the Task Log table, etc).
  * 
  * 
- * You could also use COPY (https://www.postgresql.org/docs/9.6/sql-copy.html) to copy
- * data between database and file.
+ * Storing and loading a complete Graph uses COPY (https://www.postgresql.org/docs/9.6/sql-copy.html)
+ * in text format (see store_Graph_pq() and load_Graph_pq()), so that the number of
+ * round-trips does not grow with the number of Nodes and Edges.
  * 
  */
 
@@ -90,6 +91,12 @@ bool add_Edge_pq(PGconn *conn, std::string schemaname, const Edge *edge);
 
 bool remove_Edge_pq(PGconn *conn, std::string schemaname, const Edge_ID_key & id);
 
+bool install_Graph_change_stamp_pq(PGconn* conn, std::string schemaname);
+
+bool read_Graph_change_stamp_pq(PGconn* conn, std::string schemaname, int64_t & stamp, int64_t * external = nullptr);
+
+bool Graph_change_stamp_pq(std::string dbname, std::string schemaname, int64_t & stamp, int64_t * external = nullptr);
+
 bool store_Graph_pq(const Graph& graph, std::string dbname, std::string schemaname, void (*progressfunc)(unsigned long, unsigned long) = NULL);
 
 bool load_Graph_pq(Graph& graph, std::string dbname, std::string schemaname);
@@ -144,6 +151,7 @@ public:
     std::string All_Topic_keyword_pqstr();
     std::string All_Topic_relevance_pqstr();
     std::string All_Topic_Data_pqstr();
+    std::string All_Topic_Data_copystr();
 };
 
 /**
@@ -172,6 +180,7 @@ public:
     std::string tdevery_pqstr();
     std::string tdspan_pqstr();
     std::string All_Node_Data_pqstr();
+    std::string All_Node_Data_copystr();
 };
 
 /**
@@ -193,6 +202,7 @@ public:
     std::string urgency_pqstr();
     std::string priority_pqstr();
     std::string All_Edge_Data_pqstr();
+    std::string All_Edge_Data_copystr();
 };
 
 } // namespace fz
@@ -60,6 +60,7 @@
 // std
 #include <ctime>
 #include <cstdint>
+#include <unistd.h>
 #include <map>
 #include <set>
 #include <vector>
@@ -202,6 +203,33 @@ public:
      * @return The address of a Graph in shared memory or nullptr if not found.
      */
     Graph_ptr get_Graph(Graph_ptr & graph_ptr);
+    /**
+     * Write an image of the active shared memory segment to a snapshot file.
+     * 
+     * The image is preceded by a header with format and build identifiers,
+     * the segment size, a checksum and the database change stamp that the
+     * caller associates with the Graph state (see restore_Graph_snapshot()).
+     * The file is written to a temporary path and then renamed, so that an
+     * interrupted save never leaves a partial snapshot.
+     * 
+     * @param snapshotpath Path of the snapshot file.
+     * @param dbstamp Database change stamp that matches the Graph in the segment.
+     * @return True if the snapshot was written successfully.
+     */
+    bool save_Graph_snapshot(const std::string & snapshotpath, int64_t dbstamp);
+    /**
+     * Server, recreate the 'fzgraph' shared memory segment from a snapshot file.
+     * 
+     * This works because all references within the segment are offset pointers.
+     * The snapshot is rejected (returning nullptr) if its header does not match
+     * this build, if `dbstamp` differs from the stamp stored at save time, or if
+     * the checksum fails. The caller should then load the Graph from the database.
+     * 
+     * @param snapshotpath Path of the snapshot file.
+     * @param dbstamp Current database change stamp.
+     * @return Pointer to the restored Graph, or nullptr if the snapshot was not usable.
+     */
+    Graph_ptr restore_Graph_snapshot(const std::string & snapshotpath, int64_t dbstamp);
     void info(Graph_info_label_value_pairs & meminfo);
     std::string info_str();
 };
@@ -275,6 +303,232 @@ typedef std::pair<const Edge_ID_key, Graph_Edge_ptr> Edge_Map_value_type;
 typedef bi::allocator<Edge_Map_value_type, segment_manager_t> Edge_Map_value_type_allocator;
 typedef bi::map<Edge_ID_key, Graph_Edge_ptr, std::less<Edge_ID_key>, Edge_Map_value_type_allocator> Edge_Map;
 
+/// Edge ID key packed for the Edge hash index (see ID_TimeStamp::packed()).
+struct Packed_Edge_key {
+    uint64_t dep = 0;
+    uint64_t sup = 0;
+
+    Packed_Edge_key() {}
+    Packed_Edge_key(const Edge_ID_key & ekey): dep(ekey.dep.idT.packed()), sup(ekey.sup.idT.packed()) {}
+    bool operator== (const Packed_Edge_key& rhs) const { return (dep == rhs.dep) && (sup == rhs.sup); }
+    bool operator!= (const Packed_Edge_key& rhs) const { return !(*this == rhs); }
+};
+
+inline size_t ID_hash(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+inline size_t ID_hash(const Packed_Edge_key & k) { return ID_hash(k.dep ^ (k.sup * 0x9e3779b97f4a7c15ULL)); }
+
+/**
+ * Hash index of Graph elements by packed ID key, kept alongside the ordered
+ * Node_Map and Edge_Map for constant time lookup (see Graph::Node_by_id()
+ * and Graph::Edge_by_id()).
+ *
+ * This is an open addressing table in the Graph's shared memory segment.
+ * Collisions are resolved by linear probing and erasure moves subsequent
+ * entries back, so that no tombstones are needed. The capacity is a power
+ * of two and the table is at most three quarters full.
+ */
+template <typename K, typename T>
+class ID_Hash_Index {
+public:
+    struct Slot {
+        K key;
+        bi::offset_ptr<T> ptr; ///< nullptr in an empty slot
+    };
+    typedef bi::allocator<Slot, segment_manager_t> Slot_allocator;
+    typedef bi::vector<Slot, Slot_allocator> Slot_Vector;
+
+protected:
+    Slot_Vector slots;
+    size_t num = 0;
+
+    size_t mask() const { return slots.size()-1; }
+
+    size_t probe(const K & key) const {
+        size_t i = ID_hash(key) & mask();
+        while (slots[i].ptr && (slots[i].key != key)) {
+            i = (i+1) & mask();
+        }
+        return i;
+    }
+
+    void rehash(size_t capacity) {
+        Slot_Vector fresh(capacity, Slot(), slots.get_allocator()); // may throw, leaving the index unchanged
+        for (const auto & slot : slots) {
+            if (slot.ptr) {
+                size_t i = ID_hash(slot.key) & (capacity-1);
+                while (fresh[i].ptr) {
+                    i = (i+1) & (capacity-1);
+                }
+                fresh[i] = slot;
+            }
+        }
+        slots.swap(fresh);
+    }
+
+public:
+    ID_Hash_Index(const void_allocator & alloc): slots(alloc) {}
+
+    size_t size() const { return num; }
+
+    T * find(const K & key) const {
+        if (num == 0) return nullptr;
+        return slots[probe(key)].ptr.get();
+    }
+
+    /// Insert or replace. This can throw if shared memory is exhausted.
+    void insert(const K & key, T * ptr) {
+        if (((num+1)*4) > (slots.size()*3)) {
+            rehash((slots.size() < 64) ? 64 : slots.size()*2);
+        }
+        Slot & slot = slots[probe(key)];
+        if (!slot.ptr) {
+            slot.key = key;
+            ++num;
+        }
+        slot.ptr = ptr;
+    }
+
+    bool erase(const K & key) {
+        if (num == 0) return false;
+        size_t i = probe(key);
+        if (!slots[i].ptr) return false;
+        // Move back entries whose probe sequence passes through the vacated slot.
+        for (size_t j = (i+1) & mask(); slots[j].ptr; j = (j+1) & mask()) {
+            size_t home = ID_hash(slots[j].key) & mask();
+            if (((j - home) & mask()) >= ((j - i) & mask())) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i] = Slot();
+        --num;
+        return true;
+    }
+
+    void clear() {
+        slots.clear();
+        slots.shrink_to_fit();
+        num = 0;
+    }
+};
+
+typedef ID_Hash_Index<uint64_t, Node> Node_Hash_Index;
+typedef ID_Hash_Index<Packed_Edge_key, Edge> Edge_Hash_Index;
+
+/**
+ * Keys of the secondary index of incomplete Nodes by effective target date
+ * (see Graph::build_targetdate_index()). Nodes with the same effective
+ * target date are ordered by Node ID, the same order in which they appear
+ * in a targetdate_sorted_Nodes map built by iterating over Graph::nodes.
+ */
+struct Targetdate_Index_key {
+    time_t td;
+    Node_ID_key nkey;
+    Targetdate_Index_key(time_t _td, const Node_ID_key & _nkey): td(_td), nkey(_nkey) {}
+    Targetdate_Index_key(time_t _td): td(_td) {} ///< Use this one for lower_bound() searches.
+    bool operator< (const Targetdate_Index_key& rhs) const {
+        if (td != rhs.td) return td < rhs.td;
+        return nkey < rhs.nkey;
+    }
+};
+
+typedef std::pair<const Targetdate_Index_key, Graph_Node_ptr> Targetdate_Index_value_type;
+typedef bi::allocator<Targetdate_Index_value_type, segment_manager_t> Targetdate_Index_value_type_allocator;
+typedef bi::map<Targetdate_Index_key, Graph_Node_ptr, std::less<Targetdate_Index_key>, Targetdate_Index_value_type_allocator> Targetdate_Index_Map;
+
+/**
+ * The trigram index of Node text (see Graph::build_text_index()) folds
+ * characters into a small alphabet: letters without case, digits, any other
+ * ASCII character, and any byte of a multi-byte UTF8 character. A trigram is
+ * the number formed by three consecutive folded characters.
+ */
+constexpr unsigned int text_index_alphabet = 38;
+constexpr unsigned int text_index_trigrams = text_index_alphabet*text_index_alphabet*text_index_alphabet;
+
+/// Free shared memory that the trigram index must leave for changes to the Graph itself.
+constexpr std::size_t text_index_memory_reserve = 2*1024*1024;
+
+inline unsigned int text_index_fold(unsigned char c) {
+    if ((c >= 'a') && (c <= 'z')) return c - 'a';
+    if ((c >= 'A') && (c <= 'Z')) return c - 'A';
+    if ((c >= '0') && (c <= '9')) return 26 + (c - '0');
+    if (c >= 0x80) return 37;
+    return 36;
+}
+
+typedef bi::allocator<uint8_t, segment_manager_t> Text_Index_Bytes_allocator;
+typedef bi::vector<uint8_t, Text_Index_Bytes_allocator> Text_Index_Bytes;
+
+/**
+ * Posting list of one trigram in the trigram index of Node text. It holds the
+ * ascending ordinals of the Nodes whose text contains the trigram, stored as
+ * variable length encoded differences to keep the index compact.
+ */
+struct Text_Index_Postings {
+    Text_Index_Bytes deltas;
+    uint32_t last = 0; ///< largest ordinal in the list (0 if empty)
+    uint32_t num = 0;  ///< number of ordinals in the list
+
+    Text_Index_Postings(const void_allocator & alloc): deltas(alloc) {}
+
+    void append(uint32_t ordinal); // ordinal must be greater than last
+    void decode(std::vector<uint32_t> & ordinals) const;
+    void encode(const std::vector<uint32_t> & ordinals);
+};
+
+typedef bi::allocator<Text_Index_Postings, segment_manager_t> Text_Index_Postings_allocator;
+typedef bi::vector<Text_Index_Postings, Text_Index_Postings_allocator> Text_Index_Table;
+typedef bi::allocator<Graph_Node_ptr, segment_manager_t> Graph_Node_ptr_allocator;
+typedef bi::vector<Graph_Node_ptr, Graph_Node_ptr_allocator> Text_Index_Nodes;
+
+typedef uint32_t Capability_ID;
+typedef bi::allocator<Capability_ID, segment_manager_t> Capability_ID_allocator;
+typedef bi::vector<Capability_ID, Capability_ID_allocator> Capability_IDs;
+typedef bi::basic_string<char, std::char_traits<char>, char_allocator> Capability_String;
+
+/**
+ * A capability named in @PREREQS:...@ or @PROVIDES:...@ tags of Node text,
+ * and the Nodes that provide it (see Graph::build_capability_index()).
+ */
+struct Capability {
+    Capability_String name;
+    bi::vector<Graph_Node_ptr, Graph_Node_ptr_allocator> providers;
+
+    Capability(const void_allocator & alloc): name(alloc), providers(alloc) {}
+};
+
+typedef bi::allocator<Capability, segment_manager_t> Capability_allocator;
+typedef bi::vector<Capability, Capability_allocator> Capability_Table; ///< Indexed by Capability_ID.
+
+/**
+ * The capabilities that a Node requires and provides, parsed from its
+ * @PREREQS:...@ and @PROVIDES:...@ tags.
+ */
+struct Node_Capabilities {
+    Capability_IDs prereqs;
+    Capability_IDs provides;
+
+    Node_Capabilities(const void_allocator & alloc): prereqs(alloc), provides(alloc) {}
+};
+
+typedef std::pair<const Node_ID_key, Node_Capabilities> Node_Capabilities_Map_value_type;
+typedef bi::allocator<Node_Capabilities_Map_value_type, segment_manager_t> Node_Capabilities_Map_value_type_allocator;
+typedef bi::map<Node_ID_key, Node_Capabilities, std::less<Node_ID_key>, Node_Capabilities_Map_value_type_allocator> Node_Capabilities_Map;
+
+/**
+ * Returns the comma separated items of a tag such as "@PREREQS:" in Node
+ * text. The tag ends at the next '@'.
+ */
+std::vector<std::string> capability_tag_items(const std::string & text, const std::string & tag);
+
 typedef bi::allocator<Node_ID_key, segment_manager_t> Node_ID_key_allocator;
 /**
  * A type used for named Lists (or ordered collections) of Nodes.
@@ -285,6 +539,9 @@ typedef bi::allocator<Node_ID_key, segment_manager_t> Node_ID_key_allocator;
  */
 typedef bi::deque<Node_ID_key, Node_ID_key_allocator> Node_List; // must initialize with graphmemman.get_allocator()
 typedef bi::set<Node_ID_key, std::less<Node_ID_key>, Node_ID_key_allocator> Node_Set; // must initialize with graphmemman.get_allocator()
+typedef std::pair<const Node_ID_key, uint32_t> Node_Count_Map_value_type;
+typedef bi::allocator<Node_Count_Map_value_type, segment_manager_t> Node_Count_Map_value_type_allocator;
+typedef bi::map<Node_ID_key, uint32_t, std::less<Node_ID_key>, Node_Count_Map_value_type_allocator> Node_Count_Map; // must initialize with graphmemman.get_allocator()
 //typedef bi::vector<const Node_ID_key, Node_ID_key_allocator> Node_List;
 
 /**
@@ -633,14 +890,32 @@ protected:
     #define SEM_TRAVERSED 1
     mutable int semaphore;                   /// used to detect graph traversal etc.
 
+    // Cache of target dates inherited from Superiors (see inherit_targetdate() and invalidate_inherited_targetdate()).
+    mutable time_t td_cache_inherited = RTt_maxtime;  /// earliest target date among Superiors, as returned by inherit_targetdate()
+    mutable time_t td_cache_nested = RTt_maxtime;     /// same, but only protocol-valid (>=0) values, as returned by nested_inherit_targetdate()
+    mutable Graph_Node_ptr td_cache_inherited_origin; /// origin reported with td_cache_inherited
+    mutable Graph_Node_ptr td_cache_nested_origin;    /// origin reported with td_cache_nested
+    mutable bool td_cache_valid = false;              /// only ever true for Nodes with tdproperty inherit
+    mutable bool td_visiting = false;                 /// marks Nodes on the current inheritance search path (loop detection)
+
+    time_t td_indexed = RTt_unspecified;     /// key under which the Node was last placed in the Graph target date index
+    uint32_t text_ordinal = 0;               /// number of the Node in the Graph text index (0 if not indexed)
+
     int get_semaphore() { return semaphore; }
     void set_semaphore(int sval) { semaphore = sval; }
     bool set_all_semaphores(int sval);
 
-    time_t nested_inherit_targetdate(Node_ptr & origin); // only called by the same or by inherit_targetdate()
+    bool superiors_targetdates(time_t & earliest, Node_ptr & origin, time_t & earliest_valid, Node_ptr & origin_valid, std::vector<const Node *> * path);
+    time_t nested_inherit_targetdate(Node_ptr & origin, bool & cacheable, std::vector<const Node *> * path); // only called by the same or by superiors_targetdates()
     time_t inherit_targetdate(Node_ptr * origin = nullptr);        // may be called by effective_targetdate()
+    void invalidate_dependencies_inherited_targetdate();
 
     time_t tz_adjusted_targetdate(time_t t) const; // depends on the TZADJUST flag.
+    time_t unadjusted_effective_targetdate(Node_ptr * origin = nullptr); // effective_targetdate() without tz_adjusted_targetdate()
+
+    void refresh_targetdate_index();
+
+    void assign_text(const char * utf8str);
 
 public:
     // Protected constructor to ensure Nodes are created in the correct type of memory.
@@ -658,6 +933,7 @@ public:
     const Node_ID &get_id() const { return id; }
     std::string get_id_str() const { return id.str(); }
     time_t t_created() const { return id.key().idT.get_epoch_time(); }
+    Graph * get_graph() const { return graph.get(); } // nullptr if not in a Graph
 
     time_t get_t_modified() const { return t_modified; }
     void update_t_modified(time_t t = RTt_unspecified);
@@ -733,17 +1009,17 @@ public:
 
     /// change parameters: state 
     void set_valuation(float v) { valuation = v; }
-    void set_completion(float c) { completion = c; }
-    void set_required(time_t Treq) { required = Treq; }
+    void set_completion(float c) { completion = c; refresh_targetdate_index(); }
+    void set_required(time_t Treq) { required = Treq; refresh_targetdate_index(); }
 
     /// change parameters: content
     void set_text(const std::string utf8str);
-    void set_text_unchecked(const std::string utf8str) { text = utf8str.c_str(); } /// Use only where guaranteed!
+    void set_text_unchecked(const std::string utf8str); /// Use only where guaranteed!
 
     /// change parameters: scheduling
-    void set_targetdate(time_t t) { targetdate = t; }
-    void set_tdproperty(td_property tprop) { tdproperty = tprop; }
-    void set_repeats(bool r) { repeats = r; }
+    void set_targetdate(time_t t) { targetdate = t; invalidate_inherited_targetdate(); refresh_targetdate_index(); }
+    void set_tdproperty(td_property tprop) { tdproperty = tprop; invalidate_inherited_targetdate(); refresh_targetdate_index(); }
+    void set_repeats(bool r) { repeats = r; refresh_targetdate_index(); }
     void set_tdpattern(td_pattern tpat) { tdpattern = tpat; }
     void set_tdevery(int multiplier) { tdevery = multiplier; }
     void set_tdspan(int count) { tdspan = count; }
@@ -754,6 +1030,7 @@ public:
 
     /// Graph relative operations
     time_t effective_targetdate(Node_ptr * origin = nullptr);
+    void invalidate_inherited_targetdate();
     std::string get_effective_targetdate_str() const { return TimeStampYmdHM(const_cast<Node *>(this)->effective_targetdate()); }
     time_of_day_t get_effective_targetdate_timeofday() const { return time_of_day(const_cast<Node *>(this)->effective_targetdate()); }
 
@@ -817,11 +1094,15 @@ public:
     size_t num_active_superiors() const;
     size_t num_active_dependencies() const;
 
-    Node * has_sup(const std::string & sup_idstr) const; // returns nullptr if not in sup_Edges()
-    Node * has_dep(const std::string & sup_idstr) const; // returns nullptr if not in dep_Edges()
+    Node * has_sup(const Node_ID_key & sup_key) const; // returns nullptr if not in sup_Edges()
+    Node * has_dep(const Node_ID_key & dep_key) const; // returns nullptr if not in dep_Edges()
+    Node * has_sup(const std::string & sup_idstr) const { return has_sup(Node_ID_key(sup_idstr)); }
+    Node * has_dep(const std::string & dep_idstr) const { return has_dep(Node_ID_key(dep_idstr)); }
 
-    Edge * get_Edge_by_sup(const std::string & sup_idstr) const; // returns nullptr if not in sup_Edges()
-    Edge * get_Edge_by_dep(const std::string & dep_idstr) const; // returns nullptr if not in dep_Edges()
+    Edge * get_Edge_by_sup(const Node_ID_key & sup_key) const; // returns nullptr if not in sup_Edges()
+    Edge * get_Edge_by_dep(const Node_ID_key & dep_key) const; // returns nullptr if not in dep_Edges()
+    Edge * get_Edge_by_sup(const std::string & sup_idstr) const { return get_Edge_by_sup(Node_ID_key(sup_idstr)); }
+    Edge * get_Edge_by_dep(const std::string & dep_idstr) const { return get_Edge_by_dep(Node_ID_key(dep_idstr)); }
 
     // Target date of the earliest active superior of this Node or RTt_maxtime if there is none.
     time_t earliest_active_superior();
@@ -915,11 +1196,15 @@ struct Named_Node_List {
     Node_List list; // a deque that keeps elements in order received
     Node_Set set; // an additional key set that is only used if unique
 protected:
+    Node_Count_Map counts; ///< Number of occurrences of each Node ID key, only used if not unique.
     int16_t features;
     int32_t maxsize; ///< 0 means no limit and is the default
+
+    void count_added(const Node_ID_key & nkey);
+    void count_removed(const Node_ID_key & nkey);
 public:
-    Named_Node_List(): list(graphmemman.get_allocator()), set(graphmemman.get_allocator()), features(0), maxsize(0) {} // name("", graphmemman.get_allocator()),
-    Named_Node_List(const Node_ID_key & nkey, int16_t _features = 0, int32_t _maxsize = 0): list(graphmemman.get_allocator()), set(graphmemman.get_allocator()), features(_features), maxsize(_maxsize) { add(nkey); }
+    Named_Node_List(): list(graphmemman.get_allocator()), set(graphmemman.get_allocator()), counts(graphmemman.get_allocator()), features(0), maxsize(0) {} // name("", graphmemman.get_allocator()),
+    Named_Node_List(const Node_ID_key & nkey, int16_t _features = 0, int32_t _maxsize = 0): list(graphmemman.get_allocator()), set(graphmemman.get_allocator()), counts(graphmemman.get_allocator()), features(_features), maxsize(_maxsize) { add(nkey); }
     //Named_Node_List(const Node_ID_key & nkey): list(graphmemman.get_allocator()), features(0) { list.emplace_back(nkey); }
     bool prepend() const { return (features & prepend_mask) != 0; }
     bool unique() const { return (features & unique_mask) != 0; }
@@ -929,8 +1214,9 @@ public:
     int16_t get_features() const { return features; }
     int32_t get_maxsize() const { return maxsize; }
     size_t size() const { return list.size(); }
+    /// Membership test by lookup in the key set (unique) or occurrence counts (not unique).
     bool contains(const Node_ID_key & nkey) const {
-        return (std::find(list.begin(), list.end(), nkey) != list.end());
+        return unique() ? (set.find(nkey) != set.end()) : (counts.find(nkey) != counts.end());
     }
     bool move_toward_head(unsigned int from_position);
     bool move_toward_tail(unsigned int from_position);
@@ -971,9 +1257,24 @@ protected:
     // keeping nodes protected here purely as a precaution against accidental map modification
     Node_Map nodes;
     Edge_Map edges;
+    Node_Hash_Index nodes_by_key; ///< Hash index of nodes, only used while id_index_active.
+    Edge_Hash_Index edges_by_key; ///< Hash index of edges, only used while id_index_active.
+    bool id_index_active = true;
     Topic_Tags topics;
     Named_Node_List_Map namedlists;
 
+    Targetdate_Index_Map incomplete_by_targetdate;           ///< Secondary index, only maintained while targetdate_index_active.
+    Targetdate_Index_Map incomplete_repeating_by_targetdate; ///< Subset of incomplete_by_targetdate with repeating Nodes.
+    bool targetdate_index_active = false;
+
+    Text_Index_Table text_index;       ///< Trigram posting lists, only maintained while text_index_active.
+    Text_Index_Nodes text_index_nodes; ///< Nodes by text index ordinal (ordinal 0 is unused).
+    bool text_index_active = false;
+
+    Capability_Table capabilities;           ///< Interned capabilities, only maintained while capability_index_active.
+    Node_Capabilities_Map node_capabilities; ///< Nodes with @PREREQS or @PROVIDES tags, likewise.
+    bool capability_index_active = false;
+
     bool persistent_NNL = true; ///< Default is to synchronize Named Node Lists between in-memory and database state.
 
     uint16_t port_number = 8090; ///< Default Graph server port number (the server must update this cache).
@@ -981,6 +1282,8 @@ protected:
 
     bool warn_loops = true;
 
+    pid_t td_cache_pid; ///< Only this process stores inherited target dates in Nodes (see Node::inherit_targetdate()).
+
     long t_tzadjust = 0; // (positive or negative) seconds to add for time-zone adjustment.
     bool tzadjust_active = false; // This should only be turned on and off again for specific presentations of targetdates (e.g. see fzgraphhtml).
 
@@ -989,10 +1292,28 @@ protected:
 
     void set_all_semaphores(int sval);
 
+    void update_targetdate_index(Node & node);
+
+    void update_text_index(Node & node, const char * oldtext);
+
+    bool text_index_has_room(std::size_t needed) const;
+
+    void update_capability_index(Node & node);
+
+    Capability_ID intern_capability(const std::string & name);
+
+    void update_id_index(Node & node);
+    void update_id_index(Edge & edge, bool remove = false);
+
     time_t t_modified = RTt_unspecified; // Useful for caches (see Map_of_Subtrees::node_in_heads_or_any_subtree()).
 
 public:
-    Graph(): nodes(graphmemman.get_allocator()), edges(graphmemman.get_allocator()), namedlists(graphmemman.get_allocator()), server_IP_str(graphmemman.get_allocator()) {}
+    Graph(): nodes(graphmemman.get_allocator()), edges(graphmemman.get_allocator()),
+             nodes_by_key(graphmemman.get_allocator()), edges_by_key(graphmemman.get_allocator()), namedlists(graphmemman.get_allocator()),
+             incomplete_by_targetdate(graphmemman.get_allocator()), incomplete_repeating_by_targetdate(graphmemman.get_allocator()),
+             text_index(graphmemman.get_allocator()), text_index_nodes(graphmemman.get_allocator()),
+             capabilities(graphmemman.get_allocator()), node_capabilities(graphmemman.get_allocator()),
+             server_IP_str(graphmemman.get_allocator()), td_cache_pid(getpid()) {}
 
     std::string get_error() const;
 
@@ -1037,6 +1358,11 @@ public:
     Edge * Edge_by_id(const Edge_ID_key & id) const; // inlined below
     Edge * Edge_by_idstr(std::string idstr) const; // inlined below
 
+    /// secondary index: hash index of nodes and edges by key
+    bool build_id_index();
+    void reset_id_index();
+    bool id_index_is_active() const { return id_index_active; }
+
     /// topics table: get topic
     Topic * find_Topic_by_id(Topic_ID _id) const { return topics.find_by_id(_id); }
     Topic * find_Topic_by_tag(const std::string _tag) const { return topics.find_by_tag(_tag); }
@@ -1058,6 +1384,35 @@ public:
     size_t copy_List_to_List(const std::string from_name, const std::string to_name, size_t from_max = 0, size_t to_max = 0, int16_t _features = -1, int32_t _maxsize = -1);
     ssize_t edit_all_in_List(const std::string _name, const Edit_flags & editflags, const Node_data & nodedata);
 
+    /// cache of inherited target dates in Nodes, populated only by the process that owns the Graph
+    void own_targetdate_cache() { td_cache_pid = getpid(); }
+    bool owns_targetdate_cache() const { return td_cache_pid == getpid(); }
+
+    /// secondary index: incomplete Nodes by effective target date (see Graphinfo.hpp for range access)
+    void build_targetdate_index();
+    void reset_targetdate_index();
+    bool targetdate_index_is_active() const { return targetdate_index_active; }
+    void refresh_targetdate_index(Node & node);
+    const Targetdate_Index_Map & get_incomplete_by_targetdate() const { return incomplete_by_targetdate; }
+    const Targetdate_Index_Map & get_incomplete_repeating_by_targetdate() const { return incomplete_repeating_by_targetdate; }
+
+    /// secondary index: trigrams of Node text (see Graphinfo.hpp:Nodes_subset())
+    bool build_text_index();
+    void reset_text_index();
+    bool text_index_is_active() const { return text_index_active; }
+    void refresh_text_index(Node & node, const char * oldtext) { if (text_index_active) update_text_index(node, oldtext); }
+    bool text_index_candidates(const std::string & term, std::vector<uint32_t> & ordinals) const;
+    Node * text_index_Node(uint32_t ordinal) const { return (ordinal < text_index_nodes.size()) ? text_index_nodes[ordinal].get() : nullptr; }
+
+    /// secondary index: capabilities in @PREREQS and @PROVIDES tags (see Graphinfo.hpp:get_prerequisites())
+    bool build_capability_index();
+    void reset_capability_index();
+    bool capability_index_is_active() const { return capability_index_active; }
+    void refresh_capability_index(Node & node) { if (capability_index_active) update_capability_index(node); }
+    const Node_Capabilities * find_Node_capabilities(const Node_ID_key & nkey) const;
+    const Capability & get_capability(Capability_ID id) const { return capabilities[id]; }
+    const Capability * find_capability(const std::string & name) const;
+
     /// crossref tables: topics x nodes
     /**
      * Find a pointer to the main Topic of a Node as indicated by the maximum
@@ -1146,6 +1501,9 @@ inline time_t Node::seconds_to_complete() const {
  * @return pointer to Node (or nullptr if not found).
  */
 inline Node * Graph::Node_by_id(const Node_ID_key & id) const {
+    if (id_index_active) {
+        return nodes_by_key.find(id.idT.packed());
+    }
     auto it = nodes.find(id);
     if (it==nodes.end()) return nullptr;
     return it->second.get();
@@ -1176,6 +1534,9 @@ inline Node * Graph::Node_by_idstr(std::string idstr) const {
  * @return pointer to Node (or nullptr if not found).
  */
 inline Edge * Graph::Edge_by_id(const Edge_ID_key & id) const {
+    if (id_index_active) {
+        return edges_by_key.find(Packed_Edge_key(id));
+    }
     auto it = edges.find(id);
     if (it==edges.end()) return nullptr;
     return it->second.get();
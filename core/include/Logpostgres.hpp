@@ -79,6 +79,8 @@ bool create_Logchunks_table_pq(const active_pq & apq);
 
 bool create_Logentries_table_pq(const active_pq & apq);
 
+bool create_Logentries_text_index_pq(const active_pq & apq);
+
 bool add_Breakpoint_pq(const active_pq & apq, const Log_chunk_ID_key & bptopid);
 
 bool add_Logchunk_pq(const active_pq & apq, const Log_chunk & chunk);
@@ -199,6 +201,36 @@ bool load_last_chunk_and_entry_pq(Log & log, Postgres_access & pa);
  */
 bool store_Node_history_pq(const Node_histories & nodehist, Postgres_access & pa);
 
+/// True if the histories cache table exists (checked once per connection).
+bool Node_history_cache_exists_pq(const active_pq & apq);
+
+/// Add an appended or inserted Log chunk to the histories cache row of its Node.
+bool append_Node_history_chunk_pq(const active_pq & apq, const Log_chunk & chunk);
+
+/// Add an appended or inserted Log entry to the histories cache row of its Node.
+bool append_Node_history_entry_pq(const active_pq & apq, const Log_entry & entry);
+
+/// Remove a Log entry from the histories cache.
+bool remove_Node_history_entry_pq(const active_pq & apq, const Log_entry & entry);
+
+/**
+ * Rebuild the histories cache rows of the Nodes returned by a Postgres query
+ * from the Log tables.
+ * 
+ * @param apq Access object with active database connection and schema name.
+ * @param nidsquery A Postgres query that returns the Node IDs.
+ * @return True if the histories cache was updated.
+ */
+bool rebuild_Node_histories_pq(const active_pq & apq, const std::string & nidsquery);
+
+/**
+ * Sort and deduplicate incrementally updated histories cache rows.
+ * 
+ * @param pa Access object with valid database and schema identifiers.
+ * @return True if the compaction was successful.
+ */
+bool compact_Node_history_cache_pq(Postgres_access & pa);
+
 /**
  * Refresh the Node history cache table.
  * 
@@ -237,6 +269,47 @@ bool load_Node_history_cache_table_pq(Postgres_access & pa, Node_histories & nod
  */
 bool load_Node_chunk_data_pq(Postgres_access& pa, const Node_ID_key& nkey, Log & nodelog);
 
+/**
+ * Rebuild the inverted index of Log entry text.
+ * 
+ * @param pa Access object with valid database and schema identifiers.
+ * @return True if the index was rebuilt.
+ */
+bool refresh_Log_text_index_pq(Postgres_access & pa);
+
+/**
+ * Find the Log entries that contain search terms, using the inverted index
+ * of Log entry text.
+ * 
+ * @param[in] pa Access object with valid database and schema identifiers.
+ * @param[in] search A Log search specification with at least one term.
+ * @param[out] entries Receives the IDs of matching Log entries.
+ * @return True if the search was carried out.
+ */
+bool search_Log_entries_pq(Postgres_access & pa, const Log_search & search, Log_entry_ID_key_set & entries);
+
+/**
+ * Load specific Log chunks with all of their entries.
+ * 
+ * @param log A Log for the Chunks and Entries, can be empty or may be added to.
+ * @param pa Access object with valid database and schema identifiers.
+ * @param chunks The IDs of the Log chunks to load.
+ * @return True if the Log chunks were successfully loaded.
+ */
+bool load_Log_chunks_pq(Log & log, Postgres_access & pa, const Log_chunk_ID_key_set & chunks);
+
+/**
+ * Calculate the total time logged for each of a set of Nodes, optionally
+ * up to a specified time.
+ * 
+ * @param pa Access object with valid database and schema identifiers.
+ * @param nodes The set of Nodes.
+ * @param t_to Only include Log chunks up to this time (if not RTt_unspecified).
+ * @param[out] minutes Receives the total logged minutes for each Node.
+ * @return True if the totals were successfully calculated.
+ */
+bool load_Nodes_logged_minutes_pq(Postgres_access & pa, const base_Node_Set & nodes, time_t t_to, Node_minutes_map & minutes);
+
 /**
  * A data types conversion helper class that can deliver the Postgres Breakpoints table
  * equivalent INSERT value expression for all data content in a Breakpoints.
@@ -408,6 +408,8 @@ public:
 
     unsigned long prune_duplicate_chunks(); /// Remove any duplicate Log chunks.
     bool add_entries_to_chunks(); /// Connect entries to chunks if that was not done during Log_entry construction. (2-pass method.)
+    void remove_Chunk(const Log_chunk_ID_key & chunk_key); /// Remove a Log chunk and its entries. Call setup_Chain_nodeprevnext() afterwards.
+    void append_Log(Log & newer); /// Move the chunks and entries of a Log that begins after this one into this Log.
 
     /// tables: sizes
     Log_entries_Map::size_type num_Entries() const { return entries.size(); }
@@ -520,6 +522,20 @@ struct Log_filter {
     void get_n_to_end(unsigned int n) { limit = n; back_to_front = true; }
 
     std::string info_str() const;
+    std::string GET_args() const;
+};
+
+/**
+ * Specifies a search for Log entries in the Log entry text index (see
+ * search_Log_entries_pq()). Terms are case-folded words. A term with
+ * several words matches only where those words appear in sequence.
+ */
+struct Log_search {
+    std::vector<std::string> terms; ///< Words or sequences of words to search for.
+    bool all_terms = true;          ///< If false then entries that contain any one of the terms match.
+    time_t t_from = RTt_unspecified; ///< Entries must belong to chunks with IDs >= `t_from`, RTt_unspecified means no lower bound.
+    time_t t_to = RTt_unspecified;   ///< Entries must belong to chunks with IDs <= `t_to`, RTt_unspecified means no upper bound.
+    unsigned long limit = 0;        ///< Limit to the most recent matching entries, 0 means unlimited.
 };
 
 /**
@@ -580,6 +596,9 @@ public:
     Node_histories() {}
     Node_histories(Log & log, bool explicit_only = false) { init(log, explicit_only); }
     void init(Log & log, bool explicit_only = false);
+    void add_chunk(const Log_chunk & chunk);
+    void add_entry(Log_entry & entry, bool explicit_only = false);
+    void remove_chunk(Log_chunk & chunk);
     void add_surrounding_chunks();
     //void remove_implicit_entries(Log & log);
     Node_history * history(const Node_ID_key & nkey);
@@ -590,6 +609,29 @@ public:
     Log_chain_target newest(const Node & node) { return newest(node.get_id().key()); }
 };
 
+/**
+ * Select the Log chunks of a memory-resident Log that satisfy a filter,
+ * following the same rules as `load_partial_Log_pq()`.
+ */
+Log_chunk_ID_key_set Log_excerpt_chunks(Log & log, Node_histories & histories, const Log_filter & filter);
+
+/**
+ * Serialize Log chunks (and their entries) of a Log for transfer from a
+ * memory-resident Log server. See `deserialize_Log_excerpt()`.
+ */
+std::string serialize_Log_excerpt(Log & log, const Log_chunk_ID_key_set & chunks, bool chunks_only = false);
+
+/// Add the Log chunks and entries in a serialized Log excerpt to a Log.
+bool deserialize_Log_excerpt(const std::string & serstr, Log & log);
+
+typedef std::map<Node_ID_key, unsigned long, std::less<Node_ID_key>> Node_minutes_map;
+
+/**
+ * Sum the time logged in the histories of a set of Nodes, as
+ * `Chunks_total_minutes()` would for each Node's Log excerpt.
+ */
+void Nodes_logged_minutes(Log & log, Node_histories & histories, const base_Node_Set & nodes, time_t t_to, Node_minutes_map & minutes);
+
 // +----- begin: inline functions -----+
 
 /// Set rapid-access node pointer. (See detailed description for Log_chunk below.)
@@ -87,18 +87,28 @@ struct Log_TimeStamp {
     uint8_t month;
     int16_t year;
 
-    Log_TimeStamp(): minor_id(0), minute(0), hour(0), day(0), month(0), year(0) {} ///< Default initializes as LOG_NULL_IDSTAMP.
+    constexpr Log_TimeStamp(): minor_id(0), minute(0), hour(0), day(0), month(0), year(0) {} ///< Default initializes as LOG_NULL_IDSTAMP.
     Log_TimeStamp(std::time_t t, bool testvalid = false, uint8_t _minorid = 0);
 
     /// standardization functions and operators
     bool isnullstamp() const { return (month == 0) || (year<1900); }
-    bool operator< (const Log_TimeStamp& rhs) const {
-        return std::tie(year,month,day,hour,minute,minor_id)
-             < std::tie(rhs.year,rhs.month,rhs.day,rhs.hour,rhs.minute,rhs.minor_id);
+    bool operator< (const Log_TimeStamp& rhs) const { return packed() < rhs.packed(); }
+    bool operator== (const Log_TimeStamp& rhs) const { return packed() == rhs.packed(); }
+
+    /// All components packed into one 64-bit integer that orders the same way (see ID_TimeStamp::packed()).
+    constexpr uint64_t packed() const {
+        return (uint64_t(uint16_t(year)) << 40) | (uint64_t(month) << 32) | (uint64_t(day) << 24)
+             | (uint64_t(hour) << 16) | (uint64_t(minute) << 8) | uint64_t(minor_id);
     }
-    bool operator== (const Log_TimeStamp& rhs) const {
-        return std::tie(year,month,day,hour,minute,minor_id)
-             == std::tie(rhs.year,rhs.month,rhs.day,rhs.hour,rhs.minute,rhs.minor_id);
+    static constexpr Log_TimeStamp from_packed(uint64_t p) {
+        Log_TimeStamp idT;
+        idT.year = int16_t(p >> 40);
+        idT.month = (p >> 32) & 0xff;
+        idT.day = (p >> 24) & 0xff;
+        idT.hour = (p >> 16) & 0xff;
+        idT.minute = (p >> 8) & 0xff;
+        idT.minor_id = p & 0xff;
+        return idT;
     }
     std::tm get_local_time() const;
     time_t get_epoch_time() const;
@@ -113,8 +123,8 @@ struct Log_TimeStamp {
  * 
  * In various containers, the ordering of Log entry ID keys is determined
  * by the provided operator<(). It calls its equivalent in Log_TimeStamp,
- * where std::tie() enables lexicographical comparison, from the largest
- * temporal component to the smallest.
+ * which compares packed 64-bit values that order lexicographically, from
+ * the largest temporal component to the smallest.
  * 
  * The default constructor is provided for various special use cases such
  * as initialization of containers. The `isnullkey()` function can test
@@ -149,8 +159,8 @@ struct Log_entry_ID_key {
  * 
  * In various containers, the ordering of Log chunk ID keys is determined
  * by the provided operator<(). It calls its equivalent in Log_TimeStamp,
- * where std::tie() enables lexicographical comparison, from the largest
- * temporal component to the smallest.
+ * which compares packed 64-bit values that order lexicographically, from
+ * the largest temporal component to the smallest.
  * 
  * The default constructor is provided for various special use cases such
  * as initialization of containers. The `isnullkey()` function can test
@@ -51,6 +51,24 @@ extern const std::string weekday_str[day_of_week::_num_dow];
  */
 const std::tm * safe_localtime(const std::time_t * t_ptr, int * errorcode_ptr = nullptr);
 
+/**
+ * Convert local calendar date and time into UNIX epoch time.
+ * 
+ * The result is the same as that of mktime() with `tm_isdst = -1`, but
+ * the epoch time at the start of each hour is cached, so that converting
+ * many time stamps (e.g. Node and Log IDs) rarely needs libc time zone
+ * calculations.
+ * 
+ * @param year The year (not relative to 1900).
+ * @param month The month, counting from 1.
+ * @param day The day of the month, counting from 1.
+ * @param hour The hour.
+ * @param minute The minute.
+ * @param second The second.
+ * @return Local Unix time in seconds.
+ */
+std::time_t local_epoch_time(int year, int month, int day, int hour, int minute, int second = 0);
+
 /**
  * Convert a Formalizer time stamp string into local Unix time.
  * 
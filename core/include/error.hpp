@@ -17,6 +17,7 @@
 #include <string>
 #include <deque>
 #include <vector>
+#include <mutex>
 
 // core
 #include "config.hpp"
@@ -25,7 +26,11 @@
 
 /**
  * You can specify NO_ERR_TRACE if you are confident that you don't need that and want to save a few cycles.
- * You can also specify NO_ERR_HINTS if you just want no string copying in the way of maximum performance.
+ * You can also specify NO_ERR_HINTS if you just want no hint updates at all.
+ * 
+ * Trace labels and milestones should be string literals (such as __func__),
+ * which are recorded without copying. Milestones composed at run-time are
+ * copied (and possibly truncated) into a fixed-size record.
  */
 #ifdef NO_ERR_TRACE
     #ifdef NO_ERR_HINTS
@@ -35,29 +40,29 @@
         #define ERRHERE(idx) { }
     #else
         /// Treat this just like ERRHINT.
-        #define ERRENTER(f) errhint = f
+        #define ERRENTER(f) fz::errhint.set(f)
 
         /// Treat this just like ERRHERE.
         #define ERRTRACE ERRHINT(__func__)
 
         /// Specify this at any point for more fine-grained ADDERROR/ADDWARNING info.
-        #define ERRHINT(h) errhint = h
+        #define ERRHINT(h) fz::errhint.set(h)
 
         /// A version of ERRHINT that automatically includes the function name.
-        #define ERRHERE(idx) ERRHINT(std::string(__func__)+idx)
+        #define ERRHERE(idx) fz::errhint.set(__func__, idx)
     #endif
 #else
     /// Put this at the top of any function you wish to include in the trace.
-    #define ERRENTER(f) Trace_This tracethis(f)
+    #define ERRENTER(f) fz::Trace_This tracethis(f)
 
     /// Simplified version that always puts __func__ on the trace.
-    #define ERRTRACE Trace_This tracethis(__func__)
+    #define ERRTRACE fz::Trace_This tracethis(__func__)
 
     /// Specify this at milestones within a fucntion for fine-grained ADDERROR/ADDWARNING info.
-    #define ERRHINT(f_milestone) errtracer.update_milestone(f_milestone)
+    #define ERRHINT(f_milestone) fz::errtracer.update_milestone(f_milestone)
 
     /// A version of ERRHINT that automatically includes the function name.
-    #define ERRHERE(f_milestone) errtracer.update_milestone(std::string(__func__)+f_milestone)
+    #define ERRHERE(f_milestone) fz::errtracer.update_milestone(__func__, f_milestone)
 #endif
 
 
@@ -124,52 +129,130 @@ enum exit_status_code {
 
 extern bool mute_error;
 
+/**
+ * One level of the error trace: A label (typically the function name) and
+ * an optional milestone within it. Both are recorded as pointers to string
+ * literals, so that tracing does not allocate memory. A milestone composed
+ * at run-time is copied into the record instead.
+ */
+struct Trace_Record {
+    const char * label = "";
+    const char * milestone = "";
+    char milestone_buf[40];
+
+    Trace_Record() {}
+    Trace_Record(const char * _label): label(_label) {}
+    Trace_Record(const Trace_Record & record) { *this = record; }
+    Trace_Record & operator=(const Trace_Record & record);
+
+    void set(const char * _label, const char * _milestone = "") {
+        label = _label;
+        milestone = _milestone;
+    }
+    void set(const char * _label, const std::string & _milestone);
+    void set(const std::string & _milestone) { set("", _milestone); }
+
+    void append_to(std::string & s) const {
+        s += label;
+        s += milestone;
+    }
+};
+
+/// A copy of the trace levels at the moment an error was registered.
+typedef std::vector<Trace_Record> Trace_Snapshot;
+
 #ifdef NO_ERR_TRACE
     /// Global variable that can be updated to give a better hint about where exactly an error occurred.
-    extern std::string errhint;
+    /// Each thread has its own.
+    extern thread_local Trace_Record errhint;
 #endif
 
+/**
+ * Errors are recorded with the trace (or hint) or the time at which they occurred.
+ * Both are only formatted into text when errors are printed.
+ */
 struct Error_Instance {
-    std::string tracehint;
+    Trace_Snapshot trace;
+    time_t t = 0;            ///< Time of the error, if recorded instead of a trace.
+    bool timestamped = false;
     std::string func;
     std::string err;
     Error_Instance() {}
-    Error_Instance(const std::string h, const std::string f, const std::string e): tracehint(h), func(f), err(e) {}
+    Error_Instance(Trace_Snapshot && _trace, std::string && f, std::string && e): trace(std::move(_trace)), func(std::move(f)), err(std::move(e)) {}
+    Error_Instance(time_t _t, std::string && f, std::string && e): t(_t), timestamped(true), func(std::move(f)), err(std::move(e)) {}
+
+    std::string tracehint() const;
 };
 
 #ifndef NO_ERR_TRACE
 
-/// Defining this type for easy swap-in/out of vector, deque, or other container types.
-typedef std::vector<std::string> StackTrace;
-
 /**
  * This structure is used to collaboratively maintain a stack trace for use in both
  * logged errors and exception handling.
  * 
  * Functions that wish to expose their place on the stack for easy tracing should
- * use the defined ERRSTACK_ macros to collaboratively manage this stack.
+ * use the defined ERRTRACE and ERRHERE macros to collaboratively manage this stack.
+ * Levels are kept in a fixed-size array, so that entering and leaving a traced
+ * function costs a few assignments. Levels beyond `max_levels` are counted but
+ * not recorded.
  * 
  * For more backtground information, read the card at https://trello.com/c/lNwxlrbT.
  */
-struct Stack_Tracer: public StackTrace {
+struct Stack_Tracer {
+    constexpr static size_t max_levels = 64;
+
+protected:
+    Trace_Record levels[max_levels];
+    size_t depth = 0;
 
+public:
     /// The number of levels presently in the trace.
-    StackTrace::size_type num_levels() const { return size(); }
+    size_t num_levels() const { return depth; }
+
+    /// Add a level to the trace and return the level at which it was added.
+    size_t enter(const char * label) {
+        if (depth < max_levels) {
+            levels[depth].set(label);
+        }
+        return depth++;
+    }
+    size_t enter(const std::string & label) {
+        if (depth < max_levels) {
+            levels[depth].set(label);
+        }
+        return depth++;
+    }
+
+    /// Return the trace to the level it had before enter() returned `level`.
+    void leave(size_t level) { depth = level; }
 
     /// Replace the current deepest level descriptor to identify a new milestone within the function.
-    void update_milestone(const std::string milestone) { if (!empty()) back() = milestone; }
+    template <typename Milestone>
+    void update_milestone(const Milestone & milestone) {
+        if ((depth > 0) && (depth <= max_levels)) {
+            levels[depth-1].set(milestone);
+        }
+    }
+    template <typename Milestone>
+    void update_milestone(const char * label, const Milestone & milestone) {
+        if ((depth > 0) && (depth <= max_levels)) {
+            levels[depth-1].set(label, milestone);
+        }
+    }
+
+    Trace_Snapshot snapshot() const;
 
     /// Return a string that combines the full current state of the stack trace.
-    std::string print();
+    std::string print() const;
 
 };
 
-/// The global stack tracer variable.
-extern Stack_Tracer errtracer;
+/// The global stack tracer variable. Each thread traces its own stack.
+extern thread_local Stack_Tracer errtracer;
 
 class Trace_This {
 protected:
-    StackTrace::size_type tracelevel;
+    size_t tracelevel;
 
 public:
     /**
@@ -178,16 +261,15 @@ public:
      * 
      * @param extend Label to add for the extension of the trace.
      */
-    Trace_This(const std::string extend): tracelevel(errtracer.num_levels()) {
-        errtracer.push_back(extend);
-    }
+    Trace_This(const char * extend): tracelevel(errtracer.enter(extend)) {}
+    Trace_This(const std::string & extend): tracelevel(errtracer.enter(extend)) {}
 
     /**
      * Upon exiting the function, this local variable destructor is called.
      * The stack trace is returned to its level at entry.
      */
     ~Trace_This() {
-        errtracer.resize(tracelevel,"trace_error"); ///< A "trace_error" is shown for any levels that had been removed too early.
+        errtracer.leave(tracelevel);
     }
 };
 
@@ -207,10 +289,13 @@ public:
  * 
  * This allows you to store and later process a sequence of non-fatal errors in
  * whatever way you wish.
+ * 
+ * Errors can be pushed from multiple threads.
  */
 class Errors {
     friend err_configbase;
 protected:
+    std::recursive_mutex errq_mutex;
     std::deque<Error_Instance> errq;
     std::string errfilepath;
     int numflushed;
@@ -16,6 +16,11 @@
 // std
 //#include <cctype>
 #include <vector>
+#include <functional>
+#include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
 
 // core
 //#include "error.hpp"
@@ -40,16 +45,33 @@
     #define DEFAULT_PQ_SCHEMANAME "formalizeruser"
 #endif
 
+/// The application_name with which fzserverpq connects (see install_Graph_change_stamp_pq()).
+#define PQ_SERVER_APPLICATION_NAME "fzserverpq"
+
 namespace fz {
 
 //extern std::string pq_schemaname; // *** This is now being supplied through standard.hpp:Graph_access::pq_schemaname
 
+extern std::string pq_application_name; ///< If not empty, new connections identify themselves by this name.
+
+extern std::atomic<unsigned long> pq_failed_changes; ///< Database change calls that failed.
+
 PGconn* connection_setup_pq(std::string dbname);
 
+void connection_release_pq(PGconn* conn);
+
+bool prepare_cached_pq(PGconn* conn, const std::string & stmtname, const std::string & sql, int nparams);
+
+bool table_exists_pq(PGconn* conn, const std::string & tablename);
+
 bool simple_call_pq(PGconn* conn, std::string astr);
 
 bool query_call_pq(PGconn* conn, std::string qstr, bool request_single_row_mode);
 
+bool prepared_call_pq(PGconn* conn, const std::string & stmtname, const std::string & sql, const std::vector<std::string> & params);
+
+bool prepared_query_call_pq(PGconn* conn, const std::string & stmtname, const std::string & sql, const std::vector<std::string> & params, bool request_single_row_mode);
+
 int sample_query_data(PGconn *conn, unsigned int rstart, unsigned int rend, unsigned int cstart, unsigned int cend, std::string &databufstr);
 
 bool create_Formalizer_schema_pq(PGconn* conn, std::string schemaname);
@@ -62,12 +84,62 @@ inline std::string TimeStamp_pq(time_t t) {
     return TimeStamp("'%Y%m%d %H:%M'",t);
 }
 
+/// Uses the same convention as TimeStamp_pq() without apostrophes, for prepared statement parameters.
+inline std::string TimeStamp_pqparam(time_t t) {
+    if (t<0) return "infinity";
+    return TimeStamp("%Y%m%d %H:%M",t);
+}
+
 inline std::string TimeStamp_to_TimeStamp_pq(const std::string & tstamp) {
     return '\'' + tstamp.substr(0,8) + ' ' + tstamp.substr(8,2) + ':' + tstamp.substr(10,2) + '\'';
 }
 
 time_t epochtime_from_timestamp_pq(std::string pqtimestamp);
 
+time_t epochtime_from_timestamp_pq(const char * pqtimestamp);
+
+void append_copy_text_pq(std::string & dest, const char * text);
+
+int copy_fields_pq(char * row, int len, char ** fields, int max_fields);
+
+bool copy_to_stdout_pq(PGconn* conn, std::string copycmd, const std::function<bool(char*, int)> & row_func);
+
+/**
+ * Stream rows into a table with `COPY ... FROM STDIN` in text format.
+ * 
+ * Rows are collected in a buffer that is sent in large blocks, so that
+ * a bulk store takes a handful of round-trips instead of one per row.
+ * Build rows with append_copy_text_pq() and tab separators, then hand
+ * them to put_row(). Call finish() to complete the COPY and obtain
+ * its result. Call abort() to end an unfinished COPY before the
+ * connection is released. A Copy_in_pq that is destroyed before
+ * finish() also aborts the COPY, but only while its connection is
+ * still valid.
+ * 
+ * Note: When Postgres changes are simulated the COPY command and its
+ * rows are only written to the simulation log.
+ */
+class Copy_in_pq {
+protected:
+    PGconn* conn;
+    std::string buffer;
+    bool active = false;
+    bool simulated = false;
+
+    bool flush();
+
+public:
+    static constexpr size_t flush_bytes = 1024*1024;
+
+    Copy_in_pq(PGconn* _conn, std::string copycmd);
+    ~Copy_in_pq();
+
+    bool ok() const { return active || simulated; }
+    bool put_row(const std::string & row);
+    bool finish();
+    void abort();
+};
+
 enum PQ_Command_Variant {
     pq_command_runsilent, ///< this is the default
     pq_command_log,       ///< run and write to log file
@@ -112,6 +184,81 @@ public:
 
 extern Simulate_PQ_Changes SimPQ;
 
+/**
+ * A pool of open database connections for long-running programs.
+ * 
+ * While the pool is disabled (the default), connection_setup_pq() opens a
+ * new connection and connection_release_pq() closes it again, which is the
+ * right behavior for short-lived command line tools. A server, such as
+ * fzserverpq, calls enable() once, after which released connections are
+ * kept open and handed out again by connection_setup_pq(), so that each
+ * request no longer pays for a TCP and authentication handshake.
+ * 
+ * A pooled connection is only put back if it is healthy and idle (not
+ * inside a transaction or a COPY). Before reuse, a connection is checked
+ * for being closed by the server, and one that has been idle for more
+ * than `ping_after_idle` seconds is also pinged.
+ * 
+ * The pool also tracks which statements have been prepared on each
+ * connection (see prepare_cached_pq()). Statements are only prepared on
+ * pooled connections (see prepared_call_pq()). Likewise, it tracks which
+ * tables were found to exist (see table_exists_pq()).
+ * 
+ * The pool is thread-safe.
+ */
+class pq_connection_pool {
+public:
+    static constexpr time_t ping_after_idle = 60; ///< Seconds.
+
+    ~pq_connection_pool();
+
+    void enable(unsigned int _max_idle = 4);
+
+    void disable();
+
+    bool enabled() const { return max_idle > 0; }
+
+    PGconn * acquire(const std::string & dbname);
+
+    void release(PGconn * conn);
+
+    bool is_pooled(PGconn * conn);
+
+    bool is_prepared(PGconn * conn, const std::string & stmtname);
+
+    void set_prepared(PGconn * conn, const std::string & stmtname);
+
+    bool is_known_table(PGconn * conn, const std::string & tablename);
+
+    void set_known_table(PGconn * conn, const std::string & tablename);
+
+    unsigned long num_opened() const { return opened; }
+    unsigned long num_reused() const { return reused; }
+    unsigned long num_discarded() const { return discarded; }
+
+protected:
+    struct idle_conn {
+        PGconn * conn;
+        time_t t_idle;
+    };
+
+    std::mutex pool_mutex;
+    unsigned int max_idle = 0;
+    std::map<PGconn*, std::string> pooled;                ///< Connections opened for the pool and their databases.
+    std::multimap<std::string, idle_conn> idle;           ///< Connections available for reuse, by database.
+    std::map<PGconn*, std::set<std::string>> prepared;    ///< Statements prepared on each open connection.
+    std::map<PGconn*, std::set<std::string>> tables;      ///< Tables found to exist on each open connection.
+    unsigned long opened = 0;
+    unsigned long reused = 0;
+    unsigned long discarded = 0;
+
+    void forget(PGconn * conn);
+
+    void close(PGconn * conn);
+};
+
+extern pq_connection_pool pq_pool;
+
 /**
  * Communication info for active database connection and specified schema.
  */
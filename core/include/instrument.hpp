@@ -0,0 +1,160 @@
+// Copyright 2020 Randal A. Koene
+// License TBD
+
+/**
+ * This header file declares counters, histograms and scoped timers for
+ * lightweight instrumentation of hot code paths.
+ *
+ * The corresponding source file is at core/lib/instrument.cpp.
+ *
+ * Recording a value is lock-free: each thread adds to its own cache-line
+ * aligned bucket with a relaxed atomic add, and the buckets are only summed
+ * when a report is generated (see metrics_prometheus() and metrics_json()).
+ * Metrics are intended to be objects with static storage duration. They
+ * register themselves on construction and are reported in that order.
+ *
+ * Versioning is based on https://semver.org/ and the C++ headers define __INSTRUMENT_HPP.
+ */
+
+#ifndef __INSTRUMENT_HPP
+#include "coreversion.hpp"
+#define __INSTRUMENT_HPP (__COREVERSION_HPP)
+
+// std
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace fz {
+
+constexpr unsigned int instrument_thread_slots = 64; ///< Threads beyond this share slots (still correct, only slower).
+
+constexpr unsigned int instrument_num_bounds = 19;   ///< Histogram bucket upper bounds, +Inf is added.
+
+/// Histogram bucket upper bounds in microseconds (10 us to 10 s).
+constexpr uint64_t instrument_bounds_us[instrument_num_bounds] = {
+    10, 25, 50, 100, 250, 500,
+    1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000, 5000000,
+    10000000
+};
+
+/**
+ * Returns the per-thread slot index of the calling thread.
+ */
+unsigned int instrument_thread_slot();
+
+enum instrument_metric_type {
+    instrument_counter,
+    instrument_histogram
+};
+
+/**
+ * Base class of registered metrics.
+ *
+ * A metric is identified by its name and an optional Prometheus label
+ * set, such as `path="nodes"`. Metrics with the same name should be
+ * constructed consecutively so that they are reported as one family.
+ */
+class Instrument_Metric {
+protected:
+    const char * name;
+    const char * help;
+    const char * labels;
+    instrument_metric_type type;
+
+public:
+    Instrument_Metric(instrument_metric_type _type, const char * _name, const char * _help, const char * _labels);
+    virtual ~Instrument_Metric();
+
+    Instrument_Metric(const Instrument_Metric &) = delete;
+    Instrument_Metric & operator=(const Instrument_Metric &) = delete;
+
+    const char * get_name() const { return name; }
+    const char * get_help() const { return help; }
+    const char * get_labels() const { return labels; }
+    instrument_metric_type get_type() const { return type; }
+
+    virtual void prometheus(std::string & out) const = 0;
+    virtual void json(std::string & out) const = 0;
+};
+
+/**
+ * A monotonically increasing count.
+ */
+class Instrument_Counter: public Instrument_Metric {
+protected:
+    struct alignas(64) slot {
+        std::atomic<uint64_t> n{0};
+    };
+    slot slots[instrument_thread_slots];
+
+public:
+    Instrument_Counter(const char * _name, const char * _help, const char * _labels = nullptr): Instrument_Metric(instrument_counter, _name, _help, _labels) {}
+
+    void add(uint64_t n = 1) { slots[instrument_thread_slot()].n.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const;
+
+    virtual void prometheus(std::string & out) const;
+    virtual void json(std::string & out) const;
+};
+
+/**
+ * A distribution of durations, with buckets at instrument_bounds_us.
+ */
+class Instrument_Histogram: public Instrument_Metric {
+protected:
+    struct alignas(64) slot {
+        std::atomic<uint64_t> buckets[instrument_num_bounds+1] = {}; ///< Not cumulative, the last one is +Inf.
+        std::atomic<uint64_t> sum_us{0};
+    };
+    slot slots[instrument_thread_slots];
+
+public:
+    Instrument_Histogram(const char * _name, const char * _help, const char * _labels = nullptr): Instrument_Metric(instrument_histogram, _name, _help, _labels) {}
+
+    void observe_us(uint64_t us);
+
+    /// Sums the slots, with cumulative bucket counts as used in reports.
+    void totals(uint64_t (&cumulative)[instrument_num_bounds+1], uint64_t & sum_us) const;
+
+    virtual void prometheus(std::string & out) const;
+    virtual void json(std::string & out) const;
+};
+
+/**
+ * Records the time from construction to destruction in a histogram.
+ *
+ * For example:
+ *   static Instrument_Histogram load_seconds("fz_load_seconds", "Time spent loading.");
+ *   ...
+ *   Scoped_Timer timer(load_seconds);
+ */
+class Scoped_Timer {
+protected:
+    Instrument_Histogram & histogram;
+    std::chrono::steady_clock::time_point t_start;
+
+public:
+    Scoped_Timer(Instrument_Histogram & _histogram): histogram(_histogram), t_start(std::chrono::steady_clock::now()) {}
+    ~Scoped_Timer() { histogram.observe_us(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t_start).count()); }
+
+    Scoped_Timer(const Scoped_Timer &) = delete;
+    Scoped_Timer & operator=(const Scoped_Timer &) = delete;
+};
+
+/**
+ * Report all registered metrics in the Prometheus text exposition format.
+ */
+std::string metrics_prometheus();
+
+/**
+ * Report all registered metrics as a JSON object with a "metrics" array.
+ */
+std::string metrics_json();
+
+} // namespace fz
+
+#endif // __INSTRUMENT_HPP
@@ -51,12 +51,19 @@ bool client_socket_shmem_request(std::string request_str, std::string server_ip_
  *       memory, which is (outside of shared-memory clusters) only
  *       possible on the same machine.
  * 
+ * If the request was prepared in a slot of the server's request ring
+ * (see allocate_Graph_modifications_in_shared_memory()) then it is
+ * submitted through the ring instead of over TCP.
+ * 
  * @param segname The unique shared memory segment label.
  * @param port_number The port number at which the server is expected to be listening.
  * @return The request outcome, expressed in exit codes (exit_ok, exit_general_error, etc).
  */
 exit_status_code server_request_with_shared_data(std::string segname, uint16_t port_number);
 
+/// Report the outcome of a Graph modification request with shared memory, given the server response.
+exit_status_code server_response_with_shared_data(const std::string & segname, const std::string & response_str);
+
 std::string strip_HTTP_header(const std::string& response_str);
 
 class http_GET_long {
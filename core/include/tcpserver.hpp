@@ -13,6 +13,7 @@
 
 // std
 //#include <ctime>
+#include <atomic>
 
 // core
 #include "error.hpp"
@@ -20,7 +21,7 @@
 namespace fz {
 
 struct shared_memory_server {
-    bool listen;
+    std::atomic<bool> listen; // Request handling threads may also stop listening.
     bool handles_close; // Set this to true for multi-threaded handling of a queue of requests where the handler is responsible for closing each comms socket.
     shared_memory_server(bool _handles_close = false) : listen(true), handles_close(_handles_close) {}
     virtual std::string identify() const = 0;
@@ -123,6 +124,17 @@ public:
     server_response_plaintext(const std::string & resp_str) : server_response_text(resp_str) { content_type = "text/plain"; header_str.clear(); str(); header_str += resp_str; }
 };
 
+/**
+ * A helpful class for server responses with JSON data.
+ * 
+ * See fzserverpq:tcp_server_handlers:handle_metrics() as an example
+ * where this is used.
+ */
+class server_response_json: public server_response_text {
+public:
+    server_response_json(const std::string & resp_str) : server_response_text(resp_str) { content_type = "application/json"; header_str.clear(); str(); header_str += resp_str; }
+};
+
 /**
  * A helpful class for server responses with binary data.
  * 
@@ -154,6 +166,9 @@ bool find_server_address(std::string & ipaddr_str);
  * 
  * See https://man7.org/linux/man-pages/man7/ip.7.html.
  * 
+ * Connections are handled in an epoll event loop with non-blocking sockets, and
+ * each request is handed to the server object once it has been received completely.
+ * 
  * Note: Only some errors return a detailed error message in an error data structure. Those
  *       are typically errors that were caught during validation of the request data. Other
  *       errors may not do so, although they will typically still log the error on the
@@ -161,9 +176,10 @@ bool find_server_address(std::string & ipaddr_str);
  * 
  * @param port_number The port number to listen on.
  * @param server A shared_memory_server derived server object to handle requests with data share.
+ * @param backlog Maximum length of the queue of connections waiting to be accepted.
  * @return Server listen outcome, expressed in exit codes (exit_ok, exit_general_error, etc).
  */
-exit_status_code server_socket_listen(uint16_t port_number, shared_memory_server & server);
+exit_status_code server_socket_listen(uint16_t port_number, shared_memory_server & server, int backlog = 64);
 
 } // namespace fz
 
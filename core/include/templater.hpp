@@ -13,6 +13,8 @@
 #define __TEMPLATER_HPP (__COREVERSION_HPP)
 
 // std
+#include <limits>
+#include <ostream>
 #include <string>
 #include <vector>
 #include <map>
@@ -45,6 +47,71 @@ struct render_varpos {
 
 typedef std::vector<render_varpos> template_varpos;
 
+/**
+ * A template that has been split into literal segments and variable slots
+ * once, so that it can be rendered many times without searching it for
+ * variable labels again. See `render_environment::compile()`.
+ */
+struct compiled_template {
+    constexpr static unsigned int empty_label = std::numeric_limits<unsigned int>::max();
+    struct variable_slot {
+        unsigned int var;           ///< Index of the variable label in `varlabels` (or empty_label).
+        std::string::size_type pos; ///< Position in the template, for warnings.
+        std::string raw;            ///< The slot as written in the template, kept if its value is skipped.
+    };
+
+    std::string source;                         ///< The original template.
+    std::vector<std::string> literals;          ///< literals[i] precedes slots[i], the last follows all slots.
+    std::vector<variable_slot> slots;
+    std::vector<std::string> varlabels;         ///< Distinct variable labels, by variable index.
+    std::map<std::string, unsigned int> varindex;
+
+    bool empty() const { return source.empty(); }
+    int variable_index(const std::string & varlabel) const;
+};
+
+template <typename Template_ID>
+using compiled_templates = std::map<Template_ID, compiled_template>;
+
+/**
+ * An output destination for rendered content.
+ * 
+ * Content is collected in a buffer that is written to the output stream
+ * whenever it reaches `flush_size`, so that a large render reaches its
+ * destination progressively and is never held in memory in full. Without
+ * an output stream all content remains in the buffer.
+ */
+struct render_sink {
+    std::ostream * out;    ///< Output stream (or nullptr to collect in buffer).
+    std::string buffer;    ///< Content not yet written.
+    size_t flush_size;     ///< Buffer size at which content is written out.
+    size_t num_written = 0;
+
+    render_sink(std::ostream * _out = nullptr, size_t _flush_size = 64*1024): out(_out), flush_size(_flush_size) {
+        buffer.reserve(flush_size + flush_size/4);
+    }
+    ~render_sink() { flush(); }
+
+    render_sink & operator+=(const std::string & s) {
+        if (out && (s.size() >= flush_size)) {
+            return write_through(s);
+        }
+        buffer += s;
+        return flush_if_full();
+    }
+    render_sink & flush_if_full() {
+        if (out && (buffer.size() >= flush_size)) {
+            flush();
+        }
+        return *this;
+    }
+    bool flush();
+    render_sink & write_through(const std::string & s);
+
+    /// Total size of the rendered content, written and buffered.
+    size_t size() const { return num_written + buffer.size(); }
+};
+
 enum render_error_t {
     rerr_ok = 0,
     rerr_missing_value = 1,
@@ -67,7 +134,31 @@ struct render_environment {
     std::string varclose = "}}";
     bool skipmissing = true;
     render_error_t render_error = rerr_ok;
-    std::string render(const std::string temp, template_varvalues vars, bool proceed_if_emptyvars = true);
+    std::vector<const std::string *> values_by_index; ///< Reused while rendering compiled templates.
+
+    std::string render(const std::string & temp, const template_varvalues & vars, bool proceed_if_emptyvars = true);
+
+    void compile(const std::string & temp, compiled_template & compiled);
+
+    /**
+     * Compile each template in a map of loaded templates.
+     * 
+     * @param templates A map of template IDs and loaded templates.
+     * @param compiled Reference to a map that receives the compiled templates by the same IDs.
+     */
+    template <typename Template_ID>
+    void compile(const std::map<Template_ID, std::string> & templates, compiled_templates<Template_ID> & compiled) {
+        compiled.clear();
+        for (const auto & [ template_id, temp ] : templates) {
+            compile(temp, compiled[template_id]);
+        }
+    }
+
+    bool render(const compiled_template & compiled, const template_varvalues & vars, std::string & rendered, bool proceed_if_emptyvars = true);
+
+    bool render(const compiled_template & compiled, const std::vector<std::string> & values, std::string & rendered);
+
+    bool render(const compiled_template & compiled, const template_varvalues & vars, render_sink & sink, bool proceed_if_emptyvars = true);
 
     /**
      * Load a template.
@@ -104,6 +195,24 @@ struct render_environment {
      */
     bool fill_preloaded_template_from_map(const std::string & preloaded_template, const std::map<std::string, std::string> & tag_data_map, std::string & rendered);
 
+    /**
+     * Use a prepared map of template tags and template data to fill a compiled template.
+     * 
+     * Example: See how this is used in fzloghtml.
+     * 
+     * @param compiled The compiled template.
+     * @param tag_data_map A string:string map of tags and data.
+     * @param rendered Reference to a string to hold the filled template.
+     * @return True if successfully filled.
+     */
+    bool fill_compiled_template_from_map(const compiled_template & compiled, const std::map<std::string, std::string> & tag_data_map, std::string & rendered);
+
+protected:
+    bool render_slots(const compiled_template & compiled, std::string & rendered);
+
+    template <typename Varmap>
+    bool render_from_map(const compiled_template & compiled, const Varmap & vars, std::string & rendered, bool proceed_if_emptyvars);
+
 };
 
 } // namespace fz
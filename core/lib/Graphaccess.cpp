@@ -3,10 +3,13 @@
 
 // std
 #include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
 //#include <utility>
 
 // core
 #include "standard.hpp"
+#include "stringio.hpp"
 #include "Graphaccess.hpp"
 #include "Graphtypes.hpp"
 #include "Logtypes.hpp"
@@ -57,6 +60,58 @@ Graph * Graph_access::request_Graph_copy(bool remove_on_exit, Graph_Config_Optio
     return graphptr;
 }
 
+/**
+ * Graph access for server programs, with warm start from a snapshot.
+ * 
+ * If the snapshot at `snapshotpath` was saved while the database was in
+ * the state it is in now (see install_Graph_change_stamp_pq()) then the
+ * shared memory segment is restored directly from the snapshot. Otherwise,
+ * the Graph is loaded from the database with request_Graph_copy() and a
+ * fresh snapshot is saved for the next start.
+ * 
+ * Warm start is skipped when Named Node Lists are not persistent, because
+ * a snapshot would bring back Lists that the database does not have.
+ * 
+ * @param snapshotpath Path to the Graph snapshot file (empty to always load from the database).
+ * @param dbstamp Receives the database change stamp that matches the returned Graph, or -1 if unknown.
+ * @param remove_on_exit The shared memory is deleted when the calling program exits.
+ * @param graph_config_ptr Optional pointer to Graph configuration options (nullptr means use defaults).
+ * @param dbexternal If not nullptr, receives the database count of changes not made by the server, read with `dbstamp`.
+ * @return Pointer to a valid Graph data structure in shared memory.
+ */
+Graph * Graph_access::request_Graph_copy_or_snapshot(const std::string & snapshotpath, int64_t & dbstamp, bool remove_on_exit, Graph_Config_Options * graph_config_ptr, int64_t * dbexternal) {
+    access_initialize();
+
+    dbstamp = -1;
+    bool persistent_NNL = (graph_config_ptr == nullptr) || graph_config_ptr->persistent_NNL;
+    if ((!snapshotpath.empty()) && persistent_NNL) {
+        int64_t stamp;
+        if (Graph_change_stamp_pq(dbname(), pq_schemaname(), stamp, dbexternal)) {
+            dbstamp = stamp;
+            Graph * graphptr = graphmemman.restore_Graph_snapshot(snapshotpath, stamp);
+            if (graphptr) {
+                graphmemman.set_remove_on_exit(remove_on_exit);
+                graphptr->set_tzadjust_active(false);
+                if (graph_config_ptr != nullptr) {
+                    graph_config_ptr->set_all(graphptr);
+                }
+                VERBOSEOUT("Graph restored from snapshot at "+snapshotpath+'\n');
+                return graphptr;
+            }
+        } else {
+            ADDWARNING(__func__, "Unable to obtain Graph change stamp, Graph snapshots disabled");
+        }
+    }
+
+    Graph * graphptr = request_Graph_copy(remove_on_exit, graph_config_ptr);
+    if (graphptr && (dbstamp >= 0)) {
+        if (!graphmemman.save_Graph_snapshot(snapshotpath, dbstamp)) {
+            ADDWARNING(__func__, "Unable to save Graph snapshot to "+snapshotpath);
+        }
+    }
+    return graphptr;
+}
+
 /**
  * A temporary stand-in while access to Log data through fzserverpq(-log) is not yet
  * available.
@@ -88,12 +143,18 @@ std::unique_ptr<Log> Graph_access::request_Log_excerpt(const Log_filter & filter
         VERBOSEOUT("\n*** Please replace that with access through fzserverpq(-log) as soon as possible!\n\n");
     }*/
 
-    access_initialize(); // this can handle being called multiple times (in case of additive filtering)
-
     std::unique_ptr<Log> logptr = std::make_unique<Log>();
 
     //VERBOSEOUT(filter.info_str());
 
+    // A memory-resident Log server spares us a Postgres load.
+    if ((!is_server) && request_Log_excerpt_from_server(filter, *logptr)) {
+        return logptr;
+    }
+    logptr = std::make_unique<Log>(); // discard anything partially received
+
+    access_initialize(); // this can handle being called multiple times (in case of additive filtering)
+
     if (!load_partial_Log_pq(*logptr, *this, filter)) {
         FZERR("\nSomething went wrong! Unable to load Log from Postgres database.\n");
         standard.exit(exit_database_error);
@@ -102,6 +163,197 @@ std::unique_ptr<Log> Graph_access::request_Log_excerpt(const Log_filter & filter
     return logptr;
 }
 
+bool find_Log_server(uint16_t & port_number) {
+    if (access(LOGSERVER_LOCKFILE, F_OK) != 0) {
+        return false;
+    }
+
+    std::string addressstr;
+    if (!file_to_string(LOGSERVER_ADDRESSFILE, addressstr)) {
+        return false;
+    }
+    auto colon_pos = addressstr.rfind(':');
+    if (colon_pos == std::string::npos) {
+        return false;
+    }
+    port_number = std::atoi(addressstr.c_str() + colon_pos + 1);
+    return port_number > 0;
+}
+
+/**
+ * Send a request to the memory-resident Log server (fzserverpq-log), if one
+ * is running, and receive the data in its response.
+ * 
+ * The server closes the connection after the response, so the response is
+ * read to EOF.
+ * 
+ * @param api_url The request URL, e.g. /fz/log/excerpt?limit=5.
+ * @param[out] data_str Receives the response data following the header.
+ * @return True if the Log server responded successfully.
+ */
+bool Log_server_GET(const std::string & api_url, std::string & data_str) {
+    uint16_t port_number;
+    if (!find_Log_server(port_number)) {
+        return false;
+    }
+
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        return false;
+    }
+    struct sockaddr_in serv_addr;
+    memset(&serv_addr, 0, sizeof(serv_addr));
+    serv_addr.sin_family = AF_INET;
+    serv_addr.sin_port = htons(port_number);
+    inet_pton(AF_INET, "127.0.0.1", &serv_addr.sin_addr);
+    if (connect(sock, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) < 0) {
+        close(sock);
+        VERBOSEOUT("Log server not responding, loading from database.\n");
+        return false;
+    }
+
+    std::string request_str("GET "+api_url+" HTTP/1.1\r\n\r\n");
+    if (send(sock, request_str.c_str(), request_str.size(), 0) < 0) {
+        close(sock);
+        return false;
+    }
+
+    data_str.clear();
+    char buf[16384];
+    ssize_t valread;
+    while ((valread = read(sock, buf, sizeof(buf))) > 0) {
+        data_str.append(buf, valread);
+    }
+    close(sock);
+    if (valread < 0) {
+        return false;
+    }
+
+    auto data_start = data_str.find("\r\n\r\n");
+    if ((data_str.compare(0, 12, "HTTP/1.1 200") != 0) || (data_start == std::string::npos)) {
+        VERBOSEOUT("Log server request failed, loading from database.\n");
+        return false;
+    }
+    data_str.erase(0, data_start + 4);
+    return true;
+}
+
+/**
+ * Obtain the Log chunks and Log entries that satisfy a filter from the
+ * memory-resident Log server (fzserverpq-log), if one is running.
+ * 
+ * The server selects the same chunks and entries that `load_partial_Log_pq()`
+ * would load, but without a database query and without having to set up
+ * the Log each time.
+ * 
+ * @param filter A selective Log reading filter structure.
+ * @param log A Log for the Chunks and Entries, typically empty.
+ * @return True if the Log server provided the excerpt.
+ */
+bool Graph_access::request_Log_excerpt_from_server(const Log_filter & filter, Log & log) {
+    ERRTRACE;
+    std::string response_str;
+    if (!Log_server_GET("/fz/log/excerpt?"+filter.GET_args(), response_str)) {
+        return false;
+    }
+
+    return deserialize_Log_excerpt(response_str, log);
+}
+
+/**
+ * Obtain the total time logged for each of a set of Nodes in a single
+ * request, for example to show time applied on many Nodes in a board
+ * (see nodeboard).
+ * 
+ * The totals are provided by the memory-resident Log server (fzserverpq-log)
+ * if one is running, or else calculated with two database queries. They are
+ * the same as `Chunks_total_minutes()` of a Log excerpt requested for each
+ * Node with `t_to` set.
+ * 
+ * @param nodes The set of Nodes.
+ * @param t_to Only include Log chunks up to this time (if not RTt_unspecified).
+ * @param[out] minutes Receives the total logged minutes for each Node.
+ * @return True if the totals were obtained.
+ */
+bool Graph_access::request_Nodes_logged_minutes(const base_Node_Set & nodes, time_t t_to, Node_minutes_map & minutes) {
+    ERRTRACE;
+    if (nodes.empty()) {
+        return true;
+    }
+
+    if (!is_server) {
+        std::string api_url("/fz/log/minutes?");
+        if (t_to != RTt_unspecified) {
+            api_url += "to="+std::to_string(t_to)+'&';
+        }
+        api_url += "nodes=";
+        for (const auto & nkey : nodes) {
+            api_url += nkey.str()+',';
+        }
+        api_url.pop_back();
+
+        std::string response_str;
+        if (Log_server_GET(api_url, response_str)) {
+            bool valid = true;
+            for (const auto & line : split(response_str, '\n')) {
+                if (line.empty()) {
+                    continue;
+                }
+                auto sep = line.find(' ');
+                if (sep == std::string::npos) {
+                    valid = false;
+                    break;
+                }
+                try {
+                    minutes[Node_ID_key(line.substr(0, sep))] = std::stoul(line.substr(sep+1));
+                } catch (std::exception & e) {
+                    valid = false;
+                    break;
+                }
+            }
+            if (valid) {
+                return true;
+            }
+            minutes.clear();
+        }
+    }
+
+    access_initialize();
+
+    return load_Nodes_logged_minutes_pq(*this, nodes, t_to, minutes);
+}
+
+/**
+ * Load the Log chunks that contain Log entries found by searching the
+ * Log entry text index (see search_Log_entries_pq()).
+ * 
+ * @param search A Log search specification.
+ * @return A Log with the Log chunks that contain matching entries.
+ */
+std::unique_ptr<Log> Graph_access::request_Log_search_excerpt(const Log_search & search) {
+    access_initialize();
+
+    std::unique_ptr<Log> logptr = std::make_unique<Log>();
+
+    Log_entry_ID_key_set entries;
+    if (!search_Log_entries_pq(*this, search, entries)) {
+        FZERR("\nSomething went wrong! Unable to search Log entries in Postgres database.\n");
+        standard.exit(exit_database_error);
+    }
+
+    Log_chunk_ID_key_set chunks;
+    for (const auto & entrykey : entries) {
+        chunks.emplace(Log_chunk_ID_key(entrykey));
+    }
+
+    if (!load_Log_chunks_pq(*logptr, *this, chunks)) {
+        FZERR("\nSomething went wrong! Unable to load Log from Postgres database.\n");
+        standard.exit(exit_database_error);
+    }
+
+    return logptr;
+}
+
 /**
  * This is often called right after the Log has been loaded, and when the
  * memory-resident Graph is present. See, for example, how this is
@@ -4,6 +4,7 @@
 //#define USE_COMPILEDPING
 
 // std
+#include <deque>
 #include <ranges>
 
 // core
@@ -135,6 +136,25 @@ void append_filter_bit_status(std::string & s, bool bitflag, std::string label,
     s += (label + ": ") + (bitflagged[(int) bitflag] + lower_str) + '-' + upper_str + "]\n";
 }
 
+/**
+ * Returns the search terms of the text filter. The phrase is one term,
+ * otherwise each space separated word is a term.
+ */
+std::vector<std::string> Node_Filter::text_terms() const {
+    std::vector<std::string> terms;
+    if (text_mode != text_match_phrase) {
+        for (const auto & term : split(lowerbound.utf8_text, ' ')) {
+            if (!term.empty()) {
+                terms.emplace_back(term);
+            }
+        }
+    }
+    if (terms.empty()) {
+        terms.emplace_back(lowerbound.utf8_text);
+    }
+    return terms;
+}
+
 std::string Node_Filter::str() {
     static const char repeats_value[2][6] = {"false", "true"};
     std::string s;
@@ -228,10 +248,34 @@ void Node_Subtree::build_targetdate_sorted(Graph & graph) {
     }
 };
 
+/**
+ * Subtree membership of a Node during Threads_Subtrees() collection, with
+ * one entry per head of the Named Nodes List.
+ */
+struct Subtrees_Membership {
+    Node * node;
+    std::vector<bool> member;    ///< The Node is in the subtree of the head.
+    std::vector<float> strength; ///< Strongest branch strength from the head.
+    std::vector<bool> pending;   ///< Strength from the head changed since the Node was last visited.
+    bool queued = false;
+
+    Subtrees_Membership(Node * _node, size_t num_heads): node(_node), member(num_heads, false), strength(num_heads, 0.0), pending(num_heads, false) {}
+};
+
 /**
  * Collect the subtrees that are the full dependencies of all Nodes in a
  * Named Nodes List.
  * 
+ * The subtrees of all heads are collected together in one traversal of the
+ * dependencies, in which each Node is visited when its branch strength from
+ * one or more heads improves. Branch strength is the weakest Edge importance
+ * along the strongest path from a head. Heads are not followed, so that
+ * they are not included in any subtree.
+ * 
+ * A Node that is in several subtrees is kept only in the subtree in which
+ * it has the strongest branch (the first such head in the List if there is
+ * a tie).
+ * 
  * Note that the 'norepeated' option is applied to the board contents after
  * full dependencies trees are collected. This is done so that excluding
  * repeated Nodes does not halt collection of dependencies in subtrees of
@@ -251,75 +295,80 @@ map_of_subtrees_t Threads_Subtrees(Graph & graph, const std::string & nnl_str, b
         standard_error("Named Node List "+nnl_str+" not found.", __func__);
         return map_of_subtrees;
     }
+    std::vector<Node_ID_key> heads(namedlist_ptr->list.begin(), namedlist_ptr->list.end());
 
-    // Collect.
-    std::set<Node_ID_key> do_not_follow;
-    for (const auto & nkey : namedlist_ptr->list) {
-        do_not_follow.emplace(nkey);
+    std::map<Node_ID_key, size_t> head_index;
+    for (size_t i = 0; i < heads.size(); ++i) {
+        head_index.emplace(heads[i], i);
+        map_of_subtrees[heads[i]]; // each head has a subtree, even if it is empty
     }
-    for (const auto & nkey : namedlist_ptr->list) {
 
-        Node * node_ptr = graph.Node_by_id(nkey);
+    // Collect.
+    std::map<Node_ID_key, Subtrees_Membership> members;
+    std::deque<Subtrees_Membership *> queue;
+    auto follow_dependencies = [&](const Node & node, size_t i, float strength) {
+        for (const auto & edge_ptr : node.dep_Edges()) {
+            if (!edge_ptr) continue;
+
+            Node_ID_key nkey = edge_ptr->get_dep_key();
+            if (head_index.find(nkey) != head_index.end()) continue;
+
+            // Strength along this branch becomes equal to the weakest link so far.
+            float branch_strength = edge_ptr->get_importance();
+            if ((strength >= -999) && (strength < branch_strength)) {
+                branch_strength = strength;
+            }
 
-        Node_Subtree fulldepth_dependencies;
-        if (!Node_Dependencies_fulldepth(node_ptr, fulldepth_dependencies.map_by_key, do_not_follow, Node_Branch::minimum_importance)) {
-            standard_error("Full depth dependencies collection failed for Node "+nkey.str()+", skipping", __func__);
-            continue;
+            auto it = members.try_emplace(nkey, edge_ptr->get_dep(), heads.size()).first;
+            Subtrees_Membership & membership = it->second;
+            if ((!membership.member[i]) || (branch_strength > membership.strength[i])) {
+                membership.member[i] = true;
+                membership.strength[i] = branch_strength;
+                membership.pending[i] = true;
+                if (!membership.queued) {
+                    membership.queued = true;
+                    queue.emplace_back(&membership);
+                }
+            }
         }
+    };
 
-        // if (sort_by_targetdate) {
-        //     fulldepth_dependencies.build_targetdate_sorted(graph);
-        // }
-
-        map_of_subtrees[nkey] = fulldepth_dependencies;
+    for (size_t i = 0; i < heads.size(); ++i) {
+        if (head_index[heads[i]] != i) continue; // listed more than once
 
+        Node * node_ptr = graph.Node_by_id(heads[i]);
+        if (!node_ptr) {
+            standard_error("Full depth dependencies collection failed for Node "+heads[i].str()+", skipping", __func__);
+            continue;
+        }
+        follow_dependencies(*node_ptr, i, -999.9);
+    }
+    while (!queue.empty()) {
+        Subtrees_Membership & membership = *queue.front();
+        queue.pop_front();
+        membership.queued = false;
+        for (size_t i = 0; i < heads.size(); ++i) {
+            if (membership.pending[i]) {
+                membership.pending[i] = false;
+                follow_dependencies(*membership.node, i, membership.strength[i]);
+            }
+        }
     }
 
     // Prune.
-    for (unsigned int i = 0; i < namedlist_ptr->list.size(); i++) {
-        Node_ID_key nkey = namedlist_ptr->list[i];
-        Node_Subtree & subtree = map_of_subtrees[nkey];
-
-        // Check each Node collected in this subtree.
-        std::vector<Node_ID_key> erase_from_this_tree;
-        for (auto & [dkey, dbranch]: subtree.map_by_key) {
-            bool dkey_erased = false;
-
-            // Apply optional removal of repeated Nodes.
-            if (norepeated) { // *** Oh-oh, this probably breaks Node_Branch connections, so we don't use this right now! See how nodeboard function node_board_render_NNL_dependencies() does this instead!
-                Node * d_node_ptr = graph.Node_by_id(dkey);
-                if (d_node_ptr) {
-                    if (d_node_ptr->get_repeats()) {
-                        erase_from_this_tree.emplace_back(dkey); // cache this to prevent breaking the map while iterating it
-                        dkey_erased = true;
-                    }
-                }
-            }
+    for (const auto & [nkey, membership] : members) {
+        // Apply optional removal of repeated Nodes.
+        if (norepeated && membership.node->get_repeats()) { // *** Oh-oh, this probably breaks Node_Branch connections, so we don't use this right now! See how nodeboard function node_board_render_NNL_dependencies() does this instead!
+            continue;
+        }
 
-            if (!dkey_erased) {
-                // Inspect remaining subtrees for instances of the same Node.
-                for (unsigned int j = i+1; j < namedlist_ptr->list.size(); j++) {
-                    Node_ID_key ckey = namedlist_ptr->list[j];
-                    Node_Subtree & c_subtree = map_of_subtrees[ckey];
-
-                    auto it = c_subtree.map_by_key.find(dkey);
-                    if (it != c_subtree.map_by_key.end()) {
-                        if (it->second.strength <= dbranch.strength) {
-                            c_subtree.map_by_key.erase(dkey);
-                        } else {
-                            erase_from_this_tree.emplace_back(dkey); // cache this to prevent breaking the map while iterating it
-                            dkey_erased = true;
-                            break; // skip the rest of the inner loop
-                        }
-                    }
-                }
+        size_t strongest = heads.size();
+        for (size_t i = 0; i < heads.size(); ++i) {
+            if (membership.member[i] && ((strongest == heads.size()) || (membership.strength[i] > membership.strength[strongest]))) {
+                strongest = i;
             }
         }
-        
-        // handle erasures in this subtree
-        for (auto & ekey : erase_from_this_tree) {
-            subtree.map_by_key.erase(ekey);
-        }
+        map_of_subtrees[heads[strongest]].map_by_key.emplace(nkey, Node_Branch(membership.node, membership.strength[strongest]));
     }
 
     // Sort.
@@ -339,6 +388,15 @@ bool Map_of_Subtrees::collect(Graph & graph, const std::string & list_name) {
     map_of_subtrees = Threads_Subtrees(graph, subtrees_list_name, sort_by_targetdate);
     has_subtrees = !map_of_subtrees.empty();
     t_collected = ActualTime();
+
+    // Subtrees do not overlap and do not contain heads, so each Node is in at most one.
+    subtree_heads.clear();
+    for (const auto & [subtree_key, subtree_ref] : map_of_subtrees) {
+        subtree_heads.emplace(subtree_key, subtree_key);
+        for (const auto & [nkey, branch] : subtree_ref.map_by_key) {
+            subtree_heads.emplace(nkey, subtree_key);
+        }
+    }
     return true;
 }
 
@@ -370,10 +428,8 @@ bool Map_of_Subtrees::node_in_subtree(Node_ID_key subtree_key, Node_ID_key node_
 
 bool Map_of_Subtrees::node_in_any_subtree(Node_ID_key node_key) const {
     if (!has_subtrees) return false;
-    for (const auto & [subtree_key, subtree_ref]: map_of_subtrees) {
-        if (subtree_ref.map_by_key.find(node_key) != subtree_ref.map_by_key.end()) return true;
-    }
-    return false;
+    auto it = subtree_heads.find(node_key);
+    return (it != subtree_heads.end()) && (!(it->second == node_key));
 }
 
 /**
@@ -471,24 +527,15 @@ bool Map_of_Subtrees::node_in_heads_or_any_subtree(Node_ID_key node_key, Boolean
 
     // Find in Map of Subtrees and attempt to infer BTF from that
     if (!has_subtrees) return false; // At present, this function demands that there be a valid map of subtrees.
-    for (const auto & [subtree_key, subtree_ref]: map_of_subtrees) {
-        if (subtree_key == node_key) {
-            /**
-             * If this Node is the head of this Subtree then use its Boolean Tag Flag.
-             */
-            boolean_tag = get_category_boolean_tag(node_key, subtree_key);
-            node_found = true;
-            break;
-        }
-        if (subtree_ref.map_by_key.find(node_key) != subtree_ref.map_by_key.end()) {
-            /**
-             * If this Node is within the Subtree then use either, a) its own explicitly
-             * specified Boolean Tag Flag, or b) the Boolean Tag Flag of the Subtree head.
-             */
-            boolean_tag = get_category_boolean_tag(node_key, subtree_key);
-            node_found = true;
-            break;
-        }
+    auto head_it = subtree_heads.find(node_key);
+    if (head_it != subtree_heads.end()) {
+        /**
+         * If this Node is the head of a Subtree then use its Boolean Tag Flag.
+         * If this Node is within a Subtree then use either, a) its own explicitly
+         * specified Boolean Tag Flag, or b) the Boolean Tag Flag of the Subtree head.
+         */
+        boolean_tag = get_category_boolean_tag(node_key, head_it->second);
+        node_found = true;
     }
 
     // Infer BTF from tree of Superiors
@@ -529,19 +576,18 @@ bool Map_of_Subtrees::node_in_heads_or_any_subtree(Node_ID_key node_key, Boolean
  * Functions for working with @PREREQS:...@ and @PROVIDES:...@ data in Nodes.
  */
 
-void Prerequisite::update(const std::vector<std::string> & provided_vec, Node * provider) {
+void Prerequisite::update(Node * provider) {
     if (_state == fulfilled) {
         return;
     }
+    _state = (provider->get_completion() >= 1.0) ? fulfilled : unfulfilled;
+    provided_by = provider;
+}
+
+void Prerequisite::update(const std::vector<std::string> & provided_vec, Node * provider) {
     for (const auto & provided : provided_vec) {
         if (prereq == provided) {
-            if (provider->get_completion() >= 1.0) {
-                _state = fulfilled;
-                provided_by = provider;
-                return;
-            }
-            _state = unfulfilled;
-            provided_by = provider;
+            update(provider);
             return;
         }
     }
@@ -549,20 +595,18 @@ void Prerequisite::update(const std::vector<std::string> & provided_vec, Node *
 
 std::vector<Prerequisite> get_prerequisites(const Node & node, bool check_prerequisites) {
     std::vector<Prerequisite> prereqs;
-    std::string text(node.get_text().c_str());
-    auto prereqs_start = text.find("@PREREQS:");
-    if (prereqs_start == std::string::npos) {
-        return prereqs;
-    }
-    prereqs_start += 9;
-    auto prereqs_end = text.find('@', prereqs_start);
-    if (prereqs_end == std::string::npos) {
-        return prereqs;
-    }
-    std::string prereqs_str = text.substr(prereqs_start, prereqs_end - prereqs_start);
-    auto prereqs_strvec = split(prereqs_str, ',');
-    for (const auto & prereq_str : prereqs_strvec) {
-        prereqs.emplace_back(Prerequisite(prereq_str));
+    Graph * graph_ptr = node.get_graph();
+    if (graph_ptr && graph_ptr->capability_index_is_active()) {
+        const Node_Capabilities * capabilities = graph_ptr->find_Node_capabilities(node.get_id().key());
+        if (capabilities) {
+            for (const auto & id : capabilities->prereqs) {
+                prereqs.emplace_back(Prerequisite(graph_ptr->get_capability(id).name.c_str()));
+            }
+        }
+    } else {
+        for (const auto & prereq_str : capability_tag_items(node.get_text().c_str(), "@PREREQS:")) {
+            prereqs.emplace_back(Prerequisite(prereq_str));
+        }
     }
 
     if (check_prerequisites && (!prereqs.empty())) {
@@ -573,39 +617,117 @@ std::vector<Prerequisite> get_prerequisites(const Node & node, bool check_prereq
 }
 
 std::vector<std::string> get_provides_capabilities(const Node & node) {
+    Graph * graph_ptr = node.get_graph();
+    if (!(graph_ptr && graph_ptr->capability_index_is_active())) {
+        return capability_tag_items(node.get_text().c_str(), "@PROVIDES:");
+    }
+
     std::vector<std::string> provides;
-    std::string text(node.get_text().c_str());
-    auto provides_start = text.find("@PROVIDES:");
-    if (provides_start == std::string::npos) {
-        return provides;
-    }
-    provides_start += 10;
-    auto provides_end = text.find('@', provides_start);
-    if (provides_end == std::string::npos) {
-        return provides;
-    }
-    std::string provides_str = text.substr(provides_start, provides_end - provides_start);
-    provides = split(provides_str, ',');
+    const Node_Capabilities * capabilities = graph_ptr->find_Node_capabilities(node.get_id().key());
+    if (capabilities) {
+        for (const auto & id : capabilities->provides) {
+            provides.emplace_back(graph_ptr->get_capability(id).name.c_str());
+        }
+    }
     return provides;
 }
 
 void check_prerequisites_provided_by_dependencies(const Node & node, std::vector<Prerequisite> & prereqs, int go_deeper) {
-    for (const auto & edge_ptr : node.dep_Edges()) {
-        if (edge_ptr) {
-            Node * dep_ptr = edge_ptr->get_dep();
-            if (dep_ptr) {
-                auto dep_provides = get_provides_capabilities(*dep_ptr);
-                for (auto & prereq : prereqs) {
-                    prereq.update(dep_provides, dep_ptr);
+    Graph * graph_ptr = node.get_graph();
+    if (!(graph_ptr && graph_ptr->capability_index_is_active())) {
+        for (const auto & edge_ptr : node.dep_Edges()) {
+            if (edge_ptr) {
+                Node * dep_ptr = edge_ptr->get_dep();
+                if (dep_ptr) {
+                    auto dep_provides = get_provides_capabilities(*dep_ptr);
+                    for (auto & prereq : prereqs) {
+                        prereq.update(dep_provides, dep_ptr);
+                    }
+                    if (go_deeper>0) {
+                        check_prerequisites_provided_by_dependencies(*dep_ptr, prereqs, go_deeper-1);
+                    }
                 }
-                if (go_deeper>0) {
-                    check_prerequisites_provided_by_dependencies(*dep_ptr, prereqs, go_deeper-1);
+            }
+        }
+        return;
+    }
+
+    std::vector<const Capability *> prereq_capabilities;
+    bool has_providers = false;
+    for (const auto & prereq : prereqs) {
+        const Capability * capability_ptr = graph_ptr->find_capability(prereq.str());
+        prereq_capabilities.emplace_back(capability_ptr);
+        has_providers |= (capability_ptr && (!capability_ptr->providers.empty()));
+    }
+    if (!has_providers) {
+        return;
+    }
+
+    // Collect the dependencies down to the same depth as the recursive search above.
+    std::set<const Node *> dependencies;
+    std::vector<const Node *> level(1, &node), next_level;
+    for (int depth = 0; (depth <= go_deeper) && (!level.empty()); ++depth) {
+        for (const auto & level_node_ptr : level) {
+            for (const auto & edge_ptr : level_node_ptr->dep_Edges()) {
+                if (edge_ptr) {
+                    const Node * dep_ptr = edge_ptr->get_dep();
+                    if (dep_ptr && dependencies.emplace(dep_ptr).second) {
+                        next_level.emplace_back(dep_ptr);
+                    }
                 }
             }
         }
+        level.swap(next_level);
+        next_level.clear();
+    }
+
+    for (size_t i = 0; i < prereqs.size(); ++i) {
+        if (!prereq_capabilities[i]) {
+            continue;
+        }
+        for (const auto & provider : prereq_capabilities[i]->providers) {
+            if (dependencies.find(provider.get()) != dependencies.end()) {
+                prereqs[i].update(provider.get());
+            }
+        }
     }
 }
 
+/**
+ * Collect candidate Nodes for text search terms from the Graph text index.
+ * 
+ * @param graph A valid Graph data structure.
+ * @param terms Text search terms.
+ * @param text_mode Whether candidates must match all terms or any term.
+ * @param candidates Receives the ascending text index ordinals of candidate Nodes.
+ * @return False if the index cannot narrow the search.
+ */
+bool text_index_candidates(const Graph & graph, const std::vector<std::string> & terms, text_match_mode text_mode, std::vector<uint32_t> & candidates) {
+    bool narrowed = false;
+    std::vector<uint32_t> termcandidates, combined;
+    for (const auto & term : terms) {
+        if (!graph.text_index_candidates(term, termcandidates)) {
+            if (text_mode == text_match_any_term) {
+                return false; // that term could be in any Node
+            }
+            continue;
+        }
+        if (!narrowed) {
+            candidates.swap(termcandidates);
+            narrowed = true;
+            continue;
+        }
+        combined.clear();
+        if (text_mode == text_match_any_term) {
+            std::set_union(candidates.begin(), candidates.end(), termcandidates.begin(), termcandidates.end(), std::back_inserter(combined));
+        } else {
+            std::set_intersection(candidates.begin(), candidates.end(), termcandidates.begin(), termcandidates.end(), std::back_inserter(combined));
+        }
+        candidates.swap(combined);
+    }
+    return narrowed;
+}
+
 /**
  * Finds all Nodes that match a specified Node_Filter.
  * 
@@ -624,25 +746,43 @@ targetdate_sorted_Nodes Nodes_subset(Graph & graph, const Node_Filter & nodefilt
         return nodes;
     }
 
-    std::string uppersearchtext;
-    if (nodefilter.filtermask.Edit_text() && (!nodefilter.case_sensitive)) {
-        uppersearchtext = nodefilter.lowerbound.utf8_text;
-        std::transform (uppersearchtext.begin(), uppersearchtext.end(), uppersearchtext.begin(), ::toupper);
+    std::vector<std::string> searchterms;
+    if (nodefilter.filtermask.Edit_text()) {
+        searchterms = nodefilter.text_terms();
+        if (!nodefilter.case_sensitive) {
+            for (auto & term : searchterms) {
+                std::transform (term.begin(), term.end(), term.begin(), ::toupper);
+            }
+        }
     }
+    bool any_term = (nodefilter.text_mode == text_match_any_term);
+
+    // Lambda function to test the text filter.
+    auto text_matches = [&] (auto node_ptr) {
+        std::string uppertext;
+        if (!nodefilter.case_sensitive) {
+            uppertext = node_ptr->get_text().c_str();
+            std::transform (uppertext.begin(), uppertext.end(), uppertext.begin(), ::toupper);
+        }
+        for (const auto & term : searchterms) {
+            bool found;
+            if (!nodefilter.case_sensitive) {
+                found = (uppertext.find(term) != std::string::npos);
+            } else {
+                found = (node_ptr->get_text().find(term.c_str()) != Node_utf8_text::npos);
+            }
+            if (found == any_term) {
+                return any_term;
+            }
+        }
+        return !any_term;
+    };
 
     // Lambda function to apply filter tests.
     auto apply_filters = [&] (auto node_ptr) {
         if (nodefilter.filtermask.Edit_text()) {
-            if (!nodefilter.case_sensitive) {
-                std::string uppertext(node_ptr->get_text().c_str());
-                std::transform (uppertext.begin(), uppertext.end(), uppertext.begin(), ::toupper);
-                if (uppertext.find(uppersearchtext) == std::string::npos) {
-                    return false;
-                }
-            } else {
-                if (node_ptr->get_text().find(nodefilter.lowerbound.utf8_text.c_str()) == Node_utf8_text::npos) {
-                    return false;
-                }
+            if (!text_matches(node_ptr)) {
+                return false;
             }
         }
         if (nodefilter.filtermask.Edit_completion()) {
@@ -705,7 +845,7 @@ targetdate_sorted_Nodes Nodes_subset(Graph & graph, const Node_Filter & nodefilt
                     return false;
                 }
                 if (nodefilter.self_is_superior) {
-                    if (!node_ptr->has_sup(node_ptr->get_id_str())) {
+                    if (!node_ptr->has_sup(node_ptr->get_id().key())) {
                         return false;
                     }
                 }
@@ -729,39 +869,86 @@ targetdate_sorted_Nodes Nodes_subset(Graph & graph, const Node_Filter & nodefilt
         return true;
     };
 
-    if (newest_first) {
-        for (const auto & [nkey, node_ptr] : graph.get_nodes() | std::views::reverse) {
+    // Lambda function that adds a matching Node and returns false when the excerpt is complete.
+    auto add_if_matching = [&] (Node * node_ptr) {
+        if (apply_filters(node_ptr)) {
+            // matched all filter requirements
+            nodes.emplace(node_ptr->effective_targetdate(), node_ptr);
+            if ((excerpt_size != 0) && (nodes.size() >= excerpt_size)) {
+                return false;
+            }
+        }
+        return true;
+    };
 
-            if (apply_filters(node_ptr)) {
-                // matched all filter requirements
-                nodes.emplace(node_ptr->effective_targetdate(), node_ptr.get());
-                if ((excerpt_size != 0) && (nodes.size() >= excerpt_size)) {
-                    break;
-                }
+    // With a text filter, only test the Nodes that the text index finds (in the same order).
+    std::vector<uint32_t> candidates;
+    if (nodefilter.filtermask.Edit_text() && text_index_candidates(graph, searchterms, nodefilter.text_mode, candidates)) {
+        std::vector<Node *> candidate_nodes;
+        candidate_nodes.reserve(candidates.size());
+        for (const auto & ordinal : candidates) {
+            Node * node_ptr = graph.text_index_Node(ordinal);
+            if (node_ptr) {
+                candidate_nodes.emplace_back(node_ptr);
             }
+        }
+        std::sort(candidate_nodes.begin(), candidate_nodes.end(), [](const Node * a, const Node * b) {
+            return a->get_id().key() < b->get_id().key();
+        });
+        if (newest_first) {
+            std::reverse(candidate_nodes.begin(), candidate_nodes.end());
+        }
+        for (const auto & node_ptr : candidate_nodes) {
+            if (!add_if_matching(node_ptr)) {
+                break;
+            }
+        }
+        return nodes;
+    }
 
+    if (newest_first) {
+        for (const auto & [nkey, node_ptr] : graph.get_nodes() | std::views::reverse) {
+            if (!add_if_matching(node_ptr.get())) {
+                break;
+            }
         }
     } else {
         for (const auto & [nkey, node_ptr] : graph.get_nodes()) {
-
-            if (apply_filters(node_ptr)) {
-                // matched all filter requirements
-                nodes.emplace(node_ptr->effective_targetdate(), node_ptr.get());
-                if ((excerpt_size != 0) && (nodes.size() >= excerpt_size)) {
-                    break;
-                }
+            if (!add_if_matching(node_ptr.get())) {
+                break;
             }
-
         }
     }
 
     return nodes;
 }
 
+/**
+ * The target date index can stand in for a scan of all Nodes if it is being
+ * maintained and if no time-zone adjustment is currently active (the index is
+ * sorted by unadjusted effective target dates).
+ */
+bool targetdate_index_usable(const Graph & graph) {
+    return graph.targetdate_index_is_active() && (graph.tz_adjust(0) == 0);
+}
+
+Targetdate_Index_range Nodes_incomplete_by_targetdate_range(const Graph & graph, time_t t_from, time_t t_before, bool repeating_only) {
+    const Targetdate_Index_Map & index = repeating_only ? graph.get_incomplete_repeating_by_targetdate() : graph.get_incomplete_by_targetdate();
+    if ((!graph.targetdate_index_is_active()) || (t_before <= t_from)) {
+        return Targetdate_Index_range{ index.end(), index.end() };
+    }
+    auto it_from = index.lower_bound(Targetdate_Index_key(t_from));
+    auto it_before = (t_before == RTt_maxtime) ? index.end() : index.lower_bound(Targetdate_Index_key(t_before));
+    return Targetdate_Index_range{ it_from, it_before };
+}
+
 /**
  * Selects all Nodes that are incomplete and lists them by (inherited)
  * target date.
  * 
+ * This uses the Graph target date index if that is maintained (e.g. by
+ * fzserverpq) instead of computing effective target dates for all Nodes.
+ * 
  * For example, see how this is used in `fzgraphhtml`.
  * 
  * @param graph A valid Graph data structure.
@@ -769,6 +956,12 @@ targetdate_sorted_Nodes Nodes_subset(Graph & graph, const Node_Filter & nodefilt
  */
 targetdate_sorted_Nodes Nodes_incomplete_by_targetdate(Graph & graph) {
     targetdate_sorted_Nodes nodes;
+    if (targetdate_index_usable(graph)) {
+        for (const auto & [tdkey, node_ptr] : graph.get_incomplete_by_targetdate()) {
+            nodes.emplace_hint(nodes.end(), tdkey.td, node_ptr.get());
+        }
+        return nodes;
+    }
     for (const auto & [nkey, node_ptr] : graph.get_nodes()) {
         float completion = node_ptr->get_completion();
         if ((completion>=0.0) && (completion<1.0) && (node_ptr->get_required()>0.0)) {
@@ -778,6 +971,130 @@ targetdate_sorted_Nodes Nodes_incomplete_by_targetdate(Graph & graph) {
     return nodes; // automatic copy elision std::move(nodes);
 }
 
+/**
+ * Prepare to merge target date sorted Nodes with repeat instances.
+ * 
+ * @param _sortednodes A list of target date sorted Node pointers.
+ * @param _t_max Limit to which to generate instances.
+ * @param _limit_repeats_only If true then apply t_max only to repeating Nodes.
+ */
+Targetdate_Repeats_Merge::Targetdate_Repeats_Merge(const targetdate_sorted_Nodes & _sortednodes, time_t _t_max, bool _limit_repeats_only) :
+    sortednodes(_sortednodes), base_it(_sortednodes.begin()), t_max(_t_max), limit_repeats_only(_limit_repeats_only) {
+    if (t_max < 0) {
+        t_max = RTt_maxtime;
+    }
+}
+
+/// Returns true if there are Nodes in sortednodes that remain to be merged.
+bool Targetdate_Repeats_Merge::base_available() const {
+    if (base_it == sortednodes.end()) {
+        return false;
+    }
+    return limit_repeats_only || (base_it->first <= t_max);
+}
+
+/**
+ * Move the repeating Node at the current position in sortednodes into the heap,
+ * starting at its target date. It is skipped if that is beyond t_max. Span
+ * interpretation is as in `Node::repeat_targetdates()`.
+ */
+void Targetdate_Repeats_Merge::add_repeating() {
+    time_t t = base_it->first;
+    Node_ptr node_ptr = base_it->second;
+    size_t order = base_order;
+    ++base_it;
+    ++base_order;
+    if (t > t_max) {
+        return;
+    }
+
+    int span = node_ptr->get_tdspan();
+    bool unlimited = false;
+    if ((span==1) || (span<0)) {
+        ADDWARNING(__func__, "Node "+node_ptr->get_id_str()+" has invalid tdspan, treating as non-repeating.");
+        span = 1;
+    } else {
+        unlimited = span == 0;
+    }
+    heap.push_back({t, order, node_ptr, span, unlimited});
+    std::push_heap(heap.begin(), heap.end(), later);
+}
+
+/**
+ * Returns true if the next instance is at the top of the heap. A repeat
+ * instance precedes a Node from sortednodes with an equal target date,
+ * because that Node comes later in sortednodes.
+ */
+bool Targetdate_Repeats_Merge::heap_is_next() const {
+    if (heap.empty()) {
+        return false;
+    }
+    return (!base_available()) || (heap.front().t <= base_it->first);
+}
+
+/**
+ * Obtain the next Node instance in target date order.
+ * 
+ * @param t Receives the (repeat) target date of the instance.
+ * @param node_ptr Receives the Node pointer.
+ * @return False if there are no more instances up to t_max.
+ */
+bool Targetdate_Repeats_Merge::next(time_t & t, Node_ptr & node_ptr) {
+    while (true) {
+        if (heap_is_next()) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            Repeat_Instance & instance = heap.back();
+            t = instance.t;
+            node_ptr = instance.node_ptr;
+
+            --instance.span;
+            if ((instance.span > 0) || instance.unlimited) {
+                instance.t = Add_to_Date(instance.t, node_ptr->get_tdpattern(), node_ptr->get_tdevery());
+                if (instance.t <= t_max) {
+                    std::push_heap(heap.begin(), heap.end(), later);
+                    return true;
+                }
+            }
+            heap.pop_back();
+            return true;
+        }
+
+        if (!base_available()) {
+            return false;
+        }
+
+        if (base_it->second->get_repeats()) {
+            add_repeating();
+            continue;
+        }
+
+        t = base_it->first;
+        node_ptr = base_it->second;
+        ++base_it;
+        ++base_order;
+        return true;
+    }
+}
+
+/**
+ * Returns the target date of the instance that `next()` would return, or
+ * RTt_unspecified if there are no more instances. Use this to stop at a
+ * time before t_max without consuming an instance.
+ */
+time_t Targetdate_Repeats_Merge::next_targetdate() {
+    // Repeating Nodes that could be next are moved into the heap first.
+    while (base_available() && base_it->second->get_repeats() && (heap.empty() || (base_it->first <= heap.front().t))) {
+        add_repeating();
+    }
+    if (heap_is_next()) {
+        return heap.front().t;
+    }
+    if (!base_available()) {
+        return RTt_unspecified;
+    }
+    return base_it->first;
+}
+
 /**
  * Add virtual Nodes to produce a list where repeating Nodes appear at their
  * pattern-specified repeat target dates.
@@ -788,10 +1105,11 @@ targetdate_sorted_Nodes Nodes_incomplete_by_targetdate(Graph & graph) {
  * be prepared with `Nodes_incomplete_by_targetdate()`. Otherwise, use an alternative
  * preparation. See `Nodes_incomplete_with_repeating_by_targetdate()` below.
  * 
- * BEWARE: As implemented presently, the N_max limit is only applied by cropping
- *         after collecting a potentially much larger set.
- *         As implemented presently, the combination N_max==0 and t_max<0 leads to
- *         an attempt to create a set with infinite repeated Nodes of unlimited span.
+ * Instances are generated in order by `Targetdate_Repeats_Merge`, so that collection
+ * stops as soon as N_max instances have been gathered.
+ * 
+ * BEWARE: The combination N_max==0 and t_max<0 leads to an attempt to create a set
+ *         with infinite repeated Nodes of unlimited span.
  * 
  * @param sortednodes A list of target date sorted Node pointers.
  * @param t_max Limit to which to generate the resulting list of Node pointers.
@@ -801,30 +1119,11 @@ targetdate_sorted_Nodes Nodes_incomplete_by_targetdate(Graph & graph) {
  */
 targetdate_sorted_Nodes Nodes_with_repeats_by_targetdate(const targetdate_sorted_Nodes & sortednodes, time_t t_max, size_t N_max, bool limit_repeats_only) {
     targetdate_sorted_Nodes withrepeats;
-    if (t_max < 0) {
-        t_max = RTt_maxtime;
-    }
-    for (const auto & [t, node_ptr] : sortednodes) {
-        if ((t > t_max) && (!limit_repeats_only)) {
-            break;
-        }
-        // Note that you cannot immediately apply N_max here, because the first repeated Nodes
-        // might fill up all the space even though others will have earlier target dates.
-        if (node_ptr->get_repeats()) {
-            if (t <= t_max) {
-                auto tdwithrepeats = node_ptr->repeat_targetdates(t_max, N_max, t);
-                for (const auto & t_repeat : tdwithrepeats) {
-                    withrepeats.emplace(t_repeat, node_ptr);
-                }
-            }
-        } else {
-            withrepeats.emplace(t, node_ptr);
-        }
-    }
-    if (N_max > 0) {
-        if (withrepeats.size() > N_max) {
-            withrepeats.erase(std::next(withrepeats.begin(), N_max), withrepeats.end());
-        }
+    Targetdate_Repeats_Merge merged(sortednodes, t_max, limit_repeats_only);
+    time_t t;
+    Node_ptr node_ptr;
+    while (((N_max == 0) || (withrepeats.size() < N_max)) && merged.next(t, node_ptr)) {
+        withrepeats.emplace_hint(withrepeats.end(), t, node_ptr);
     }
     return withrepeats;
 }
@@ -942,6 +1241,12 @@ size_t total_minutes_incomplete_nonrepeating(Graph & graph, time_t from_t, time_
  */
 targetdate_sorted_Nodes Nodes_incomplete_and_repeating_by_targetdate(Graph & graph) {
     targetdate_sorted_Nodes nodes;
+    if (targetdate_index_usable(graph)) {
+        for (const auto & [tdkey, node_ptr] : graph.get_incomplete_repeating_by_targetdate()) {
+            nodes.emplace_hint(nodes.end(), tdkey.td, node_ptr.get());
+        }
+        return nodes;
+    }
     for (const auto & [nkey, node_ptr] : graph.get_nodes()) {
         float completion = node_ptr->get_completion();
         if ((completion>=0.0) && (completion<1.0) && (node_ptr->get_required()>0.0) && node_ptr->get_repeats()) {
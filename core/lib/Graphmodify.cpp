@@ -4,7 +4,12 @@
 // std
 #include <cmath>
 #include <random>
+#include <climits>
 #include <uuid/uuid.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 // core
 #include "error.hpp"
@@ -172,12 +177,274 @@ std::string unique_name_Graphmod() {
     // was: return TimeStamp("%Y%m%d%H%M%S",ActualTime());
 }
 
+/// Returns the index of the ring slot of a request name, or -1 if the request has its own segment.
+int graphmod_request_slot(const std::string & requestname) {
+    auto hashpos = requestname.rfind('#');
+    if (hashpos == std::string::npos) {
+        return -1;
+    }
+    int slot = std::atoi(requestname.c_str() + hashpos + 1);
+    return ((slot >= 0) && (slot < (int) graphmod_ring_slots)) ? slot : -1;
+}
+
+std::string graphmod_request_segment(const std::string & requestname) {
+    return requestname.substr(0, requestname.rfind('#'));
+}
+
+/// Returns the name of a request object, e.g. "graphmod" or "graphmod#3" for a request in ring slot 3.
+std::string graphmod_object_name(const std::string & requestname, const char * objectname) {
+    auto hashpos = requestname.rfind('#');
+    if (hashpos == std::string::npos) {
+        return objectname;
+    }
+    return objectname + requestname.substr(hashpos);
+}
+
+void futex_wait(std::atomic<uint32_t> & word, uint32_t expected, unsigned int timeout_ms) {
+    struct timespec timeout = { (time_t) (timeout_ms / 1000), (long) (timeout_ms % 1000) * 1000000L };
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t> & word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+bool process_exists(pid_t pid) {
+    return (pid > 0) && ((kill(pid, 0) == 0) || (errno != ESRCH));
+}
+
+/// Destroy the request objects in a ring slot, including the data carriers that the requests point to.
+void destroy_Graphmod_ring_objects(segment_memory_t & segment, const std::string & requestname) {
+    Graph_modifications * graphmod_ptr = segment.find<Graph_modifications>(graphmod_object_name(requestname, "graphmod").c_str()).first;
+    if (graphmod_ptr) {
+        for (auto & gmoddata : graphmod_ptr->data) {
+            if (gmoddata.node_ptr) segment.destroy_ptr(gmoddata.node_ptr.get());
+            if (gmoddata.edge_ptr) segment.destroy_ptr(gmoddata.edge_ptr.get());
+            if (gmoddata.nodelist_ptr) segment.destroy_ptr(gmoddata.nodelist_ptr.get());
+            if (gmoddata.batchmodtd_ptr) {
+                if (gmoddata.batchmodtd_ptr->tdnkeys) segment.destroy_ptr(gmoddata.batchmodtd_ptr->tdnkeys.get());
+                segment.destroy_ptr(gmoddata.batchmodtd_ptr.get());
+            }
+            if (gmoddata.batchmodtpass_ptr) segment.destroy_ptr(gmoddata.batchmodtpass_ptr.get());
+        }
+        segment.destroy_ptr(graphmod_ptr);
+    }
+    segment.destroy<Graphmod_results>(graphmod_object_name(requestname, "results").c_str());
+    segment.destroy<Graphmod_error>(graphmod_object_name(requestname, "error").c_str());
+}
+
+/**
+ * The request ring as seen by a client program, and the ring slots that the
+ * client has claimed, mapped from the segment names that they replace.
+ * 
+ * Slots that are still claimed when the program exits are released, so that
+ * requests that were prepared but never submitted (e.g. dry runs) do not
+ * occupy the ring.
+ */
+struct Graphmod_ring_client {
+    segment_memory_t * segment = nullptr;
+    Graphmod_ring * ring = nullptr;
+    bool tried = false;
+    std::map<std::string, std::string> requests;
+
+    ~Graphmod_ring_client() {
+        for (const auto & [segname, requestname] : requests) {
+            release(requestname);
+        }
+    }
+
+    bool available() const {
+        return ring && process_exists(ring->server_pid);
+    }
+
+    bool open() {
+        if (!tried) {
+            tried = true;
+            try {
+                segment = new segment_memory_t(bi::open_only, graphmod_ring_segname);
+            } catch (const bi::interprocess_exception & ipexception) {
+                segment = nullptr;
+                return false;
+            }
+            ring = segment->find<Graphmod_ring>("ring").first;
+            if (!ring) {
+                return false;
+            }
+            void_allocator * alloc_inst = new void_allocator(segment->get_segment_manager());
+            graphmemman.cache();
+            graphmemman.add_manager(graphmod_ring_segname, *segment, *alloc_inst);
+            graphmemman.set_active(graphmod_ring_segname);
+            graphmemman.set_remove_on_exit(false); // the server owns the ring
+            graphmemman.uncache();
+        }
+        return available();
+    }
+
+    /// Claim a free slot, or the slot of a client that exited without releasing it.
+    std::string claim(unsigned long segsize) {
+        if (!open()) {
+            return "";
+        }
+        if (segment->get_free_memory() < segsize) {
+            return "";
+        }
+        for (unsigned int i = 0; i < graphmod_ring_slots; ++i) {
+            Graphmod_ring_slot & slot = ring->slots[i];
+            uint32_t state = slot.state;
+            if (state == graphmod_slot_free) {
+                if (!slot.state.compare_exchange_strong(state, graphmod_slot_claimed)) {
+                    continue;
+                }
+                slot.client_pid = getpid();
+            } else {
+                // Several clients can find the same stale slot. Only the one that replaces
+                // the PID of the exited client reclaims it, because the state may not change.
+                pid_t stale_pid = slot.client_pid;
+                bool stale = (state != graphmod_slot_submitted) && (stale_pid != 0) && (!process_exists(stale_pid));
+                if ((!stale) || (!slot.client_pid.compare_exchange_strong(stale_pid, getpid()))) {
+                    continue;
+                }
+                slot.state = graphmod_slot_claimed;
+            }
+            std::string requestname(std::string(graphmod_ring_segname)+'#'+std::to_string(i));
+            destroy_Graphmod_ring_objects(*segment, requestname); // anything left over by a previous client
+            return requestname;
+        }
+        return "";
+    }
+
+    void release(const std::string & requestname) {
+        int slotidx = graphmod_request_slot(requestname);
+        if ((slotidx < 0) || (!ring)) {
+            return;
+        }
+        Graphmod_ring_slot & slot = ring->slots[slotidx];
+        if (slot.state == graphmod_slot_submitted) {
+            return; // the server is still using it
+        }
+        destroy_Graphmod_ring_objects(*segment, requestname);
+        slot.client_pid = 0;
+        slot.state = graphmod_slot_free;
+    }
+};
+
+Graphmod_ring_client graphmod_ring_client;
+
+Graphmod_ring * create_Graphmod_ring(unsigned long ringsize) {
+    graphmemman.cache();
+    segment_memory_t * segment = graphmemman.allocate_and_activate_shared_memory(graphmod_ring_segname, ringsize);
+    graphmemman.uncache();
+    if (!segment) {
+        ERRRETURNNULL(__func__, "Unable to create Graph modification request ring segment");
+    }
+    return segment->construct<Graphmod_ring>("ring")(getpid());
+}
+
+/// Returns the request name of the oldest submitted request in the ring, or empty if there is none.
+std::string oldest_Graphmod_ring_request(Graphmod_ring & ring) {
+    int oldest = -1;
+    for (unsigned int i = 0; i < graphmod_ring_slots; ++i) {
+        if (ring.slots[i].state != graphmod_slot_submitted) {
+            continue;
+        }
+        if ((oldest < 0) || ((int32_t) (ring.slots[i].seq - ring.slots[oldest].seq) < 0)) {
+            oldest = i;
+        }
+    }
+    if (oldest < 0) {
+        return "";
+    }
+    return std::string(graphmod_ring_segname)+'#'+std::to_string(oldest);
+}
+
+std::string wait_Graphmod_ring_request(Graphmod_ring & ring, unsigned int timeout_ms) {
+    uint32_t submitted = ring.submitted;
+    std::string requestname(oldest_Graphmod_ring_request(ring));
+    if (!requestname.empty()) {
+        return requestname;
+    }
+    futex_wait(ring.submitted, submitted, timeout_ms);
+    return oldest_Graphmod_ring_request(ring);
+}
+
+void complete_Graphmod_ring_request(Graphmod_ring & ring, const std::string & requestname, bool success) {
+    int slotidx = graphmod_request_slot(requestname);
+    if (slotidx < 0) {
+        return;
+    }
+    ring.slots[slotidx].state = success ? graphmod_slot_results : graphmod_slot_error;
+    futex_wake(ring.slots[slotidx].state);
+}
+
+void close_Graphmod_ring(Graphmod_ring & ring) {
+    ring.server_pid = 0;
+}
+
+std::string graphmod_request_name(const std::string & segname) {
+    auto it = graphmod_ring_client.requests.find(segname);
+    if (it == graphmod_ring_client.requests.end()) {
+        return segname;
+    }
+    return it->second;
+}
+
+std::string submit_Graphmod_ring_request(const std::string & requestname) {
+    int slotidx = graphmod_request_slot(requestname);
+    if ((slotidx < 0) || (!graphmod_ring_client.ring)) {
+        return "";
+    }
+    Graphmod_ring & ring = *graphmod_ring_client.ring;
+    Graphmod_ring_slot & slot = ring.slots[slotidx];
+
+    slot.seq = ring.next_seq++;
+    slot.state = graphmod_slot_submitted;
+    ++ring.submitted;
+    futex_wake(ring.submitted);
+
+    VERYVERBOSEOUT("Submitted request "+requestname+" through the request ring.\n");
+    while (true) {
+        uint32_t state = slot.state;
+        if (state == graphmod_slot_results) {
+            return "RESULTS";
+        }
+        if (state == graphmod_slot_error) {
+            return "ERROR";
+        }
+        if (!graphmod_ring_client.available()) {
+            ADDERROR(__func__, "Server stopped while handling request "+requestname);
+            return "";
+        }
+        futex_wait(slot.state, graphmod_slot_submitted, 1000);
+    }
+}
+
+void release_Graphmod_ring_request(const std::string & requestname) {
+    graphmod_ring_client.release(requestname);
+    for (auto it = graphmod_ring_client.requests.begin(); it != graphmod_ring_client.requests.end(); ++it) {
+        if (it->second == requestname) {
+            graphmod_ring_client.requests.erase(it);
+            break;
+        }
+    }
+}
+
 /**
  * A client program uses this function to allocate new shared memory and to
  * construct an empty `Graph_modifications` object there. That objet is used
  * to communicate Graph modification requests to `fzserverpq`.
+ * 
+ * If `fzserverpq` provides the request ring then a slot in the ring is used
+ * instead of a new segment (see graphmod_request_name()).
  */
 Graph_modifications * allocate_Graph_modifications_in_shared_memory(std::string segname, unsigned long segsize) {
+    std::string requestname(graphmod_ring_client.claim(segsize));
+    if (!requestname.empty()) {
+        graphmemman.set_active(graphmod_ring_segname);
+        graphmod_ring_client.requests[segname] = requestname;
+        VERYVERBOSEOUT("Using request ring slot "+requestname+" for "+segname+".\n");
+        return graphmod_ring_client.segment->construct<Graph_modifications>(graphmod_object_name(requestname, "graphmod").c_str())();
+    }
+
     segment_memory_t * segment = graphmemman.allocate_and_activate_shared_memory(segname, segsize);
     if (!segment)
         return nullptr;
@@ -187,6 +454,13 @@ Graph_modifications * allocate_Graph_modifications_in_shared_memory(std::string
 }
 
 Graph_modifications * find_Graph_modifications_in_shared_memory(std::string segment_name) {
+    if (graphmod_request_slot(segment_name) >= 0) { // in the request ring, which stays mapped
+        if (!graphmemman.set_active(graphmod_request_segment(segment_name))) {
+            ERRRETURNNULL(__func__, "Request ring for "+segment_name+" is not mapped");
+        }
+        return graphmemman.get_segmem()->find<Graph_modifications>(graphmod_object_name(segment_name, "graphmod").c_str()).first;
+    }
+
     try {
         segment_memory_t * segment = new segment_memory_t(bi::open_only, segment_name.c_str()); // was bi::open_read_only
 
@@ -210,7 +484,7 @@ Graph_modifications * find_Graph_modifications_in_shared_memory(std::string segm
 
 /// See for example how this is used in fzserverpq.
 Graphmod_error * prepare_error_response(std::string segname, exit_status_code ecode, std::string errmsg) {
-    if (!graphmemman.set_active(segname)) {
+    if (!graphmemman.set_active(graphmod_request_segment(segname))) {
         ADDERROR(__func__, "Unable to activate segment "+segname+" for error message "+errmsg);
         return nullptr;
     }
@@ -221,7 +495,7 @@ Graphmod_error * prepare_error_response(std::string segname, exit_status_code ec
         return nullptr;
     }
 
-    Graphmod_error * graphmoderror_ptr = smem->construct<Graphmod_error>("error")(ecode, errmsg);
+    Graphmod_error * graphmoderror_ptr = smem->construct<Graphmod_error>(graphmod_object_name(segname, "error").c_str())(ecode, errmsg);
     if (!graphmoderror_ptr) {
         ADDERROR(__func__, "Unable to construct Graphmod_error object for error message "+errmsg);
         return nullptr;
@@ -232,17 +506,17 @@ Graphmod_error * prepare_error_response(std::string segname, exit_status_code ec
 
 /// See for example how this is used in fzgraph.
 Graphmod_error * find_error_response_in_shared_memory(std::string segment_name) {
-    if (!graphmemman.set_active(segment_name)) {
+    if (!graphmemman.set_active(graphmod_request_segment(segment_name))) {
         ADDERROR(__func__, "Shared segment "+segment_name+" not found");
         return nullptr;
     }
 
-    return graphmemman.get_segmem()->find<Graphmod_error>("error").first;
+    return graphmemman.get_segmem()->find<Graphmod_error>(graphmod_object_name(segment_name, "error").c_str()).first;
 }
 
 /// See for example how this is used in fzserverpq.
 Graphmod_results * initialized_results_response(std::string segname) {
-    if (!graphmemman.set_active(segname)) {
+    if (!graphmemman.set_active(graphmod_request_segment(segname))) {
         ADDERROR(__func__, "Unable to activate segment "+segname+" for results data");
         return nullptr;
     }
@@ -253,7 +527,7 @@ Graphmod_results * initialized_results_response(std::string segname) {
         return nullptr;
     }
 
-    Graphmod_results * graphmodresults_ptr = smem->construct<Graphmod_results>("results")(segname);
+    Graphmod_results * graphmodresults_ptr = smem->construct<Graphmod_results>(graphmod_object_name(segname, "results").c_str())(graphmod_request_segment(segname));
     if (!graphmodresults_ptr) {
         ADDERROR(__func__, "Unable to construct Graphmod_results object for results data");
         return nullptr;
@@ -264,12 +538,12 @@ Graphmod_results * initialized_results_response(std::string segname) {
 
 /// See for example how this is used in fzgraph.
 Graphmod_results * find_results_response_in_shared_memory(std::string segment_name) {
-    if (!graphmemman.set_active(segment_name)) {
+    if (!graphmemman.set_active(graphmod_request_segment(segment_name))) {
         ADDERROR(__func__, "Unable to activate segment "+segment_name+" for results data");
         return nullptr;
     }
 
-    return graphmemman.get_segmem()->find<Graphmod_results>("results").first;
+    return graphmemman.get_segmem()->find<Graphmod_results>(graphmod_object_name(segment_name, "results").c_str()).first;
 }
 
 /// Create a Node in the Graph's shared segment and add it to the Graph.
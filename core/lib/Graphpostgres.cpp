@@ -94,6 +94,43 @@ std::string pq_NNLlayout(
     "nodeids char(16)[]"
 );
 
+const std::string pq_topic_fieldnames[_pqt_NUM] = {"id",
+                                                   "supid",
+                                                   "tag",
+                                                   "title",
+                                                   "keyword",
+                                                   "relevance"};
+const std::string pq_node_fieldnames[_pqn_NUM] = {"id",
+                                                  "topics",
+                                                  "topicrelevance",
+                                                  "valuation",
+                                                  "completion",
+                                                  "required",
+                                                  "text",
+                                                  "targetdate",
+                                                  "tdproperty",
+                                                  "isperiodic",
+                                                  "tdperiodic",
+                                                  "tdevery",
+                                                  "tdspan"};
+const std::string pq_edge_fieldnames[_pqe_NUM] = {"id",
+                                                  "dependency",
+                                                  "significance",
+                                                  "importance",
+                                                  "urgency",
+                                                  "priority"};
+unsigned int pq_topic_field[_pqt_NUM];
+
+/// Return the comma separated list of field names, e.g. for column lists in COPY commands.
+std::string pq_fieldnames_csv(const std::string * fieldnames, int num) {
+    std::string csv;
+    for (int i = 0; i < num; ++i) {
+        if (i > 0) csv += ',';
+        csv += fieldnames[i];
+    }
+    return csv;
+}
+
 /**
  * Create enumerated types in database for Node and Edge data.
  * 
@@ -199,6 +236,10 @@ bool remove_Edge_pq(PGconn *conn, std::string schemaname, const Edge_ID_key & id
 /**
  * Store all the Nodes and Edges of the Graph in the PostgreSQL database.
  * 
+ * Topics, Nodes and Edges are each sent with a single `COPY ... FROM STDIN`
+ * (see Copy_in_pq), so that the number of round-trips does not grow with
+ * the size of the Graph.
+ * 
  * @param graph a Graph containing all of the Nodes and Edges.
  * @param dbname database name.
  * @param schemaname Formalizer schema name (usually Graph_access::pq_schemaname)
@@ -211,7 +252,9 @@ bool store_Graph_pq(const Graph& graph, std::string dbname, std::string schemana
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define STORE_GRAPH_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define STORE_GRAPH_PQ_RETURN(r) { connection_release_pq(conn); return r; }
+    // Within a COPY scope, end the COPY before the connection is released.
+    #define STORE_GRAPH_COPY_FAILED(copy) { copy.abort(); STORE_GRAPH_PQ_RETURN(false); }
 
     ERRHERE(".schema");
     if (!create_Formalizer_schema_pq(conn, schemaname)) STORE_GRAPH_PQ_RETURN(false);
@@ -225,10 +268,20 @@ bool store_Graph_pq(const Graph& graph, std::string dbname, std::string schemana
     ERRHERE(".topics");
     unsigned long n = graph.get_topics().get_topictags().size();
     unsigned long ncount = 0;
-    for (auto topic = graph.get_topics().get_topictags().begin(); topic != graph.get_topics().get_topictags().end(); ++topic) {
-        if (!add_Topic_pq(conn, schemaname,topic->get())) STORE_GRAPH_PQ_RETURN(false);
-        ncount++;
-        if (progress_func) (*progress_func)(n,ncount);
+    {
+        Copy_in_pq topicscopy(conn, "COPY "+schemaname+".Topics ("+pq_fieldnames_csv(pq_topic_fieldnames, _pqt_NUM)+") FROM STDIN");
+        if (!topicscopy.ok()) STORE_GRAPH_COPY_FAILED(topicscopy);
+        for (auto topic = graph.get_topics().get_topictags().begin(); topic != graph.get_topics().get_topictags().end(); ++topic) {
+            if (!topic->get()) {
+                ADDERROR(__func__, "unable to add a NULL Topic");
+                STORE_GRAPH_COPY_FAILED(topicscopy);
+            }
+            Topic_pq tpq(topic->get());
+            if (!topicscopy.put_row(tpq.All_Topic_Data_copystr())) STORE_GRAPH_COPY_FAILED(topicscopy);
+            ncount++;
+            if (progress_func) (*progress_func)(n,ncount);
+        }
+        if (!topicscopy.finish()) STORE_GRAPH_COPY_FAILED(topicscopy);
     }
 
     ERRHERE(".nodestable");
@@ -237,10 +290,16 @@ bool store_Graph_pq(const Graph& graph, std::string dbname, std::string schemana
     ERRHERE(".nodes");
     n = graph.num_Nodes();
     ncount = 0;
-    for (auto node = graph.begin_Nodes(); node != graph.end_Nodes(); ++node) {
-        if (!add_Node_pq(conn, schemaname,node->second.get())) STORE_GRAPH_PQ_RETURN(false);
-        ncount++;
-        if (progress_func) (*progress_func)(n,ncount);
+    {
+        Copy_in_pq nodescopy(conn, "COPY "+schemaname+".Nodes ("+pq_fieldnames_csv(pq_node_fieldnames, _pqn_NUM)+") FROM STDIN");
+        if (!nodescopy.ok()) STORE_GRAPH_COPY_FAILED(nodescopy);
+        for (auto node = graph.begin_Nodes(); node != graph.end_Nodes(); ++node) {
+            Node_pq npq(node->second.get());
+            if (!nodescopy.put_row(npq.All_Node_Data_copystr())) STORE_GRAPH_COPY_FAILED(nodescopy);
+            ncount++;
+            if (progress_func) (*progress_func)(n,ncount);
+        }
+        if (!nodescopy.finish()) STORE_GRAPH_COPY_FAILED(nodescopy);
     }
 
     ERRHERE(".edgestable");
@@ -249,18 +308,122 @@ bool store_Graph_pq(const Graph& graph, std::string dbname, std::string schemana
     ERRHERE(".edges");
     n = graph.num_Edges();
     ncount = 0;
-    for (auto edge = graph.begin_Edges(); edge != graph.end_Edges(); ++edge) {
-        if (!add_Edge_pq(conn, schemaname,edge->second.get())) STORE_GRAPH_PQ_RETURN(false);
-        ncount++;
-        if (progress_func) (*progress_func)(n,ncount);
+    {
+        Copy_in_pq edgescopy(conn, "COPY "+schemaname+".Edges ("+pq_fieldnames_csv(pq_edge_fieldnames, _pqe_NUM)+") FROM STDIN");
+        if (!edgescopy.ok()) STORE_GRAPH_COPY_FAILED(edgescopy);
+        for (auto edge = graph.begin_Edges(); edge != graph.end_Edges(); ++edge) {
+            Edge_pq epq(edge->second.get());
+            if (!edgescopy.put_row(epq.All_Edge_Data_copystr())) STORE_GRAPH_COPY_FAILED(edgescopy);
+            ncount++;
+            if (progress_func) (*progress_func)(n,ncount);
+        }
+        if (!edgescopy.finish()) STORE_GRAPH_COPY_FAILED(edgescopy);
     }
 
     //*** Make an inventory of what other bits of information need a corresponding version in the
     //*** database format, e.g. possibly caches of up and down edges lists, etc.
 
+    ERRHERE(".changestamp");
+    if (!install_Graph_change_stamp_pq(conn, schemaname)) STORE_GRAPH_PQ_RETURN(false);
+
     STORE_GRAPH_PQ_RETURN(true);
 }
 
+/**
+ * Make sure that every change to the Graph tables advances a change stamp.
+ * 
+ * The stamp is kept in the single-row GraphChanges table and is advanced
+ * by a statement-level trigger on the Topics, Nodes, Edges and
+ * NamedNodeLists tables, so that it also catches changes made by tools
+ * other than fzserverpq. A Graph snapshot is only valid while the stamp
+ * is unchanged (see graph_mem_managers::restore_Graph_snapshot()). The
+ * stamp starts at a time-based value, so that stamps from different
+ * databases or schemas are very unlikely to coincide.
+ * 
+ * The `external` count advances only for changes made by connections
+ * that are not identified as PQ_SERVER_APPLICATION_NAME. A server can
+ * compare it with the count at load time to find out if the database
+ * changed for any reason other than its own writes.
+ * 
+ * This is idempotent and only adds triggers to existing tables that
+ * do not have one yet.
+ * 
+ * @param conn active database connection.
+ * @param schemaname Formalizer schema name (usually Graph_access::pq_schemaname)
+ * @return true if the change stamp is in place.
+ */
+bool install_Graph_change_stamp_pq(PGconn* conn, std::string schemaname) {
+    ERRTRACE;
+    std::string stamptable(schemaname+".GraphChanges");
+    std::string stampfunction(schemaname+".advance_graphchanges()");
+
+    std::string installstr("CREATE TABLE IF NOT EXISTS "+stamptable+" (id smallint PRIMARY KEY, stamp bigint);"
+        "ALTER TABLE "+stamptable+" ADD COLUMN IF NOT EXISTS external bigint NOT NULL DEFAULT 0;"
+        "INSERT INTO "+stamptable+" VALUES (0, (extract(epoch FROM clock_timestamp())*1000000)::bigint) ON CONFLICT DO NOTHING;"
+        "CREATE OR REPLACE FUNCTION "+stampfunction+" RETURNS trigger LANGUAGE plpgsql AS $fn$ BEGIN "
+            "UPDATE "+stamptable+" SET stamp = stamp + 1, external = external + "
+                "(CASE WHEN current_setting('application_name') = '" PQ_SERVER_APPLICATION_NAME "' THEN 0 ELSE 1 END) "
+            "WHERE id = 0; RETURN NULL; END $fn$;"
+        "DO $do$ DECLARE t text; BEGIN "
+            "FOREACH t IN ARRAY ARRAY['topics','nodes','edges','namednodelists'] LOOP "
+                "IF (to_regclass('"+schemaname+".'||t) IS NOT NULL) AND NOT EXISTS (SELECT 1 FROM pg_catalog.pg_trigger "
+                    "WHERE tgname = 'graphchanges_advance' AND tgrelid = to_regclass('"+schemaname+".'||t)) THEN "
+                    "EXECUTE 'CREATE TRIGGER graphchanges_advance AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON "+schemaname+".'||t"
+                        "||' FOR EACH STATEMENT EXECUTE PROCEDURE "+stampfunction+"'; "
+                "END IF; "
+            "END LOOP; "
+        "END $do$");
+    return simple_call_pq(conn, installstr);
+}
+
+/**
+ * Read the Graph change stamp (see install_Graph_change_stamp_pq()).
+ * 
+ * @param conn active database connection.
+ * @param schemaname Formalizer schema name (usually Graph_access::pq_schemaname)
+ * @param stamp receives the change stamp.
+ * @param external if not nullptr, receives the count of changes not made by the server.
+ * @return true if the stamp was read.
+ */
+bool read_Graph_change_stamp_pq(PGconn* conn, std::string schemaname, int64_t & stamp, int64_t * external) {
+    ERRTRACE;
+    if (!query_call_pq(conn, "SELECT stamp, external FROM "+schemaname+".GraphChanges WHERE id = 0", false)) return false;
+
+    bool found = false;
+    PGresult *res;
+    while ((res = PQgetResult(conn))) {
+        if ((PQresultStatus(res) == PGRES_TUPLES_OK) && (PQntuples(res) > 0)) {
+            stamp = std::strtoll(PQgetvalue(res, 0, 0), nullptr, 10);
+            if (external) {
+                *external = std::strtoll(PQgetvalue(res, 0, 1), nullptr, 10);
+            }
+            found = true;
+        }
+        PQclear(res);
+    }
+    return found;
+}
+
+/**
+ * Direct interface that sets up the database connection, makes sure the
+ * Graph change stamp is in place and reads it.
+ * 
+ * @param dbname database name.
+ * @param schemaname Formalizer schema name (usually Graph_access::pq_schemaname)
+ * @param stamp receives the change stamp.
+ * @param external if not nullptr, receives the count of changes not made by the server.
+ * @return true if the stamp was read.
+ */
+bool Graph_change_stamp_pq(std::string dbname, std::string schemaname, int64_t & stamp, int64_t * external) {
+    ERRTRACE;
+    PGconn* conn = connection_setup_pq(dbname);
+    if (!conn) return false;
+
+    bool res = install_Graph_change_stamp_pq(conn, schemaname) && read_Graph_change_stamp_pq(conn, schemaname, stamp, external);
+    connection_release_pq(conn);
+    return res;
+}
+
 struct NNLmod_update {
     Named_List_String list_name;
     bool modified; ///< modified or deleted
@@ -466,12 +629,12 @@ bool handle_Graph_modifications_pq(Graph & graph, std::string dbname, std::strin
     for (const auto & change_data : modifications.results) { // change_data is of type Graphmod_result.
 
         if (!handle_one_modification_pq(graph, conn, schemaname, nnlupdates, change_data)) {
-            PQfinish(conn); return false;
+            connection_release_pq(conn); return false;
         }
 
     }
 
-    PQfinish(conn);
+    connection_release_pq(conn);
 
     // Here we deal with the Named Node List modification synchronizations
     if (graph.persistent_Lists()) {
@@ -527,13 +690,13 @@ bool handle_Graph_modifications_unshared_pq(Graph & graph, std::string dbname, s
     for (const auto & change_data : modifications.results) { // change_data is of type Graphmod_result.
 
         if (!handle_one_modification_pq(graph, conn, schemaname, nnlupdates, change_data)) {
-            PQfinish(conn);
+            connection_release_pq(conn);
             ERRRETURNFALSE(__func__, "Failed database modification for "+Graph_modification_request_str.at(change_data.request_handled));
         }
 
     }
 
-    PQfinish(conn);
+    connection_release_pq(conn);
 
     // Here we deal with the Named Node List modification synchronizations
     if (graph.persistent_Lists()) {
@@ -553,34 +716,6 @@ bool handle_Graph_modifications_unshared_pq(Graph & graph, std::string dbname, s
     return true;
 }
 
-const std::string pq_topic_fieldnames[_pqt_NUM] = {"id",
-                                                   "supid",
-                                                   "tag",
-                                                   "title",
-                                                   "keyword",
-                                                   "relevance"};
-const std::string pq_node_fieldnames[_pqn_NUM] = {"id",
-                                                  "topics",
-                                                  "topicrelevance",
-                                                  "valuation",
-                                                  "completion",
-                                                  "required",
-                                                  "text",
-                                                  "targetdate",
-                                                  "tdproperty",
-                                                  "isperiodic",
-                                                  "tdperiodic",
-                                                  "tdevery",
-                                                  "tdspan"};
-const std::string pq_edge_fieldnames[_pqe_NUM] = {"id",
-                                                  "dependency",
-                                                  "significance",
-                                                  "importance",
-                                                  "urgency",
-                                                  "priority"};
-unsigned int pq_topic_field[_pqt_NUM];
-unsigned int pq_node_field[_pqn_NUM];
-unsigned int pq_edge_field[_pqe_NUM];
 
 /**
  * Retrieve field column numbers for topics query to make sure the
@@ -606,28 +741,6 @@ bool get_Topic_pq_field_numbers(PGresult *res) {
     return true;
 }
 
-bool get_Node_pq_field_numbers(PGresult *res) {
-    if (!res) return false;
-
-    for (auto i = 0; i<_pqn_NUM; i++) {
-        if ((pq_node_field[i] = PQfnumber(res,pq_node_fieldnames[i].c_str())) < 0) {
-            ERRRETURNFALSE(__func__,"field '"+pq_node_fieldnames[i]+"' not found in database nodes table");
-        }
-    }
-    return true;
-}
-
-bool get_Edge_pq_field_numbers(PGresult *res) {
-    if (!res) return false;
-
-    for (auto i = 0; i<_pqe_NUM; i++) {
-        if ((pq_edge_field[i] = PQfnumber(res,pq_edge_fieldnames[i].c_str())) < 0) {
-            ERRRETURNFALSE(__func__,"field '"+pq_edge_fieldnames[i]+"' not found in database edges table");
-        }
-    }
-    return true;
-}
-
 /**
  * Convert textual arrays of keywords and keyword-relevance values
  * to a vector of Topic_Keyword pairs.
@@ -700,194 +813,206 @@ bool read_Topics_pq(PGconn* conn, std::string schemaname, Topic_Tags & topictags
     return true;
 }
 
-bool node_topics_from_pq(Node & node, std::string topicsstr, std::string topicrelevancestr) {
-    auto tvec = array_from_pq(topicsstr);
-    auto trvec = array_from_pq(topicrelevancestr);
+/**
+ * Checks and flag updates applied to every Node loaded from the database.
+ * 
+ * @param node A Node with all parameters loaded.
+ */
+void finalize_loaded_Node_pq(Node & node) {
+#ifdef DOUBLE_CHECK_INHERIT
+    // double checking unexpected (non-protocol) circumstances, variable/fixed/exact with negative targetdate
+    if (node.get_targetdate() < 0) { // no local specification
+        switch (node.get_tdproperty()) {
+            case td_property::fixed: {
+                node.set_tdproperty(td_property::inherit);
+                standard_warning("Interpreting Node "+node.get_id_str()+" stored 'fixed+unspecified' as 'tdproperty=inherit'.", __func__);
+                break;
+            }
+            case td_property::exact: { // Warning: This one should never happen!
+                node.set_tdproperty(td_property::unspecified);
+                standard_error("Interpreting Node "+node.get_id_str()+" stored 'exact+unspecified' as 'tdproperty=unspecified'.", __func__);
+                break;
+            }
+            case td_property::variable: {
+                node.set_tdproperty(td_property::unspecified);
+                standard_warning("Interpreting Node "+node.get_id_str()+" stored 'fixed+unspecified' as 'tdproperty=unspecified'.", __func__);
+                break;
+            }
+            default: { // tdproperty is inherit or unspecified
+                // keep as loaded
+            }
 
-    if (tvec.size()!=trvec.size()) {
-        //ERRRETURNFALSE
-        ADDERROR(__func__,"number of topics ("+std::to_string(tvec.size())+") does not match number of topic relevance values ("+std::to_string(trvec.size())+") for Node ["+node.get_id().str()+']');
-    }
-    long unsigned int min_size = tvec.size();
-    if (min_size > trvec.size()) {
-        min_size = trvec.size();
+        }
     }
+#endif
+#ifdef ADD_TAG_FLAGS
+    node.refresh_boolean_tag_flags();
+#endif
+}
 
-    for (long unsigned int i = 0; i < min_size; ++i) {
-        node.add_topic(atoi(tvec[i].c_str()),std::stof(trvec[i])); // ** maybe try-catch std::stoi instead
+/**
+ * Parse the text form of a Postgres numerical array, e.g. "{1,2,3}", calling
+ * `elem_func` with a pointer to the start of each element.
+ */
+template <typename F>
+void parse_copy_array_pq(const char * arraystr, F elem_func) {
+    if (!arraystr) return;
+    if (*arraystr == '{') ++arraystr;
+    while ((*arraystr != '\0') && (*arraystr != '}')) {
+        elem_func(arraystr);
+        while ((*arraystr != '\0') && (*arraystr != ',') && (*arraystr != '}')) ++arraystr;
+        if (*arraystr == ',') ++arraystr;
     }
-
-    return true;
 }
 
-const std::map<std::string, td_property> tdprop_by_pqtdprop = {{"unspecified", td_property::unspecified},
-                                                               {"inherit", td_property::inherit},
-                                                               {"variable", td_property::variable},
-                                                               {"fixed", td_property::fixed},
-                                                               {"exact", td_property::exact}};
+bool node_topics_from_copy_pq(Node & node, const char * topicsstr, const char * topicrelevancestr) {
+    std::vector<int> topics;
+    std::vector<float> relevances;
+    parse_copy_array_pq(topicsstr, [&topics](const char * elem) { topics.emplace_back(std::strtol(elem, nullptr, 10)); });
+    parse_copy_array_pq(topicrelevancestr, [&relevances](const char * elem) { relevances.emplace_back(std::strtof(elem, nullptr)); });
 
-const std::map<std::string, td_pattern> tdpatt_by_pqtdpatt = {{"patt_daily",td_pattern::patt_daily},
-                                                              {"patt_workdays",td_pattern::patt_workdays},
-                                                              {"patt_weekly",td_pattern::patt_weekly},
-                                                              {"patt_biweekly",td_pattern::patt_biweekly},
-                                                              {"patt_monthly",td_pattern::patt_monthly},
-                                                              {"patt_endofmonthoffset",td_pattern::patt_endofmonthoffset},
-                                                              {"patt_yearly",td_pattern::patt_yearly},
-                                                              {"OLD_patt_span",td_pattern::OLD_patt_span},
-                                                              {"patt_nonperiodic",td_pattern::patt_nonperiodic}};
+    if (topics.size()!=relevances.size()) {
+        ADDERROR(__func__,"number of topics ("+std::to_string(topics.size())+") does not match number of topic relevance values ("+std::to_string(relevances.size())+") for Node ["+node.get_id().str()+']');
+    }
+    size_t min_size = std::min(topics.size(), relevances.size());
 
-td_property tdproperty_from_pq(std::string pqtdproperty) {
-    try {
-        td_property tdprop = tdprop_by_pqtdprop.at(pqtdproperty);
-        return tdprop;
-    } catch (const std::out_of_range& oor) {
-        ADDERROR(__func__,"tdprop_by_pqtdprop key out of range: "+std::string(oor.what()));
-        return td_property::unspecified;
+    for (size_t i = 0; i < min_size; ++i) {
+        node.add_topic(topics[i], relevances[i]);
     }
+
+    return true;
 }
 
-td_pattern tdpattern_from_pq(std::string pqtdpattern) {
-    try {
-        td_pattern tdpatt = tdpatt_by_pqtdpatt.at(pqtdpattern);
-        return tdpatt;
-    } catch (const std::out_of_range& oor) {
-        ADDERROR(__func__,"tdpatt_by_pqtdpatt key out of range: "+std::string(oor.what()));
-        return td_pattern::patt_nonperiodic;
+td_property tdproperty_from_copy_pq(const char * pqtdproperty) {
+    if (pqtdproperty) {
+        for (int i = 0; i < _tdprop_num; ++i) {
+            if (td_property_str[i] == pqtdproperty) {
+                return (td_property) i;
+            }
+        }
     }
+    ADDERROR(__func__,"unknown td_property: "+std::string(pqtdproperty ? pqtdproperty : "NULL"));
+    return td_property::unspecified;
 }
 
-bool read_Nodes_pq(PGconn* conn, std::string schemaname, Graph & graph) {
-    if (!query_call_pq(conn,"SELECT * FROM "+schemaname+".nodes ORDER BY "+pq_node_fieldnames[pqn_id],false)) return false;
-
-    //sample_query_data(conn,0,4,0,100,tmpout);
-  
-    PGresult *res;
-
-    while ((res = PQgetResult(conn))) { // It's good to use a loop for single row mode cases.
-
-        const int rows = PQntuples(res);
-        if (PQnfields(res)<_pqn_NUM) ERRRETURNFALSE(__func__,"not enough fields in nodes table");
-
-        if (!get_Node_pq_field_numbers(res)) return false;
-
-        for (int r = 0; r < rows; ++r) {
-
-            std::string id = PQgetvalue(res, r, pq_node_field[pqn_id]);
-            try {
-                Node * node = graph.create_and_add_Node(id); // After this, the "graph" pointer within node is also valid.
-                if (!node) {
-                    if (graph.error == Graph::g_adddupnode) {
-                        ERRRETURNFALSE(__func__,"duplicate Node ["+id+']');
-                    } else {
-                        ERRRETURNFALSE(__func__,"unknown error while attempting to add Node");
-                    }                    
-                }
-
-                if (!node_topics_from_pq(*node,PQgetvalue(res, r, pq_node_field[pqn_topics]),PQgetvalue(res, r, pq_node_field[pqn_topicrelevance]))) {
-                    return false;
-                }
-
-                node->set_valuation(std::stof(PQgetvalue(res, r, pq_node_field[pqn_valuation])));
-                node->set_completion(std::stof(PQgetvalue(res, r, pq_node_field[pqn_completion])));
-                node->set_required(atoi(PQgetvalue(res, r, pq_node_field[pqn_required])));
-                node->set_text_unchecked(PQgetvalue(res, r, pq_node_field[pqn_text]));
-                node->set_targetdate(epochtime_from_timestamp_pq(PQgetvalue(res, r, pq_node_field[pqn_targetdate])));
-                node->set_tdproperty(tdproperty_from_pq(PQgetvalue(res, r, pq_node_field[pqn_tdproperty])));
-                node->set_repeats(PQgetvalue(res, r, pq_node_field[pqn_isperiodic])[0]=='t');
-                node->set_tdpattern(tdpattern_from_pq(PQgetvalue(res, r, pq_node_field[pqn_tdperiodic])));
-                node->set_tdevery(atoi(PQgetvalue(res, r, pq_node_field[pqn_tdevery])));
-                node->set_tdspan(atoi(PQgetvalue(res, r, pq_node_field[pqn_tdspan])));
-#ifdef DOUBLE_CHECK_INHERIT
-                // double checking unexpected (non-protocol) circumstances, variable/fixed/exact with negative targetdate
-                if (node->get_targetdate() < 0) { // no local specification
-                    switch (node->get_tdproperty()) {
-                        case td_property::fixed: {
-                            node->set_tdproperty(td_property::inherit);
-                            standard_warning("Interpreting Node "+node->get_id_str()+" stored 'fixed+unspecified' as 'tdproperty=inherit'.", __func__);
-                            break;
-                        }
-                        case td_property::exact: { // Warning: This one should never happen!
-                            node->set_tdproperty(td_property::unspecified);
-                            standard_error("Interpreting Node "+node->get_id_str()+" stored 'exact+unspecified' as 'tdproperty=unspecified'.", __func__);
-                            break;
-                        }
-                        case td_property::variable: {
-                            node->set_tdproperty(td_property::unspecified);
-                            standard_warning("Interpreting Node "+node->get_id_str()+" stored 'fixed+unspecified' as 'tdproperty=unspecified'.", __func__);
-                            break;
-                        }
-                        default: { // tdproperty is inherit or unspecified
-                            // keep as loaded
-                        }
-
-                    }
-                }
-#endif
-#ifdef ADD_TAG_FLAGS
-                node->refresh_boolean_tag_flags();
-#endif
-
-            } catch (ID_exception idexception) {
-                ERRRETURNFALSE(__func__,"Invalid Node ID ["+id+"], "+idexception.what());
+td_pattern tdpattern_from_copy_pq(const char * pqtdpattern) {
+    if (pqtdpattern) {
+        for (int i = 0; i < _patt_num; ++i) {
+            if (td_pattern_str[i] == pqtdpattern) {
+                return (td_pattern) i;
             }
-
         }
-
-        PQclear(res);
     }
-
-    return true;
+    ADDERROR(__func__,"unknown td_pattern: "+std::string(pqtdpattern ? pqtdpattern : "NULL"));
+    return td_pattern::patt_nonperiodic;
 }
 
-bool read_Edges_pq(PGconn* conn, std::string schemaname, Graph & graph) {
-    if (!query_call_pq(conn,"SELECT * FROM "+schemaname+".edges ORDER BY "+pq_edge_fieldnames[pqe_id],false)) return false;
-
-    //sample_query_data(conn,0,4,0,100,tmpout);
-
-    PGresult *res;
-
-    while ((res = PQgetResult(conn))) { // It's good to use a loop for single row mode cases.
-
-        const int rows = PQntuples(res);
-        if (PQnfields(res)<_pqe_NUM) ERRRETURNFALSE(__func__,"not enough fields in edges table");
-
-        if (!get_Edge_pq_field_numbers(res)) return false;
+inline float float_from_copy_pq(const char * fieldstr) {
+    return fieldstr ? std::strtof(fieldstr, nullptr) : 0.0;
+}
 
-        for (int r = 0; r < rows; ++r) {
+inline long long_from_copy_pq(const char * fieldstr) {
+    return fieldstr ? std::strtol(fieldstr, nullptr, 10) : 0;
+}
 
-            std::string id = PQgetvalue(res, r, pq_edge_field[pqe_id]);
-            try {
-                Edge * edge = graph.create_and_add_Edge(id);
-                if (!edge) {
-                    if (graph.error == Graph::g_adddupedge) {
-                        ERRRETURNFALSE(__func__,"duplicate Edge ["+id+']');
-                    } else {
-                        ERRRETURNFALSE(__func__,"unknown error while attempting to add Edge");
-                    }                    
+/**
+ * Load all Nodes with a single `COPY ... TO STDOUT` in text format.
+ * 
+ * Each row is split and parsed in place (see copy_fields_pq()), which
+ * avoids a PGresult holding the whole table and per-field std::string
+ * conversions.
+ * 
+ * @param conn active database connection.
+ * @param schemaname Formalizer schema name (usually Graph_access::pq_schemaname)
+ * @param graph the Graph to which the Nodes are added.
+ * @return true if all Nodes were loaded successfully.
+ */
+bool copy_Nodes_from_pq(PGconn* conn, std::string schemaname, Graph & graph) {
+    std::string copycmd("COPY (SELECT "+pq_fieldnames_csv(pq_node_fieldnames, _pqn_NUM)+" FROM "+schemaname+".nodes ORDER BY "+pq_node_fieldnames[pqn_id]+") TO STDOUT");
+
+    return copy_to_stdout_pq(conn, copycmd, [&graph](char * row, int len) -> bool {
+        char * f[_pqn_NUM];
+        if (copy_fields_pq(row, len, f, _pqn_NUM) < _pqn_NUM) ERRRETURNFALSE("copy_Nodes_from_pq","not enough fields in nodes table row");
+        if (!f[pqn_id]) ERRRETURNFALSE("copy_Nodes_from_pq","Node without ID in nodes table");
+
+        try {
+            Node * node = graph.create_and_add_Node(f[pqn_id]); // After this, the "graph" pointer within node is also valid.
+            if (!node) {
+                if (graph.error == Graph::g_adddupnode) {
+                    ERRRETURNFALSE("copy_Nodes_from_pq","duplicate Node ["+std::string(f[pqn_id])+']');
+                } else {
+                    ERRRETURNFALSE("copy_Nodes_from_pq","unknown error while attempting to add Node");
                 }
+            }
 
-                edge->set_dependency(std::stof(PQgetvalue(res, r, pq_edge_field[pqe_dependency])));
-                edge->set_importance(std::stof(PQgetvalue(res, r, pq_edge_field[pqe_importance])));
-                edge->set_priority(std::stof(PQgetvalue(res, r, pq_edge_field[pqe_priority])));
-                edge->set_significance(std::stof(PQgetvalue(res, r, pq_edge_field[pqe_significance])));
-                edge->set_urgency(std::stof(PQgetvalue(res, r, pq_edge_field[pqe_urgency])));
-
-            } catch (ID_exception idexception) {
-                ERRRETURNFALSE(__func__,"Invalid Edge ID ["+id+"], "+idexception.what());
+            if (!node_topics_from_copy_pq(*node, f[pqn_topics], f[pqn_topicrelevance])) {
+                return false;
             }
 
+            node->set_valuation(float_from_copy_pq(f[pqn_valuation]));
+            node->set_completion(float_from_copy_pq(f[pqn_completion]));
+            node->set_required(long_from_copy_pq(f[pqn_required]));
+            node->set_text_unchecked(f[pqn_text] ? f[pqn_text] : "");
+            node->set_targetdate(epochtime_from_timestamp_pq(f[pqn_targetdate]));
+            node->set_tdproperty(tdproperty_from_copy_pq(f[pqn_tdproperty]));
+            node->set_repeats(f[pqn_isperiodic] && (f[pqn_isperiodic][0]=='t'));
+            node->set_tdpattern(tdpattern_from_copy_pq(f[pqn_tdperiodic]));
+            node->set_tdevery(long_from_copy_pq(f[pqn_tdevery]));
+            node->set_tdspan(long_from_copy_pq(f[pqn_tdspan]));
+            finalize_loaded_Node_pq(*node);
+
+        } catch (ID_exception idexception) {
+            ERRRETURNFALSE("copy_Nodes_from_pq","Invalid Node ID ["+std::string(f[pqn_id])+"], "+idexception.what());
         }
+        return true;
+    });
+}
 
-        PQclear(res);
-    }
+/**
+ * Load all Edges with a single `COPY ... TO STDOUT` in text format.
+ * 
+ * @param conn active database connection.
+ * @param schemaname Formalizer schema name (usually Graph_access::pq_schemaname)
+ * @param graph the Graph to which the Edges are added (Nodes must already be loaded).
+ * @return true if all Edges were loaded successfully.
+ */
+bool copy_Edges_from_pq(PGconn* conn, std::string schemaname, Graph & graph) {
+    std::string copycmd("COPY (SELECT "+pq_fieldnames_csv(pq_edge_fieldnames, _pqe_NUM)+" FROM "+schemaname+".edges ORDER BY "+pq_edge_fieldnames[pqe_id]+") TO STDOUT");
+
+    return copy_to_stdout_pq(conn, copycmd, [&graph](char * row, int len) -> bool {
+        char * f[_pqe_NUM];
+        if (copy_fields_pq(row, len, f, _pqe_NUM) < _pqe_NUM) ERRRETURNFALSE("copy_Edges_from_pq","not enough fields in edges table row");
+        if (!f[pqe_id]) ERRRETURNFALSE("copy_Edges_from_pq","Edge without ID in edges table");
+
+        try {
+            Edge * edge = graph.create_and_add_Edge(f[pqe_id]);
+            if (!edge) {
+                if (graph.error == Graph::g_adddupedge) {
+                    ERRRETURNFALSE("copy_Edges_from_pq","duplicate Edge ["+std::string(f[pqe_id])+']');
+                } else {
+                    ERRRETURNFALSE("copy_Edges_from_pq","unknown error while attempting to add Edge");
+                }
+            }
 
+            edge->set_dependency(float_from_copy_pq(f[pqe_dependency]));
+            edge->set_importance(float_from_copy_pq(f[pqe_importance]));
+            edge->set_priority(float_from_copy_pq(f[pqe_priority]));
+            edge->set_significance(float_from_copy_pq(f[pqe_significance]));
+            edge->set_urgency(float_from_copy_pq(f[pqe_urgency]));
 
-    return true;
+        } catch (ID_exception idexception) {
+            ERRRETURNFALSE("copy_Edges_from_pq","Invalid Edge ID ["+std::string(f[pqe_id])+"], "+idexception.what());
+        }
+        return true;
+    });
 }
 
 /**
  * Load all the Nodes, Edges and Topics of the Graph from the PostgreSQL database.
  * 
+ * Nodes and Edges are received in bulk with `COPY ... TO STDOUT`. The few
+ * Topics are read with a regular query.
+ * 
  * Note: If the `graph` is initialized with `persistent_NNL == true` then
  *       this will also call `load_Named_Node_Lists_pq()`. See for example how
  *       this is used in `Graphaccess::request_Graph_copy()`.
@@ -904,7 +1029,7 @@ bool load_Graph_pq(Graph& graph, std::string dbname, std::string schemaname) {
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_GRAPH_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define LOAD_GRAPH_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     VERYVERBOSEOUT("Loading Graph (Nodes, Edges, Topics).\n");
     ERRHERE(".topics");
@@ -912,12 +1037,12 @@ bool load_Graph_pq(Graph& graph, std::string dbname, std::string schemaname) {
     if (!read_Topics_pq(conn,schemaname, *Ttags)) LOAD_GRAPH_PQ_RETURN(false);
 
     ERRHERE(".nodes");
-    if (!read_Nodes_pq(conn,schemaname, graph)) LOAD_GRAPH_PQ_RETURN(false);
+    if (!copy_Nodes_from_pq(conn,schemaname, graph)) LOAD_GRAPH_PQ_RETURN(false);
 
     ERRHERE(".edges");
-    if (!read_Edges_pq(conn,schemaname, graph)) LOAD_GRAPH_PQ_RETURN(false);
+    if (!copy_Edges_from_pq(conn,schemaname, graph)) LOAD_GRAPH_PQ_RETURN(false);
 
-    PQfinish(conn);
+    connection_release_pq(conn);
 
     if (graph.persistent_Lists()) {
         VERYVERBOSEOUT("Loading Named Node Lists cache.\n");
@@ -958,7 +1083,7 @@ std::vector<std::string> load_Node_parameter_interval(std::string dbname, std::s
     if (!conn) return v;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_NODE_PARAMETER_INTERVAL_RETURN(v) { PQfinish(conn); return v; }
+    #define LOAD_NODE_PARAMETER_INTERVAL_RETURN(v) { connection_release_pq(conn); return v; }
 
     PGresult *res = NULL;
     int rows = 0;
@@ -1010,7 +1135,7 @@ std::vector<std::string> load_Edge_parameter_interval(std::string dbname, std::s
     if (!conn) return v;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_EDGE_PARAMETER_INTERVAL_RETURN(v) { PQfinish(conn); return v; }
+    #define LOAD_EDGE_PARAMETER_INTERVAL_RETURN(v) { connection_release_pq(conn); return v; }
 
     PGresult *res = NULL;
     int rows = 0;
@@ -1133,6 +1258,38 @@ std::string Topic_pq::All_Topic_Data_pqstr() {
            All_Topic_relevance_pqstr() + ')';
 }
 
+/// Return the Topic data as one tab separated row in COPY text format.
+std::string Topic_pq::All_Topic_Data_copystr() {
+    std::string row(id_pqstr()+'\t'+supid_pqstr()+'\t');
+    append_copy_text_pq(row, topic->get_tag().c_str());
+    row += '\t';
+    append_copy_text_pq(row, topic->get_title().c_str());
+    row += '\t';
+
+    // Array elements are double-quoted, so that keywords with spaces and commas survive.
+    const Topic_KeyRel_Vector &k = topic->get_keyrel();
+    std::string keywords("{");
+    std::string relevances("{");
+    for (auto it = k.begin(); it != k.end(); ++it) {
+        if (it != k.begin()) {
+            keywords += ',';
+            relevances += ',';
+        }
+        keywords += '"';
+        for (const char * c = it->keyword.c_str(); *c != '\0'; ++c) {
+            if ((*c == '"') || (*c == '\\')) keywords += '\\';
+            keywords += *c;
+        }
+        keywords += '"';
+        relevances += to_precision_string(it->relevance,3);
+    }
+    keywords += '}';
+    relevances += '}';
+    append_copy_text_pq(row, keywords.c_str());
+    row += '\t' + relevances;
+    return row;
+}
+
 /// Return the ID between apostrophes.
 std::string Node_pq::id_pqstr() {
     return "'"+node->get_id().str()+"'";
@@ -1244,6 +1401,32 @@ std::string Node_pq::All_Node_Data_pqstr() {
            tdspan_pqstr() + ')';
 }
 
+/// Return the Node data as one tab separated row in COPY text format.
+std::string Node_pq::All_Node_Data_copystr() {
+    std::string row;
+    row.reserve(128 + node->get_text().size());
+    row += node->get_id().str();
+    row += '\t';
+    // Same as topics_pqstr() and topicrelevance_pqstr(), without the apostrophes.
+    std::string topicsstr(topics_pqstr());
+    row.append(topicsstr, 1, topicsstr.size()-2);
+    row += '\t';
+    std::string topicrelevancestr(topicrelevance_pqstr());
+    row.append(topicrelevancestr, 1, topicrelevancestr.size()-2);
+    row += '\t' + valuation_pqstr() + '\t' + completion_pqstr() + '\t' + required_pqstr() + '\t';
+    append_copy_text_pq(row, node->get_text().c_str());
+    row += '\t';
+    if (node->get_targetdate() < 0) {
+        row += "infinity";
+    } else {
+        row += TimeStamp("%Y%m%d %H:%M", node->get_targetdate());
+    }
+    row += '\t' + td_property_str[node->get_tdproperty()];
+    row += node->get_repeats() ? "\tt\t" : "\tf\t";
+    row += td_pattern_str[node->get_tdpattern()] + '\t' + tdevery_pqstr() + '\t' + tdspan_pqstr();
+    return row;
+}
+
 /// Return the unique depID>supID pair between apostrophes.
 std::string Edge_pq::id_pqstr() {
     return "'"+edge->get_id().str()+"'";
@@ -1284,6 +1467,24 @@ std::string Edge_pq::All_Edge_Data_pqstr() {
            priority_pqstr() + ')';
 }
 
+/// Return the Edge data as one tab separated row in COPY text format.
+std::string Edge_pq::All_Edge_Data_copystr() {
+    return edge->get_id().str() + '\t' +
+           dependency_pqstr() + '\t' +
+           significance_pqstr() + '\t' +
+           importance_pqstr() + '\t' +
+           urgency_pqstr() + '\t' +
+           priority_pqstr();
+}
+
+/// Remove the apostrophes around a value string made by one of the *_pqstr() functions.
+std::string unquoted_pq(const std::string & pqstr) {
+    if ((pqstr.size() >= 2) && (pqstr.front() == '\'') && (pqstr.back() == '\'')) {
+        return pqstr.substr(1, pqstr.size()-2);
+    }
+    return pqstr;
+}
+
 // *** Now that Node contains an `editflags` property, we may be able to remove the separate parameter here.
 //     The Node's `editflags` should be cleared if this function returns successfully. (The Update_Node_pq()
 //     function below does do this.)
@@ -1300,51 +1501,61 @@ bool update_Node_pq(PGconn* conn, const std::string & schemaname, const Node & n
     // *** is that it needs to be treated separately, because advancing can lead to turning off
     // *** repeating (isperiodic) while retaining the tdpattern as a cached reminder.
 
+    // The statement is prepared once per combination of edited fields (see prepared_call_pq()).
     Node_pq npq(&node);
-    // Prepare SET expressions
     std::string set_expressions;
+    std::vector<std::string> params;
+    Edit_flags_type fieldmask = 0;
+    auto set_field = [&](Edit_flags_type flag, pq_Nfields field, std::string && value) {
+        params.emplace_back(value);
+        set_expressions += pq_node_fieldnames[field] + " = $" + std::to_string(params.size()) + ',';
+        fieldmask |= flag;
+    };
     if (_editflags.Edit_topics()) {
-        set_expressions += pq_node_fieldnames[pqn_topics] + " = " + npq.topics_pqstr() + ',';
+        set_field(Edit_flags::topics, pqn_topics, unquoted_pq(npq.topics_pqstr()));
     }
     if (_editflags.Edit_topicrels()) {
-        set_expressions += pq_node_fieldnames[pqn_topicrelevance] + " = " + npq.topicrelevance_pqstr() + ',';
+        set_field(Edit_flags::topicrels, pqn_topicrelevance, unquoted_pq(npq.topicrelevance_pqstr()));
     }
     if (_editflags.Edit_valuation()) {
-        set_expressions += pq_node_fieldnames[pqn_valuation] + " = " + npq.valuation_pqstr() + ',';
+        set_field(Edit_flags::valuation, pqn_valuation, npq.valuation_pqstr());
     }
     if (_editflags.Edit_completion()) {
-        set_expressions += pq_node_fieldnames[pqn_completion] + " = " + npq.completion_pqstr() + ',';
+        set_field(Edit_flags::completion, pqn_completion, npq.completion_pqstr());
     }
     if (_editflags.Edit_required()) {
-        set_expressions += pq_node_fieldnames[pqn_required] + " = " + npq.required_pqstr() + ',';
+        set_field(Edit_flags::required, pqn_required, npq.required_pqstr());
     }
     if (_editflags.Edit_text()) {
-        set_expressions += pq_node_fieldnames[pqn_text] + " = " + npq.text_pqstr() + ',';
+        set_field(Edit_flags::text, pqn_text, std::string(node.get_text()));
     }
     if (_editflags.Edit_targetdate()) {
-        set_expressions += pq_node_fieldnames[pqn_targetdate] + " = " + npq.targetdate_pqstr() + ',';
+        set_field(Edit_flags::targetdate, pqn_targetdate, TimeStamp_pqparam(node.get_targetdate()));
     }
     if (_editflags.Edit_tdproperty()) {
-        set_expressions += pq_node_fieldnames[pqn_tdproperty] + " = " + npq.tdproperty_pqstr() + ',';
+        set_field(Edit_flags::tdproperty, pqn_tdproperty, unquoted_pq(npq.tdproperty_pqstr()));
     }
     if (_editflags.Edit_repeats()) {
-        set_expressions += pq_node_fieldnames[pqn_isperiodic] + " = " + npq.isperiodic_pqstr() + ',';
+        set_field(Edit_flags::repeats, pqn_isperiodic, npq.isperiodic_pqstr());
     }
     if (_editflags.Edit_tdpattern()) {
-        set_expressions += pq_node_fieldnames[pqn_tdperiodic] + " = " + npq.tdperiodic_pqstr() + ',';
+        set_field(Edit_flags::tdpattern, pqn_tdperiodic, unquoted_pq(npq.tdperiodic_pqstr()));
     }
     if (_editflags.Edit_tdevery()) {
-        set_expressions += pq_node_fieldnames[pqn_tdevery] + " = " + npq.tdevery_pqstr() + ',';
+        set_field(Edit_flags::tdevery, pqn_tdevery, npq.tdevery_pqstr());
     }
     if (_editflags.Edit_tdspan()) {
-        set_expressions += pq_node_fieldnames[pqn_tdspan] + " = " + npq.tdspan_pqstr() + ',';
+        set_field(Edit_flags::tdspan, pqn_tdspan, npq.tdspan_pqstr());
     }
-    if (!set_expressions.empty()) {
-        set_expressions.pop_back();
+    if (set_expressions.empty()) {
+        ERRRETURNFALSE(__func__, "No fields to update for Node "+node.get_id_str());
     }
+    set_expressions.pop_back();
 
-    std::string nstr("UPDATE " + schemaname + ".Nodes SET " + set_expressions + " WHERE id = "+npq.id_pqstr());
-    if (!simple_call_pq(conn, nstr)) {
+    params.emplace_back(node.get_id().str());
+    std::string nstr("UPDATE " + schemaname + ".Nodes SET " + set_expressions + " WHERE id = $" + std::to_string(params.size()));
+    std::string stmtname("update_Node_" + std::to_string(fieldmask) + '_' + schemaname);
+    if (!prepared_call_pq(conn, stmtname, nstr, params)) {
         ERRRETURNFALSE(__func__, "Unable to update Node "+node.get_id_str());
     }
 
@@ -1365,7 +1576,7 @@ bool Update_Node_pq(std::string dbname, std::string schemaname, const Node & nod
         const_cast<Node *>(&node)->clear_editflags();
     }
 
-    PQfinish(conn);
+    connection_release_pq(conn);
     return res;
 }
 
@@ -1477,7 +1688,7 @@ bool Update_batch_nodes_pq(std::string dbname, std::string schemaname, Graph & g
     bool res = update_batch_nodes_pq(conn, schemaname, graph, NNL_name);
     // clearing edit flags is already done within the preceding call
 
-    PQfinish(conn);
+    connection_release_pq(conn);
     return res;
 }
 
@@ -1519,7 +1730,7 @@ bool Init_Named_Node_Lists_pq(std::string dbname, std::string schemaname) {
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define INIT_NNL_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define INIT_NNL_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     // Drop previous NamedNodeLists table if it exists
     VERBOSEOUT("Dropping existing NamedNodeLists table if it exists.\n");
@@ -1538,6 +1749,11 @@ bool Init_Named_Node_Lists_pq(std::string dbname, std::string schemaname) {
         INIT_NNL_PQ_RETURN(false);
     }
 
+    // The fresh table needs its change stamp trigger (see install_Graph_change_stamp_pq()).
+    if (!install_Graph_change_stamp_pq(conn, schemaname)) {
+        INIT_NNL_PQ_RETURN(false);
+    }
+
     INIT_NNL_PQ_RETURN(true);
 }
 
@@ -1556,7 +1772,7 @@ bool Delete_Named_Node_List_pq(std::string dbname, std::string schemaname, std::
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define DELETE_NNL_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define DELETE_NNL_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     // Drop previous NamedNodeLists table if it exists
     std::string tablename(schemaname+".NamedNodeLists");
@@ -1595,7 +1811,7 @@ bool Update_Named_Node_List_pq(std::string dbname, std::string schemaname, std::
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define UPDATE_NNL_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define UPDATE_NNL_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     // Convert Named Node List data and insert or update row in table
     std::string tablename(schemaname+".NamedNodeLists");
@@ -1656,7 +1872,7 @@ bool load_Named_Node_Lists_pq(Graph& graph, std::string dbname, std::string sche
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_NNL_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define LOAD_NNL_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
 
     std::string loadstr("SELECT * FROM "+schemaname+".NamedNodeLists");
@@ -7,9 +7,17 @@
 #include <cstring>
 #include <iomanip>
 #include <map>
+#include <mutex>
+
+#include <fstream>
+#include <cstdio>
 
 // Boost
 #include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/crc.hpp>
+#include <boost/version.hpp>
 
 // core
 #include "general.hpp"
@@ -235,6 +243,139 @@ Graph_ptr graph_mem_managers::get_Graph(Graph_ptr & graph_ptr) {
     return graph_ptr;
 }
 
+/**
+ * Header of a Graph snapshot file. A snapshot is only valid for the build
+ * that wrote it, because the segment image contains the in-memory layout
+ * of all Graph data structures.
+ */
+struct Graph_snapshot_header {
+    char magic[8] = { 'F', 'Z', 'G', 'S', 'N', 'A', 'P', '\0' };
+    uint32_t format_version = 1;
+    uint32_t boost_version = BOOST_VERSION;
+    char build_stamp[32] = { 0 };
+    uint64_t sizeof_graph = sizeof(Graph);
+    uint64_t sizeof_node = sizeof(Node);
+    uint64_t sizeof_edge = sizeof(Edge);
+    uint64_t segment_size = 0;
+    int64_t db_stamp = 0;
+    uint32_t checksum = 0;
+    int64_t t_saved = 0;
+
+    Graph_snapshot_header() {
+        std::strncpy(build_stamp, __DATE__ " " __TIME__, sizeof(build_stamp)-1);
+    }
+    bool same_build(const Graph_snapshot_header & other) const {
+        return (std::memcmp(magic, other.magic, sizeof(magic)) == 0)
+            && (format_version == other.format_version)
+            && (boost_version == other.boost_version)
+            && (std::memcmp(build_stamp, other.build_stamp, sizeof(build_stamp)) == 0)
+            && (sizeof_graph == other.sizeof_graph)
+            && (sizeof_node == other.sizeof_node)
+            && (sizeof_edge == other.sizeof_edge);
+    }
+};
+
+uint32_t snapshot_checksum(const void * data, size_t len) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data, len);
+    return crc.checksum();
+}
+
+bool graph_mem_managers::save_Graph_snapshot(const std::string & snapshotpath, int64_t dbstamp) {
+    if (snapshotpath.empty()) {
+        ERRRETURNFALSE(__func__, "missing snapshot path");
+    }
+    if ((!active) || (!active->segmem_ptr)) {
+        ERRRETURNFALSE(__func__, "no active shared memory segment to save");
+    }
+
+    segment_memory_t * segmem_ptr = active->segmem_ptr;
+    Graph_snapshot_header header;
+    header.segment_size = segmem_ptr->get_size();
+    header.db_stamp = dbstamp;
+    header.checksum = snapshot_checksum(segmem_ptr->get_address(), header.segment_size);
+    header.t_saved = std::time(nullptr);
+
+    std::string tmppath(snapshotpath+".tmp");
+    {
+        std::ofstream ofs(tmppath, std::ios::binary | std::ios::trunc);
+        if (!ofs) {
+            ERRRETURNFALSE(__func__, "unable to open "+tmppath+" for writing");
+        }
+        ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        ofs.write(static_cast<const char *>(segmem_ptr->get_address()), header.segment_size);
+        if (!ofs) {
+            std::remove(tmppath.c_str());
+            ERRRETURNFALSE(__func__, "unable to write snapshot to "+tmppath);
+        }
+    }
+    if (std::rename(tmppath.c_str(), snapshotpath.c_str()) != 0) {
+        std::remove(tmppath.c_str());
+        ERRRETURNFALSE(__func__, "unable to rename "+tmppath+" to "+snapshotpath);
+    }
+    return true;
+}
+
+Graph_ptr graph_mem_managers::restore_Graph_snapshot(const std::string & snapshotpath, int64_t dbstamp) {
+    std::string segment_name("fzgraph");
+    try {
+        bi::file_mapping snapshotfile(snapshotpath.c_str(), bi::read_only);
+        bi::mapped_region snapshotregion(snapshotfile, bi::read_only);
+        if (snapshotregion.get_size() < sizeof(Graph_snapshot_header)) {
+            VERBOSEOUT("Graph snapshot at "+snapshotpath+" is truncated.\n");
+            return nullptr;
+        }
+
+        const Graph_snapshot_header & header = *static_cast<const Graph_snapshot_header *>(snapshotregion.get_address());
+        const char * image = static_cast<const char *>(snapshotregion.get_address()) + sizeof(Graph_snapshot_header);
+        if (!Graph_snapshot_header().same_build(header)) {
+            VERBOSEOUT("Graph snapshot at "+snapshotpath+" was made by a different build.\n");
+            return nullptr;
+        }
+        if (header.db_stamp != dbstamp) {
+            VERBOSEOUT("Graph snapshot at "+snapshotpath+" is stale (database changed since "+TimeStampYmdHM(header.t_saved)+").\n");
+            return nullptr;
+        }
+        if ((header.segment_size == 0) || (snapshotregion.get_size() != (sizeof(Graph_snapshot_header) + header.segment_size))) {
+            VERBOSEOUT("Graph snapshot at "+snapshotpath+" has an unexpected size.\n");
+            return nullptr;
+        }
+        if (snapshot_checksum(image, header.segment_size) != header.checksum) {
+            VERBOSEOUT("Graph snapshot at "+snapshotpath+" failed its checksum.\n");
+            return nullptr;
+        }
+
+        bi::shared_memory_object::remove(segment_name.c_str()); // erase any previous shared memory with same name
+        {
+            bi::permissions per;
+            per.set_unrestricted(); // the same as in allocate_and_activate_shared_memory()
+            bi::shared_memory_object shm(bi::create_only, segment_name.c_str(), bi::read_write, per);
+            shm.truncate(header.segment_size);
+            bi::mapped_region shmregion(shm, bi::read_write);
+            std::memcpy(shmregion.get_address(), image, header.segment_size);
+        }
+
+        segment_memory_t * segment = new segment_memory_t(bi::open_only, segment_name.c_str());
+        void_allocator * alloc_inst = new void_allocator(segment->get_segment_manager());
+        if (!add_manager(segment_name, *segment, *alloc_inst)) {
+            ERRRETURNNULL(__func__, "Unable to add segment manager for shared memory segment ("+segment_name+").");
+        }
+        set_active(segment_name);
+
+        Graph_ptr graph_ptr = segment->find<Graph>("graph").first;
+        if (!graph_ptr) {
+            forget_manager(segment_name);
+            bi::shared_memory_object::remove(segment_name.c_str());
+            VERBOSEOUT("Graph snapshot at "+snapshotpath+" contains no Graph.\n");
+        }
+        return graph_ptr;
+
+    } catch (const bi::interprocess_exception & ipexception) {
+        VERBOSEOUT("Unable to restore Graph snapshot from "+snapshotpath+", "+std::string(ipexception.what())+'\n');
+    }
+    return nullptr;
+}
+
 void graph_mem_managers::info(Graph_info_label_value_pairs & meminfo) { //bi::managed_shared_memory & segment) {
     if (!active)
         return;
@@ -588,7 +729,7 @@ bool Node::set_all_semaphores(int sval) {
 /**
  * This is the nested recursive Graph traversal function used to search for
  * inherited target dates. Normally only call this function recursively or
- * from inherit_targetdate().
+ * from superiors_targetdates().
  * 
  * NOTE 20240916: This now regards only ITD Nodes as those that do not specify
  * a target date. UTD Nodes, while treated as a sorted queue without target
@@ -599,38 +740,48 @@ bool Node::set_all_semaphores(int sval) {
  * tdproperty does not indicate that. For more information, see the comments
  * of the effective_targetdate() function.
  * 
+ * Results for inherit Nodes are cached (see invalidate_inherited_targetdate()).
+ * Nodes on the current search path are marked with td_visiting instead of
+ * resetting the semaphores of the whole Graph, so that a search only visits
+ * Nodes that were not already cached. Nodes that are part of a loop are not
+ * cached, because the result depends on where the loop was entered. In
+ * processes that do not own the cache, the search path is kept in `path`
+ * instead (see inherit_targetdate()).
+ * 
  * This returns RTt_maxtime if:
  * a) A loop condition was encountered.
  * b) There were no Superiors.
  * 
  * @param origin A pointer buffer to report the Node from which the targetdate is inherited.
+ * @param cacheable Set to false if a loop was encountered.
+ * @param path Search path of a process that does not own the cache, or nullptr.
  * @return The local targetdate parameter value if specified, or the earliest targetdate
  *         found by recursively searching Superiors, or RT_maxtime in one of the conditions
  *         described above.
  */
-time_t Node::nested_inherit_targetdate(Node_ptr & origin) {
-    if (get_semaphore()==SEM_TRAVERSED) {
+time_t Node::nested_inherit_targetdate(Node_ptr & origin, bool & cacheable, std::vector<const Node *> * path) {
+    bool visiting = path ? (std::find(path->begin(), path->end(), this) != path->end()) : td_visiting;
+    if (visiting) {
         if (graph) { // send an optional loop warning
             if (graph->warn_loops) ADDWARNING(__func__,"loop detected at Node DIL#"+get_id().str());
         }
+        cacheable = false;
         return RTt_maxtime;
     }
 
-    set_semaphore(SEM_TRAVERSED);
-
     if (tdproperty == td_property::inherit) { // Modified on 20240926 (used to include (tdproperty == td_property::unspecified) ||)
+        if (td_cache_valid) {
+            origin = td_cache_nested_origin.get();
+            return td_cache_nested;
+        }
         // continue the recursive search
-        time_t earliest = RTt_maxtime;
-        for (auto it = supedges.begin(); it != supedges.end(); ++it) {
-            Node & supnode = *((*it)->sup);
-            Node_ptr nested_origin = nullptr;
-            time_t sup_targetdate = supnode.nested_inherit_targetdate(nested_origin);
-            if ((sup_targetdate<earliest) && (sup_targetdate >=0 )) { // Modified on 20240926 (used to allow < 0)
-                earliest = sup_targetdate;
-                origin = nested_origin;
-            }
+        time_t earliest, earliest_valid;
+        Node_ptr earliest_origin, valid_origin;
+        if (!superiors_targetdates(earliest, earliest_origin, earliest_valid, valid_origin, path)) {
+            cacheable = false;
         }
-        return earliest;
+        origin = valid_origin;
+        return earliest_valid;
     }
 
     if (targetdate >= 0) {
@@ -649,6 +800,64 @@ time_t Node::nested_inherit_targetdate(Node_ptr & origin) {
     return targetdate; // complain loudly, warning of possible unintended consequences -- But don't secretly change here (see Log of 20201230).
 }
 
+/**
+ * Search the Superiors of this Node for the earliest target dates they provide,
+ * both including and excluding non-protocol (negative) values, and cache the
+ * results if no loop was encountered.
+ * 
+ * When a search path is given, the Node is marked on that path instead of
+ * with td_visiting, and nothing is cached.
+ * 
+ * @param earliest Receives the earliest target date (used by inherit_targetdate()).
+ * @param origin Receives the origin reported with `earliest`.
+ * @param earliest_valid Receives the earliest target date >= 0 (used by nested_inherit_targetdate()).
+ * @param origin_valid Receives the origin reported with `earliest_valid`.
+ * @param path Search path of a process that does not own the cache, or nullptr.
+ * @return True if the results were cached, or, with a search path, if no loop was encountered.
+ */
+bool Node::superiors_targetdates(time_t & earliest, Node_ptr & origin, time_t & earliest_valid, Node_ptr & origin_valid, std::vector<const Node *> * path) {
+    if (path) {
+        path->emplace_back(this);
+    } else {
+        td_visiting = true; // not using targetdate of this Node
+    }
+    bool cacheable = true;
+    earliest = RTt_maxtime;
+    earliest_valid = RTt_maxtime;
+    origin = nullptr;
+    origin_valid = nullptr;
+    for (auto it = supedges.begin(); it != supedges.end(); ++it) {
+        Node & supnode = *((*it)->sup);
+        Node_ptr nested_origin = nullptr;
+        time_t sup_targetdate = supnode.nested_inherit_targetdate(nested_origin, cacheable, path);
+        if (sup_targetdate<earliest) {
+            earliest = sup_targetdate;
+            origin = nested_origin;
+        }
+        if ((sup_targetdate<earliest_valid) && (sup_targetdate >=0 )) { // Modified on 20240926 (used to allow < 0)
+            earliest_valid = sup_targetdate;
+            origin_valid = nested_origin;
+        }
+    }
+    if (path) {
+        path->pop_back();
+        return cacheable;
+    }
+    td_visiting = false;
+
+    if (cacheable && (tdproperty == td_property::inherit)) {
+        td_cache_inherited = earliest;
+        td_cache_inherited_origin = origin;
+        td_cache_nested = earliest_valid;
+        td_cache_nested_origin = origin_valid;
+        td_cache_valid = true;
+    }
+    return td_cache_valid;
+}
+
+/// Serializes cache updates by threads that read the same Graph concurrently (e.g. fzserverpq workers).
+std::mutex td_cache_mutex;
+
 /**
  * This function attempts to determine an inherited target date from superior Nodes. It
  * does not use the local targetdate parameter of the Node.
@@ -656,10 +865,22 @@ time_t Node::nested_inherit_targetdate(Node_ptr & origin) {
  * Use this function with care. It is normally used by the safe function
  * effective_targetdate() to resolve unspecified targe dates.
  * 
+ * The result is cached and remains valid until invalidate_inherited_targetdate()
+ * is called for this Node or for one of the Nodes it inherits from, which is
+ * done automatically by set_targetdate(), set_tdproperty(), Graph::add_Edge()
+ * and Graph::remove_Edge().
+ * 
+ * Only the process that owns the Graph (see Graph::own_targetdate_cache())
+ * stores results, because the cache lives in shared memory. Other processes,
+ * such as clients of fzserverpq, use valid cached results but otherwise
+ * search without storing, and track their search path locally. Otherwise
+ * they could store a result that the owner had just invalidated, or mistake
+ * the search path of another process for a loop.
+ * 
  * This function may return special values:
  *   RTt_unspecified (-1), if all traversable Superiors designated not to take a target date into account for scheduling.
  *   RTt_unconnected (-2), if the Node is not connected in a Graph and nothing could be inherited from Superiors.
- *   RTt_maxtime (maximum postiive time_t value), if searching connections resulted in recursion (flagged by semaphores).
+ *   RTt_maxtime (maximum postiive time_t value), if searching connections resulted in recursion (flagged by td_visiting).
  * 
  * @param origin Optional storage for pointer to the origin Node that provides the effective
  *               target date. See for example how this is used in `fzupdate`.
@@ -667,27 +888,63 @@ time_t Node::nested_inherit_targetdate(Node_ptr & origin) {
  * from the tree of superior Nodes, or a special code, as described above.
  */
 time_t Node::inherit_targetdate(Node_ptr * origin) {
-    // ***It is technically possible to cache the result found here to speed up
-    // ***future calls to this function. To do that safely, calls to set_targetdate()
-    // ***would need to invalidate the cache for all dependency Nodes of the Node
-    // ***where the targetdate was changed. It is not clear if the time savings
-    // ***is worth the added complexity.
-
-    if (!set_all_semaphores(0)) return RTt_unconnected;
-    set_semaphore(SEM_TRAVERSED); // not using targetdate of this Node
-    time_t earliest = RTt_maxtime;
-    for (auto it = supedges.begin(); it != supedges.end(); ++it) {
-        Node & supnode = *((*it)->sup);
-        Node_ptr nested_origin = nullptr;
-        time_t sup_targetdate = supnode.nested_inherit_targetdate(nested_origin);
-        if (sup_targetdate<earliest) {
-            earliest = sup_targetdate;
-            if (origin) {
-                *origin = nested_origin;
+    if (!graph) return RTt_unconnected;
+
+    if ((!graph->owns_targetdate_cache()) && (!td_cache_valid)) {
+        time_t earliest, earliest_valid;
+        Node_ptr earliest_origin, valid_origin;
+        std::vector<const Node *> path;
+        superiors_targetdates(earliest, earliest_origin, earliest_valid, valid_origin, &path);
+        if ((origin) && (earliest < RTt_maxtime)) {
+            *origin = earliest_origin;
+        }
+        return earliest;
+    }
+
+    std::lock_guard<std::mutex> lock(td_cache_mutex);
+
+    if (!td_cache_valid) {
+        time_t earliest, earliest_valid;
+        Node_ptr earliest_origin, valid_origin;
+        superiors_targetdates(earliest, earliest_origin, earliest_valid, valid_origin, nullptr);
+        if (!td_cache_valid) { // not cacheable, e.g. due to a loop
+            if ((origin) && (earliest < RTt_maxtime)) {
+                *origin = earliest_origin;
             }
+            return earliest;
+        }
+    }
+
+    if ((origin) && (td_cache_inherited < RTt_maxtime)) {
+        *origin = td_cache_inherited_origin.get();
+    }
+    return td_cache_inherited;
+}
+
+/**
+ * Invalidate cached inherited target dates that depend on this Node.
+ * 
+ * This must be called whenever the targetdate or tdproperty of the Node
+ * changes, or when an Edge to one of its Superiors is added or removed.
+ * The setter functions and Graph::add_Edge() / Graph::remove_Edge() do
+ * this automatically.
+ * 
+ * Invalidation stops at Nodes that do not have a valid cache, because
+ * a valid cache in a Dependency always implies a valid cache here.
+ */
+void Node::invalidate_inherited_targetdate() {
+    td_cache_valid = false;
+    invalidate_dependencies_inherited_targetdate();
+}
+
+void Node::invalidate_dependencies_inherited_targetdate() {
+    for (const auto & dep_edge : depedges) {
+        Node * dep = dep_edge->get_dep();
+        if (dep->td_cache_valid) {
+            dep->td_cache_valid = false;
+            dep->invalidate_dependencies_inherited_targetdate();
         }
     }
-    return earliest;
 }
 
 size_t Node::num_active_superiors() const {
@@ -805,17 +1062,26 @@ time_t Node::tz_adjusted_targetdate(time_t t) const {
  *         described above.
  */
 time_t Node::effective_targetdate(Node_ptr * origin) {
+    return tz_adjusted_targetdate(unadjusted_effective_targetdate(origin));
+}
+
+/**
+ * The effective target date before any time-zone adjustment is applied. This is
+ * what the Graph target date index is sorted by, since the time-zone adjustment
+ * is only activated temporarily for specific presentations (see tz_adjust()).
+ */
+time_t Node::unadjusted_effective_targetdate(Node_ptr * origin) {
     if (origin) {
         *origin = this; // the default
     }
     // *** Rule prior to 20240914:
     // if ((tdproperty == td_property::unspecified) || (tdproperty == td_property::inherit))
     if (tdproperty == td_property::inherit) {
-        return tz_adjusted_targetdate(inherit_targetdate(origin));
+        return inherit_targetdate(origin);
     }
 
     if (targetdate >= 0) {
-        return tz_adjusted_targetdate(targetdate);
+        return targetdate;
     }
 
     // beyond this point are unexpected (non-protocol) circumstances, variable/fixed/exact with negative targetdate
@@ -827,11 +1093,21 @@ time_t Node::effective_targetdate(Node_ptr * origin) {
         standard_error("Erroneous (non-protocol) target date ("+std::to_string((long)targetdate)+") + TD property ("+td_property_str[tdproperty]+") in Node "+get_id_str()+". Attempting to treat as unspecified.", __func__);
     }
 
-    return tz_adjusted_targetdate(targetdate); // complain loudly, warning of possible unintended consequences
+    return targetdate; // complain loudly, warning of possible unintended consequences
 
     //return inherit_targetdate(origin); -- But don't secretly change here (see Log of 20201230).
 }
 
+/**
+ * Update this Node and its inheriting Dependencies in the Graph target date
+ * index, if that index is active. This is called by the setters of Node
+ * parameters that determine the effective target date and index membership.
+ */
+void Node::refresh_targetdate_index() {
+    if (!graph) return;
+    graph->refresh_targetdate_index(*this);
+}
+
 /**
  * Set the Node.text parameter content and ensure that it contains
  * valid UTF8 encoded content.
@@ -851,7 +1127,28 @@ time_t Node::effective_targetdate(Node_ptr * origin) {
  * @param utf8str a string that should contain UTF8 encoded text.
  */
 void Node::set_text(const std::string utf8str) {
-    text = utf8_safe(utf8str).c_str();
+    assign_text(utf8_safe(utf8str).c_str());
+}
+
+void Node::set_text_unchecked(const std::string utf8str) {
+    assign_text(utf8str.c_str());
+}
+
+/**
+ * Assign Node.text and update the Graph text and capability indices, if
+ * those indices are active.
+ */
+void Node::assign_text(const char * utf8str) {
+    if ((!graph) || (!graph->text_index_is_active())) {
+        text = utf8str;
+    } else {
+        std::string oldtext(text.c_str());
+        text = utf8str;
+        graph->refresh_text_index(*this, oldtext.c_str());
+    }
+    if (graph) {
+        graph->refresh_capability_index(*this);
+    }
 }
 
 /**
@@ -1108,32 +1405,29 @@ std::map<std::string, float> Node::Topic_TagRels(Topic_Tags * topictags) {
     return topictagrels;
 }
 
-Node * Node::has_sup(const std::string & sup_idstr) const {
-    Node_ID_key sup_key(sup_idstr);
-    auto sup_edges_set = sup_Edges();
-    for (const auto & edge_ptr : sup_edges_set) {
-        if (edge_ptr->get_sup_key()==sup_key) {
-            return edge_ptr->get_sup();
-        }
-    }
-    return nullptr;
+Node * Node::has_sup(const Node_ID_key & sup_key) const {
+    Edge * edge_ptr = get_Edge_by_sup(sup_key);
+    return edge_ptr ? edge_ptr->get_sup() : nullptr;
 }
 
-Node * Node::has_dep(const std::string & dep_idstr) const {
-    Node_ID_key dep_key(dep_idstr);
-    auto dep_edges_set = dep_Edges();
-    for (const auto & edge_ptr : dep_edges_set) {
-        if (edge_ptr->get_dep_key()==dep_key) {
-            return edge_ptr->get_dep();
-        }
-    }
-    return nullptr;
+Node * Node::has_dep(const Node_ID_key & dep_key) const {
+    Edge * edge_ptr = get_Edge_by_dep(dep_key);
+    return edge_ptr ? edge_ptr->get_dep() : nullptr;
 }
 
-Edge * Node::get_Edge_by_sup(const std::string & sup_idstr) const {
-    Node_ID_key sup_key(sup_idstr);
-    auto sup_edges_set = sup_Edges();
-    for (const auto & edge_ptr : sup_edges_set) {
+/**
+ * Find the Edge to a superior of this Node. When the Node is in a Graph the
+ * Edge is found by its key in the Graph's Edge index, otherwise the
+ * superior Edges of this Node are searched.
+ * 
+ * @param sup_key The Node ID key of the superior.
+ * @return Pointer to the Edge, or nullptr if it is not in sup_Edges().
+ */
+Edge * Node::get_Edge_by_sup(const Node_ID_key & sup_key) const {
+    if (graph) {
+        return graph->Edge_by_id(Edge_ID_key(id.key(), sup_key));
+    }
+    for (const auto & edge_ptr : supedges) {
         if (edge_ptr->get_sup_key()==sup_key) {
             return edge_ptr.get();
         }
@@ -1141,10 +1435,19 @@ Edge * Node::get_Edge_by_sup(const std::string & sup_idstr) const {
     return nullptr;
 }
 
-Edge * Node::get_Edge_by_dep(const std::string & dep_idstr) const {
-    Node_ID_key dep_key(dep_idstr);
-    auto dep_edges_set = dep_Edges();
-    for (const auto & edge_ptr : dep_edges_set) {
+/**
+ * Find the Edge to a dependency of this Node. When the Node is in a Graph the
+ * Edge is found by its key in the Graph's Edge index, otherwise the
+ * dependency Edges of this Node are searched.
+ * 
+ * @param dep_key The Node ID key of the dependency.
+ * @return Pointer to the Edge, or nullptr if it is not in dep_Edges().
+ */
+Edge * Node::get_Edge_by_dep(const Node_ID_key & dep_key) const {
+    if (graph) {
+        return graph->Edge_by_id(Edge_ID_key(dep_key, id.key()));
+    }
+    for (const auto & edge_ptr : depedges) {
         if (edge_ptr->get_dep_key()==dep_key) {
             return edge_ptr.get();
         }
@@ -1337,11 +1640,15 @@ bool Named_Node_List::add(const Node_ID_key & nkey) {
             if (prepend()) { // pop the back
                 if (unique()) { // remove the Node ID key that will be popped
                     set.erase(list.back());
+                } else {
+                    count_removed(list.back());
                 }
                 list.pop_back();
             } else { // pop the front
                 if (unique()) { // remove the Node ID key that will be popped
                     set.erase(list.front());
+                } else {
+                    count_removed(list.front());
                 }
                 list.pop_front();
             }
@@ -1351,6 +1658,8 @@ bool Named_Node_List::add(const Node_ID_key & nkey) {
     bool placed = true;
     if (unique()) {
         std::tie (std::ignore, placed) = set.emplace(nkey);
+    } else {
+        count_added(nkey);
     }
     if (placed) {
         if (prepend()) {
@@ -1362,6 +1671,27 @@ bool Named_Node_List::add(const Node_ID_key & nkey) {
     return placed;
 }
 
+/// Record one more occurrence of a Node ID key in a List that is not unique.
+void Named_Node_List::count_added(const Node_ID_key & nkey) {
+    auto [c_it, inserted] = counts.emplace(nkey, 1);
+    if (!inserted) {
+        ++(c_it->second);
+    }
+}
+
+/// Record that one occurrence of a Node ID key was removed from a List that is not unique.
+void Named_Node_List::count_removed(const Node_ID_key & nkey) {
+    auto c_it = counts.find(nkey);
+    if (c_it == counts.end()) {
+        return;
+    }
+    if (c_it->second > 1) {
+        --(c_it->second);
+    } else {
+        counts.erase(c_it);
+    }
+}
+
 /**
  * Remove a Node ID key to a Named Node List.
  * 
@@ -1381,6 +1711,9 @@ bool Named_Node_List::remove(const Node_ID_key & nkey) {
     if (prepend()) { // oldest is furthest toward the back
         for (auto n_it = list.rbegin(); n_it != list.rend(); ++n_it) {
             if (*n_it == nkey) {
+                if (!unique()) {
+                    count_removed(nkey);
+                }
                 list.erase((n_it+1).base()); // see https://www.geeksforgeeks.org/how-to-erase-an-element-from-a-vector-using-erase-and-reverse_iterator/ and https://en.cppreference.com/w/cpp/iterator/reverse_iterator
                 return true;
             }
@@ -1388,6 +1721,9 @@ bool Named_Node_List::remove(const Node_ID_key & nkey) {
     } else { // oldest is furtherst toward the front
         for (auto n_it = list.begin(); n_it != list.end(); ++n_it) {
             if (*n_it == nkey) {
+                if (!unique()) {
+                    count_removed(nkey);
+                }
                 list.erase(n_it);
                 return true;
             }
@@ -1725,10 +2061,15 @@ bool Graph::add_Node(Node &node) {
 
     std::pair<Node_Map::iterator, bool> ret;
     ret = nodes.insert(std::pair<Node_ID_key, Graph_Node_ptr>(node.get_id().key(), &node));
-    if (!ret.second)
+    if (!ret.second) {
         error = g_adddupnode;
-    else
+    } else {
         node.graph = this;
+        update_id_index(node);
+        refresh_targetdate_index(node);
+        refresh_text_index(node, "");
+        refresh_capability_index(node);
+    }
     return ret.second;
 }
 
@@ -1775,6 +2116,9 @@ bool Graph::add_Edge(Edge &edge) {
     
     edge.get_dep()->supedges.emplace(&edge); // update rapid access set
     edge.get_sup()->depedges.emplace(&edge); // update rapid access set
+    update_id_index(edge);
+    edge.get_dep()->invalidate_inherited_targetdate();
+    refresh_targetdate_index(*edge.get_dep());
     return true;
 }
 
@@ -1823,6 +2167,9 @@ bool Graph::remove_Edge(Edge &edge) {
 
     dep.supedges.erase(e); // update rapid access set
     sup.depedges.erase(e); // update rapid access set
+    update_id_index(edge, true);
+    dep.invalidate_inherited_targetdate();
+    refresh_targetdate_index(dep);
     return true;
 }
 
@@ -1837,14 +2184,494 @@ bool Graph::remove_Edge(Edge *edge) {
 /**
  * Set the semaphore variables of all Nodes in the Graph to a specified value.
  * 
- * An example where this is used are Graph traversing functions, such as the
- * Node::inherit_targetdate() function.
+ * An example where this is used are Graph traversing functions, such as
+ * Graph::op().
  */
 void Graph::set_all_semaphores(int sval) {
     for (auto it = nodes.begin(); it != nodes.end(); ++it)
         it->second->set_semaphore(sval);
 }
 
+/**
+ * Build the secondary index of incomplete Nodes by effective target date and
+ * keep it up to date from here on. The index contains the same Nodes as
+ * Nodes_incomplete_by_targetdate(), and its repeating subset contains the
+ * same Nodes as Nodes_incomplete_and_repeating_by_targetdate().
+ * 
+ * This should only be called by the process that owns and modifies the Graph,
+ * e.g. fzserverpq after loading the Graph. After that, all changes made through
+ * Node setters and Graph::add_Node(), add_Edge() and remove_Edge() update the
+ * index of affected Nodes.
+ */
+void Graph::build_targetdate_index() {
+    reset_targetdate_index();
+    targetdate_index_active = true;
+    for (const auto & [nkey, node_ptr] : nodes) {
+        update_targetdate_index(*node_ptr);
+    }
+}
+
+void Graph::reset_targetdate_index() {
+    targetdate_index_active = false;
+    incomplete_by_targetdate.clear();
+    incomplete_repeating_by_targetdate.clear();
+}
+
+/**
+ * Move a Node to its current position in the target date index, or remove it
+ * from the index if it is no longer incomplete with required time.
+ */
+void Graph::update_targetdate_index(Node & node) {
+    Targetdate_Index_key oldkey(node.td_indexed, node.get_id().key());
+    incomplete_by_targetdate.erase(oldkey);
+    incomplete_repeating_by_targetdate.erase(oldkey);
+
+    float completion = node.get_completion();
+    if ((completion>=0.0) && (completion<1.0) && (node.get_required()>0.0)) {
+        node.td_indexed = node.unadjusted_effective_targetdate();
+        Targetdate_Index_key newkey(node.td_indexed, node.get_id().key());
+        incomplete_by_targetdate.emplace(newkey, &node);
+        if (node.get_repeats()) {
+            incomplete_repeating_by_targetdate.emplace(newkey, &node);
+        }
+    }
+}
+
+/**
+ * Refresh the target date index for a Node and for all Dependencies that
+ * inherit their effective target date from it (directly or indirectly).
+ * 
+ * Does nothing if the index is not active.
+ */
+void Graph::refresh_targetdate_index(Node & node) {
+    if (!targetdate_index_active) return;
+
+    std::set<Node_ptr> refreshed;
+    std::vector<Node_ptr> to_refresh = { &node };
+    while (!to_refresh.empty()) {
+        Node_ptr node_ptr = to_refresh.back();
+        to_refresh.pop_back();
+        if (!refreshed.emplace(node_ptr).second) continue; // loop protection
+
+        update_targetdate_index(*node_ptr);
+        for (const auto & dep_edge : node_ptr->dep_Edges()) {
+            Node * dep = dep_edge->get_dep();
+            if (dep->td_inherit()) {
+                to_refresh.emplace_back(dep);
+            }
+        }
+    }
+}
+
+void Text_Index_Postings::append(uint32_t ordinal) {
+    uint32_t delta = ordinal - last;
+    while (delta >= 0x80) {
+        deltas.emplace_back(uint8_t(delta | 0x80));
+        delta >>= 7;
+    }
+    deltas.emplace_back(uint8_t(delta));
+    last = ordinal;
+    ++num;
+}
+
+void Text_Index_Postings::decode(std::vector<uint32_t> & ordinals) const {
+    ordinals.clear();
+    ordinals.reserve(num);
+    uint32_t ordinal = 0;
+    uint32_t delta = 0;
+    unsigned int shift = 0;
+    for (const auto & byte : deltas) {
+        delta |= uint32_t(byte & 0x7f) << shift;
+        if (byte & 0x80) {
+            shift += 7;
+            continue;
+        }
+        ordinal += delta;
+        ordinals.emplace_back(ordinal);
+        delta = 0;
+        shift = 0;
+    }
+}
+
+void Text_Index_Postings::encode(const std::vector<uint32_t> & ordinals) {
+    deltas.clear();
+    last = 0;
+    num = 0;
+    for (const auto & ordinal : ordinals) {
+        append(ordinal);
+    }
+}
+
+/**
+ * Returns the sorted and unique trigrams of a text (see text_index_fold()).
+ */
+std::vector<unsigned int> text_trigrams(const char * text) {
+    std::vector<unsigned int> trigrams;
+    size_t len = strlen(text);
+    if (len < 3) {
+        return trigrams;
+    }
+    trigrams.reserve(len-2);
+    unsigned int t = text_index_fold(text[0])*text_index_alphabet + text_index_fold(text[1]);
+    for (size_t i = 2; i < len; ++i) {
+        t = (t % (text_index_alphabet*text_index_alphabet))*text_index_alphabet + text_index_fold(text[i]);
+        trigrams.emplace_back(t);
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+/**
+ * Rebuild the hash index of Nodes and Edges by key and use it from here on.
+ * 
+ * The index is maintained by Graph::add_Node(), Graph::add_Edge() and
+ * Graph::remove_Edge() from the moment the Graph is constructed, so this is
+ * only needed to restore it after it was dropped.
+ * 
+ * The index is allocated in the Graph's shared memory segment. If that runs
+ * out of space then the index is dropped and lookups fall back to the
+ * ordered maps.
+ * 
+ * @return True if the index was built.
+ */
+bool Graph::build_id_index() {
+    reset_id_index();
+    id_index_active = true;
+    for (const auto & [nkey, node_ptr] : nodes) {
+        update_id_index(*node_ptr);
+    }
+    for (const auto & [ekey, edge_ptr] : edges) {
+        update_id_index(*edge_ptr);
+    }
+    return id_index_active;
+}
+
+void Graph::reset_id_index() {
+    id_index_active = false;
+    nodes_by_key.clear();
+    edges_by_key.clear();
+}
+
+void Graph::update_id_index(Node & node) {
+    if (!id_index_active) {
+        return;
+    }
+    try {
+        nodes_by_key.insert(node.get_id().key().idT.packed(), &node);
+    } catch (const std::exception & e) {
+        ADDWARNING(__func__, "Dropping Node and Edge index: "+std::string(e.what()));
+        reset_id_index();
+    }
+}
+
+void Graph::update_id_index(Edge & edge, bool remove) {
+    if (!id_index_active) {
+        return;
+    }
+    Packed_Edge_key ekey(edge.get_id().key());
+    if (remove) {
+        edges_by_key.erase(ekey);
+        return;
+    }
+    try {
+        edges_by_key.insert(ekey, &edge);
+    } catch (const std::exception & e) {
+        ADDWARNING(__func__, "Dropping Node and Edge index: "+std::string(e.what()));
+        reset_id_index();
+    }
+}
+
+/**
+ * Build the trigram index of Node text and keep it up to date from here on.
+ * Text searches with Nodes_subset() use the index to find candidate Nodes
+ * instead of searching the text of every Node.
+ * 
+ * This should only be called by the process that owns and modifies the Graph,
+ * e.g. fzserverpq after loading the Graph. After that, Node::set_text(),
+ * Node::set_text_unchecked() and Graph::add_Node() update the index.
+ * 
+ * The index is allocated in the Graph's shared memory segment. It is not
+ * built, or it is dropped again, when less than text_index_memory_reserve
+ * would remain free for changes to the Graph, and searches then fall back
+ * to scanning.
+ * 
+ * @return True if the index was built.
+ */
+bool Graph::build_text_index() {
+    reset_text_index();
+    if (!text_index_has_room(text_index_trigrams*sizeof(Text_Index_Postings) + (nodes.size()+1)*sizeof(Graph_Node_ptr))) {
+        ADDWARNING(__func__, "Not enough free shared memory for the text index");
+        return false;
+    }
+    text_index_active = true;
+    try {
+        text_index.resize(text_index_trigrams, Text_Index_Postings(text_index.get_allocator()));
+        text_index_nodes.reserve(nodes.size()+1);
+        text_index_nodes.emplace_back(nullptr); // ordinal 0 means not indexed
+        for (const auto & [nkey, node_ptr] : nodes) {
+            node_ptr->text_ordinal = 0;
+            update_text_index(*node_ptr, "");
+            if (!text_index_active) {
+                return false;
+            }
+        }
+        for (auto & postings : text_index) {
+            postings.deltas.shrink_to_fit();
+        }
+    } catch (const std::exception & e) {
+        ADDWARNING(__func__, "Unable to build text index: "+std::string(e.what()));
+        reset_text_index();
+        return false;
+    }
+    return true;
+}
+
+void Graph::reset_text_index() {
+    text_index_active = false;
+    text_index.clear();
+    text_index.shrink_to_fit();
+    text_index_nodes.clear();
+    text_index_nodes.shrink_to_fit();
+}
+
+/**
+ * Returns true if `needed` bytes can be allocated in the Graph's shared memory
+ * segment while keeping text_index_memory_reserve free.
+ */
+bool Graph::text_index_has_room(std::size_t needed) const {
+    return text_index.get_allocator().get_segment_manager()->get_free_memory() >= (needed + text_index_memory_reserve);
+}
+
+/**
+ * Add a Node to the text index or update its posting lists after its text
+ * changed. Only the posting lists of trigrams that were added or removed
+ * are modified.
+ * 
+ * The index is dropped if this would leave less than text_index_memory_reserve
+ * of free shared memory.
+ * 
+ * @param node A Node in this Graph.
+ * @param oldtext The text of the Node before the change (ignored if the Node was not indexed).
+ */
+void Graph::update_text_index(Node & node, const char * oldtext) {
+    if (!text_index_has_room(node.get_text().size()*2)) { // each trigram posting is 1 to 5 bytes, usually 1 or 2
+        ADDWARNING(__func__, "Dropping text index to keep shared memory free for Graph changes");
+        reset_text_index();
+        return;
+    }
+    try {
+        if (node.text_ordinal == 0) {
+            node.text_ordinal = text_index_nodes.size();
+            text_index_nodes.emplace_back(&node);
+            oldtext = "";
+        }
+        uint32_t ordinal = node.text_ordinal;
+
+        std::vector<unsigned int> oldtrigrams(text_trigrams(oldtext));
+        std::vector<unsigned int> newtrigrams(text_trigrams(node.get_text().c_str()));
+        std::vector<unsigned int> removed, added;
+        std::set_difference(oldtrigrams.begin(), oldtrigrams.end(), newtrigrams.begin(), newtrigrams.end(), std::back_inserter(removed));
+        std::set_difference(newtrigrams.begin(), newtrigrams.end(), oldtrigrams.begin(), oldtrigrams.end(), std::back_inserter(added));
+
+        std::vector<uint32_t> ordinals;
+        for (const auto & trigram : removed) {
+            Text_Index_Postings & postings = text_index[trigram];
+            postings.decode(ordinals);
+            auto it = std::lower_bound(ordinals.begin(), ordinals.end(), ordinal);
+            if ((it != ordinals.end()) && (*it == ordinal)) {
+                ordinals.erase(it);
+                postings.encode(ordinals);
+            }
+        }
+        for (const auto & trigram : added) {
+            Text_Index_Postings & postings = text_index[trigram];
+            if (ordinal > postings.last) { // the common case of a new Node
+                postings.append(ordinal);
+                continue;
+            }
+            postings.decode(ordinals);
+            auto it = std::lower_bound(ordinals.begin(), ordinals.end(), ordinal);
+            if ((it == ordinals.end()) || (*it != ordinal)) {
+                ordinals.insert(it, ordinal);
+                postings.encode(ordinals);
+            }
+        }
+    } catch (const std::exception & e) {
+        ADDWARNING(__func__, "Text index disabled: "+std::string(e.what()));
+        reset_text_index();
+    }
+}
+
+std::vector<std::string> capability_tag_items(const std::string & text, const std::string & tag) {
+    auto items_start = text.find(tag);
+    if (items_start == std::string::npos) {
+        return std::vector<std::string>();
+    }
+    items_start += tag.size();
+    auto items_end = text.find('@', items_start);
+    if (items_end == std::string::npos) {
+        return std::vector<std::string>();
+    }
+    return split(text.substr(items_start, items_end - items_start), ',');
+}
+
+/**
+ * Build the index of capabilities in @PREREQS:...@ and @PROVIDES:...@ tags
+ * of Node text and keep it up to date from here on. Capability names are
+ * interned, each Node with such tags gets its lists of capability IDs, and
+ * each capability gets its list of providing Nodes. Prerequisite checks
+ * (see Graphinfo.hpp:get_prerequisites()) use the index instead of parsing
+ * Node text again for each Node and dependency.
+ * 
+ * This should only be called by the process that owns and modifies the Graph,
+ * e.g. fzserverpq after loading the Graph. After that, Node::set_text(),
+ * Node::set_text_unchecked() and Graph::add_Node() update the index.
+ * 
+ * @return True if the index was built.
+ */
+bool Graph::build_capability_index() {
+    reset_capability_index();
+    capability_index_active = true;
+    for (const auto & [nkey, node_ptr] : nodes) {
+        update_capability_index(*node_ptr);
+        if (!capability_index_active) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Graph::reset_capability_index() {
+    capability_index_active = false;
+    node_capabilities.clear();
+    capabilities.clear();
+    capabilities.shrink_to_fit();
+}
+
+/**
+ * Returns the ID of a capability, adding it to the index if it is new.
+ * There are usually few distinct capabilities, so a linear search is used.
+ */
+Capability_ID Graph::intern_capability(const std::string & name) {
+    for (Capability_ID id = 0; id < capabilities.size(); ++id) {
+        if (name == capabilities[id].name.c_str()) {
+            return id;
+        }
+    }
+    capabilities.emplace_back(Capability(capabilities.get_allocator()));
+    capabilities.back().name = name.c_str();
+    return capabilities.size()-1;
+}
+
+/**
+ * Parse the @PREREQS:...@ and @PROVIDES:...@ tags of a Node that was added or
+ * whose text changed, and update its entry and its entries as a provider.
+ * 
+ * @param node A Node in this Graph.
+ */
+void Graph::update_capability_index(Node & node) {
+    try {
+        std::string text(node.get_text().c_str());
+        auto prereqs = capability_tag_items(text, "@PREREQS:");
+        auto provides = capability_tag_items(text, "@PROVIDES:");
+
+        Node_ID_key nkey(node.get_id().key());
+        auto it = node_capabilities.find(nkey);
+        if (it != node_capabilities.end()) {
+            Graph_Node_ptr provider(&node);
+            for (const auto & id : it->second.provides) {
+                auto & providers = capabilities[id].providers;
+                providers.erase(std::remove(providers.begin(), providers.end(), provider), providers.end());
+            }
+            if (prereqs.empty() && provides.empty()) {
+                node_capabilities.erase(it);
+                return;
+            }
+            it->second.prereqs.clear();
+            it->second.provides.clear();
+        } else {
+            if (prereqs.empty() && provides.empty()) {
+                return;
+            }
+            it = node_capabilities.emplace(nkey, Node_Capabilities(node_capabilities.get_allocator())).first;
+        }
+
+        for (const auto & prereq : prereqs) {
+            it->second.prereqs.emplace_back(intern_capability(prereq));
+        }
+        for (const auto & capability : provides) {
+            Capability_ID id = intern_capability(capability);
+            it->second.provides.emplace_back(id);
+            auto & providers = capabilities[id].providers;
+            if (std::find(providers.begin(), providers.end(), Graph_Node_ptr(&node)) == providers.end()) {
+                providers.emplace_back(&node);
+            }
+        }
+    } catch (const std::exception & e) {
+        ADDWARNING(__func__, "Capability index disabled: "+std::string(e.what()));
+        reset_capability_index();
+    }
+}
+
+const Capability * Graph::find_capability(const std::string & name) const {
+    for (const auto & capability : capabilities) {
+        if (name == capability.name.c_str()) {
+            return &capability;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Find the capabilities that a Node requires and provides.
+ * 
+ * @param nkey The Node ID key.
+ * @return Pointer to the capabilities, or nullptr if the Node has no
+ *         @PREREQS or @PROVIDES tags (or the index is not active).
+ */
+const Node_Capabilities * Graph::find_Node_capabilities(const Node_ID_key & nkey) const {
+    auto it = node_capabilities.find(nkey);
+    if (it == node_capabilities.end()) {
+        return nullptr;
+    }
+    return &(it->second);
+}
+
+/**
+ * Find the Nodes whose text may contain a search term. The candidates are
+ * the Nodes whose text contains all of the trigrams of the term. They
+ * still need to be verified, e.g. see Nodes_subset().
+ * 
+ * @param term The search term.
+ * @param ordinals Receives the ascending text index ordinals of candidate Nodes (see text_index_Node()).
+ * @return False if the index cannot narrow the search, e.g. inactive index or term shorter than 3 characters.
+ */
+bool Graph::text_index_candidates(const std::string & term, std::vector<uint32_t> & ordinals) const {
+    ordinals.clear();
+    if (!text_index_active) {
+        return false;
+    }
+    std::vector<unsigned int> trigrams(text_trigrams(term.c_str()));
+    if (trigrams.empty()) {
+        return false;
+    }
+
+    // Intersect starting with the shortest posting lists, and stop when few enough are left to verify.
+    std::sort(trigrams.begin(), trigrams.end(), [&](unsigned int a, unsigned int b) {
+        return text_index[a].num < text_index[b].num;
+    });
+    text_index[trigrams.front()].decode(ordinals);
+    std::vector<uint32_t> next, both;
+    for (size_t i = 1; (i < trigrams.size()) && (ordinals.size() > 16); ++i) {
+        text_index[trigrams[i]].decode(next);
+        both.clear();
+        std::set_intersection(ordinals.begin(), ordinals.end(), next.begin(), next.end(), std::back_inserter(both));
+        ordinals.swap(both);
+    }
+    return true;
+}
+
 Node_Index Graph::get_Indexed_Nodes() const {
     Node_Index nodeindex;
     for (const auto& nodekp: nodes) {
@@ -44,7 +44,7 @@ bool store_Guide_snippet_pq(const Guide_snippet & snippet, Postgres_access & pa)
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define STORE_SNIPPET_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define STORE_SNIPPET_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     active_pq apq(conn,pa.pq_schemaname());
     if (!create_Guide_table(apq,snippet.tablename,snippet.layout())) {
@@ -78,7 +78,7 @@ bool store_Guide_multi_snippet_pq(const std::vector<Guide_snippet_ptr> & snippet
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define STORE_SNIPPET_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define STORE_SNIPPET_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     active_pq apq(conn,pa.pq_schemaname());
     if (!create_Guide_table(apq,snippets[0]->tablename,snippets[0]->layout())) {
@@ -118,7 +118,7 @@ bool read_Guide_snippet_pq(Guide_snippet & snippet, Postgres_access & pa) {
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_SNIPPET_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define LOAD_SNIPPET_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     std::string pqcmdstr = "SELECT snippet FROM "+pa.pq_schemaname()+ "." + snippet.tablename+" WHERE id="+snippet.idstr();
     if (!query_call_pq(conn, pqcmdstr, false)) LOAD_SNIPPET_PQ_RETURN(false);
@@ -167,7 +167,7 @@ bool read_Guide_IDs_pq(Guide_snippet & snippet, Postgres_access & pa, std::vecto
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_SNIPPET_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define LOAD_SNIPPET_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     std::string pqcmdstr = "SELECT id FROM "+pa.pq_schemaname()+ "." + snippet.tablename;
     if (!query_call_pq(conn, pqcmdstr, false)) LOAD_SNIPPET_PQ_RETURN(false);
@@ -224,7 +224,7 @@ bool read_Guide_multi_snippets_pq(Guide_snippet & snippet, Postgres_access & pa,
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_SNIPPET_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define LOAD_SNIPPET_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     // Translate our Guide filter wildcards into Postgres wildcards.
 
@@ -40,6 +40,16 @@ std::string pq_LElayout(
     "text text"     // pqle_text
 );
 
+/// The indexed text search vector of Log entries (see create_Logentries_text_index_pq()).
+const std::string pq_LEtextvector("to_tsvector('simple', text)");
+
+std::string entry_minor_id_pq(unsigned int minor_id);
+
+/// Return the Log entry ID as stored in Postgres, for prepared statement parameters (see Logentry_pq::id_pqstr()).
+std::string entry_id_pqparam(const Log_entry & entry) {
+    return entry.get_id_str().substr(0,13)+entry_minor_id_pq(entry.get_minor_id());
+}
+
 //bool create_Enum_Types_pq(const active_pq & apq) {}
 
 /**
@@ -84,7 +94,30 @@ bool create_Logentries_table_pq(const active_pq & apq) {
         return false;
 
     std::string pq_maketable("CREATE TABLE "+apq.pq_schemaname+".Logentries ("+pq_LElayout+')');
-    return simple_call_pq(apq.conn,pq_maketable);
+    if (!simple_call_pq(apq.conn,pq_maketable)) {
+        return false;
+    }
+    return create_Logentries_text_index_pq(apq);
+}
+
+/**
+ * Create the inverted index of Log entry text, unless it exists.
+ * 
+ * This is a Postgres GIN index of the words in each Log entry, case-folded
+ * but not stemmed (the 'simple' text search configuration). It records
+ * which entries contain a word, not where. Postgres keeps it up to date as
+ * Log entries are added, modified or deleted. See search_Log_entries_pq().
+ * 
+ * @param apq active database connection.
+ * @return true if the index exists.
+ */
+bool create_Logentries_text_index_pq(const active_pq & apq) {
+    ERRTRACE;
+    if (!apq.conn)
+        return false;
+
+    std::string pq_makeindex("CREATE INDEX IF NOT EXISTS logentries_text_idx ON "+apq.pq_schemaname+".Logentries USING GIN ("+pq_LEtextvector+')');
+    return simple_call_pq(apq.conn,pq_makeindex);
 }
 
 bool add_Breakpoint_pq(const active_pq & apq, const Log_chunk_ID_key & bptopid) {
@@ -102,9 +135,12 @@ bool add_Logchunk_pq(const active_pq & apq, const Log_chunk & chunk) {
     if (!apq.conn)
         return false;
 
-    Logchunk_pq lpq(&chunk);
-    std::string tstr("INSERT INTO "+apq.pq_schemaname + ".Logchunks VALUES "+ lpq.All_Logchunk_Data_pqstr());
-    return simple_call_pq(apq.conn,tstr);
+    std::vector<std::string> params = {
+        TimeStamp_pqparam(chunk.get_open_time()),
+        chunk.get_NodeID().str(),
+        TimeStamp_pqparam(chunk.get_close_time())
+    };
+    return prepared_call_pq(apq.conn, "add_Logchunk_"+apq.pq_schemaname, "INSERT INTO "+apq.pq_schemaname+".Logchunks VALUES ($1,$2,$3)", params);
 }
 
 bool add_Logentry_pq(const active_pq & apq, const Log_entry & entry) {
@@ -112,9 +148,12 @@ bool add_Logentry_pq(const active_pq & apq, const Log_entry & entry) {
     if (!apq.conn)
         return false;
 
-    Logentry_pq epq(&entry);
-    std::string tstr("INSERT INTO "+apq.pq_schemaname + ".Logentries VALUES "+ epq.All_Logentry_Data_pqstr());
-    return simple_call_pq(apq.conn,tstr);
+    std::vector<std::string> params = {
+        entry_id_pqparam(entry),
+        entry.get_nodeidkey().str(),
+        const_cast<Log_entry &>(entry).get_entrytext()
+    };
+    return prepared_call_pq(apq.conn, "add_Logentry_"+apq.pq_schemaname, "INSERT INTO "+apq.pq_schemaname+".Logentries VALUES ($1,$2,$3)", params);
 }
 
 bool modify_Logentry_pq(const active_pq & apq, const Log_entry & entry) {
@@ -122,12 +161,12 @@ bool modify_Logentry_pq(const active_pq & apq, const Log_entry & entry) {
     if (!apq.conn)
         return false;
 
-    Logentry_pq epq(&entry);
-    std::string set_expressions;
-    set_expressions += "nid = " + epq.nid_pqstr() + ',';
-    set_expressions += " text = " + epq.text_pqstr();
-    std::string tstr("UPDATE "+apq.pq_schemaname + ".Logentries SET "+ set_expressions + " WHERE id = " + epq.id_pqstr());
-    return simple_call_pq(apq.conn,tstr);
+    std::vector<std::string> params = {
+        entry.get_nodeidkey().str(),
+        const_cast<Log_entry &>(entry).get_entrytext(),
+        entry_id_pqparam(entry)
+    };
+    return prepared_call_pq(apq.conn, "modify_Logentry_"+apq.pq_schemaname, "UPDATE "+apq.pq_schemaname+".Logentries SET nid = $1, text = $2 WHERE id = $3", params);
 }
 
 bool delete_Logentry_pq(const active_pq & apq, const Log_entry & entry) {
@@ -155,7 +194,7 @@ bool store_Log_pq(const Log & log, Postgres_access & pa, void (*progressfunc)(un
     if (!apq.conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define STORE_LOG_PQ_RETURN(r) { PQfinish(apq.conn); return r; }
+    #define STORE_LOG_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
     apq.pq_schemaname = pa.pq_schemaname();
 
     ERRHERE(".schema");
@@ -226,12 +265,17 @@ bool append_Log_entry_pq(const Log_entry & entry, Postgres_access & pa) {
     if (!apq.conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define STORE_LOG_PQ_RETURN(r) { PQfinish(apq.conn); return r; }
+    #define STORE_LOG_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
     apq.pq_schemaname = pa.pq_schemaname();
 
     ERRHERE(".append");
     if (!add_Logentry_pq(apq, entry)) STORE_LOG_PQ_RETURN(false);
 
+    ERRHERE(".history");
+    if (Node_history_cache_exists_pq(apq) && (!append_Node_history_entry_pq(apq, entry))) {
+        ADDWARNING(__func__, "Node histories cache not updated, run `fzquerypq -R histories` to refresh it");
+    }
+
     STORE_LOG_PQ_RETURN(true);
 }
 
@@ -254,12 +298,17 @@ bool update_Log_entry_pq(const Log_entry & entry, Postgres_access & pa) {
     if (!apq.conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define STORE_LOG_PQ_RETURN(r) { PQfinish(apq.conn); return r; }
+    #define STORE_LOG_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
     apq.pq_schemaname = pa.pq_schemaname();
 
     ERRHERE(".update");
     if (!modify_Logentry_pq(apq, entry)) STORE_LOG_PQ_RETURN(false);
 
+    ERRHERE(".history");
+    if (Node_history_cache_exists_pq(apq) && ((!remove_Node_history_entry_pq(apq, entry)) || (!append_Node_history_entry_pq(apq, entry)))) { // the Node may have changed
+        ADDWARNING(__func__, "Node histories cache not updated, run `fzquerypq -R histories` to refresh it");
+    }
+
     STORE_LOG_PQ_RETURN(true);
 }
 
@@ -277,12 +326,17 @@ bool delete_Log_entry_pq(const Log_entry & entry, Postgres_access & pa) {
     if (!apq.conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define STORE_LOG_PQ_RETURN(r) { PQfinish(apq.conn); return r; }
+    #define STORE_LOG_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
     apq.pq_schemaname = pa.pq_schemaname();
 
     ERRHERE(".delete");
     if (!delete_Logentry_pq(apq, entry)) STORE_LOG_PQ_RETURN(false);
 
+    ERRHERE(".history");
+    if (Node_history_cache_exists_pq(apq) && (!remove_Node_history_entry_pq(apq, entry))) {
+        ADDWARNING(__func__, "Node histories cache not updated, run `fzquerypq -R histories` to refresh it");
+    }
+
     STORE_LOG_PQ_RETURN(true);
 }
 
@@ -305,12 +359,15 @@ bool close_Log_chunk_pq(const Log_chunk & chunk, Postgres_access & pa) {
     if (!apq.conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define CLOSE_LOG_PQ_RETURN(r) { PQfinish(apq.conn); return r; }
+    #define CLOSE_LOG_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
     apq.pq_schemaname = pa.pq_schemaname();
 
     ERRHERE(".close");
-    std::string close_cmd_pq("UPDATE "+apq.pq_schemaname+".Logchunks SET tclose = "+TimeStamp_pq(chunk.get_close_time())+" WHERE id = "+TimeStamp_pq(chunk.get_open_time()));
-    if (!simple_call_pq(apq.conn, close_cmd_pq))
+    std::vector<std::string> params = {
+        TimeStamp_pqparam(chunk.get_close_time()),
+        TimeStamp_pqparam(chunk.get_open_time())
+    };
+    if (!prepared_call_pq(apq.conn, "close_Logchunk_"+apq.pq_schemaname, "UPDATE "+apq.pq_schemaname+".Logchunks SET tclose = $1 WHERE id = $2", params))
         CLOSE_LOG_PQ_RETURN(false);
 
     CLOSE_LOG_PQ_RETURN(true);
@@ -340,12 +397,17 @@ bool append_Log_chunk_pq(const Log_chunk & chunk, Postgres_access & pa) {
     if (!apq.conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define STORE_LOG_PQ_RETURN(r) { PQfinish(apq.conn); return r; }
+    #define STORE_LOG_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
     apq.pq_schemaname = pa.pq_schemaname();
 
     ERRHERE(".append");
     if (!add_Logchunk_pq(apq, chunk)) STORE_LOG_PQ_RETURN(false);
 
+    ERRHERE(".history");
+    if (Node_history_cache_exists_pq(apq) && (!append_Node_history_chunk_pq(apq, chunk))) {
+        ADDWARNING(__func__, "Node histories cache not updated, run `fzquerypq -R histories` to refresh it");
+    }
+
     STORE_LOG_PQ_RETURN(true);
 }
 
@@ -354,13 +416,22 @@ bool insert_Log_chunk_pq(const Log_chunk & chunk, Postgres_access & pa) {
     return append_Log_chunk_pq(chunk, pa);
 }
 
+/**
+ * A Postgres query that returns the Nodes whose histories cache rows list a
+ * Log chunk, as well as the Node that the chunk object specifies.
+ */
+std::string chunk_owners_pq(const active_pq & apq, const Log_chunk & chunk) {
+    return "SELECT nid FROM "+apq.pq_schemaname+".histories WHERE '"+chunk.get_tbegin_str()+"'::char(12) = ANY(chunkids)"
+           " UNION SELECT '"+chunk.get_NodeID().str()+"'::char(16)";
+}
+
 /**
  * Change the Node to which the Chunk specified belongs. The chunk must
  * already exist within a table in schema of PostgreSQL database.
  * 
  * Note:
- * - After changing Chunk ownership the Node histories cache should
- *   be refreshed.
+ * - After changing Chunk ownership, the Node histories cache rows of
+ *   the previous and new owners are rebuilt.
  * 
  * @param chunk A valid Log chunk object with the updated node_id.
  * @param pa Access object with database name and Formalizer schema name.
@@ -373,7 +444,7 @@ bool modify_Log_chunk_nid_pq(const Log_chunk & chunk, Postgres_access & pa) {
     if (!apq.conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define CLOSE_LOG_PQ_RETURN(r) { PQfinish(apq.conn); return r; }
+    #define CLOSE_LOG_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
     apq.pq_schemaname = pa.pq_schemaname();
 
     ERRHERE(".close");
@@ -382,6 +453,11 @@ bool modify_Log_chunk_nid_pq(const Log_chunk & chunk, Postgres_access & pa) {
     if (!simple_call_pq(apq.conn, modify_cmd_pq))
         CLOSE_LOG_PQ_RETURN(false);
 
+    ERRHERE(".history");
+    if (Node_history_cache_exists_pq(apq) && (!rebuild_Node_histories_pq(apq, chunk_owners_pq(apq, chunk)))) {
+        ADDWARNING(__func__, "Node histories cache not updated, run `fzquerypq -R histories` to refresh it");
+    }
+
     CLOSE_LOG_PQ_RETURN(true);
 }
 
@@ -401,7 +477,7 @@ bool modify_Log_chunk_id_pq(const Log_chunk & chunk, time_t new_id, Postgres_acc
     if (!apq.conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define CLOSE_LOG_PQ_RETURN(r) { PQfinish(apq.conn); return r; }
+    #define CLOSE_LOG_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
     apq.pq_schemaname = pa.pq_schemaname();
 
     ERRHERE(".close");
@@ -410,6 +486,11 @@ bool modify_Log_chunk_id_pq(const Log_chunk & chunk, time_t new_id, Postgres_acc
     if (!simple_call_pq(apq.conn, close_cmd_pq))
         CLOSE_LOG_PQ_RETURN(false);
 
+    ERRHERE(".history");
+    if (Node_history_cache_exists_pq(apq) && (!rebuild_Node_histories_pq(apq, chunk_owners_pq(apq, chunk)))) {
+        ADDWARNING(__func__, "Node histories cache not updated, run `fzquerypq -R histories` to refresh it");
+    }
+
     CLOSE_LOG_PQ_RETURN(true);
 }
 
@@ -815,7 +896,7 @@ bool load_Log_pq(Log & log, Postgres_access & pa) {
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_LOG_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define LOAD_LOG_PQ_RETURN(r) { connection_release_pq(conn); return r; }
     active_pq apq(conn,pa.pq_schemaname());
 
     ERRHERE(".chunks");
@@ -945,8 +1026,8 @@ bool parse_PQValues_to_Node_history(PGresult *res, int r, Node_history & nodehis
 bool load_Node_history_cache_entry_pq(active_pq & apq, const Node_ID_key & nkey, Node_history & nodehist) {
     ERRTRACE;
 
-    std::string loadstr("SELECT * FROM "+apq.pq_schemaname+".histories WHERE nid = '"+nkey.str()+"'");
-    if (!query_call_pq(apq.conn, loadstr, false)) {
+    std::string loadstr("SELECT * FROM "+apq.pq_schemaname+".histories WHERE nid = $1");
+    if (!prepared_query_call_pq(apq.conn, "load_history_"+apq.pq_schemaname, loadstr, { nkey.str() }, false)) {
         std::string errstr("Unable to load Node history references from cache table. Perhaps run `fzquerypq -R histories`.");
         ADDERROR(__func__, errstr);
         VERBOSEERR(errstr+'\n');
@@ -992,7 +1073,7 @@ bool load_Node_history_cache_table_pq(Postgres_access & pa, Node_histories & nod
     if (!apq.conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_NHCT_PQ_RETURN(r) { PQfinish(apq.conn); return r; }
+    #define LOAD_NHCT_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
     apq.pq_schemaname = pa.pq_schemaname();
 
     ERRHERE(".load");
@@ -1239,7 +1320,7 @@ bool load_partial_Log_pq(Log & log, Postgres_access & pa, const Log_filter & fil
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_LOG_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define LOAD_LOG_PQ_RETURN(r) { connection_release_pq(conn); return r; }
     active_pq apq(conn,pa.pq_schemaname());
 
     // Create Postgres WHERE statement.
@@ -1377,7 +1458,7 @@ bool store_Node_history_pq(const Node_histories & nodehist, Postgres_access & pa
     if (!apq.conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define STORE_LOG_PQ_RETURN(r) { PQfinish(apq.conn); return r; }
+    #define STORE_LOG_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
     apq.pq_schemaname = pa.pq_schemaname();
 
     ERRHERE(".clear");
@@ -1396,20 +1477,188 @@ bool store_Node_history_pq(const Node_histories & nodehist, Postgres_access & pa
     }
 
     ERRHERE(".cache");
-    for (const auto & [nidkey, historyptr] : nodehist) {
-        std::string insertstr = "INSERT INTO "+tablename+" VALUES ('"+nidkey.str()+"',"+chunk_key_list_pq(historyptr->chunks)+','+entry_key_list_pq(historyptr->entries)+')';
-        if (!simple_call_pq(apq.conn, insertstr)) {
-            ADDERROR(__func__, "Unable to insert values into histories cache table. Postgres command: "+insertstr.substr(0,1024));
-            STORE_LOG_PQ_RETURN(false);
+    // Rows are inserted in batches to avoid a database round trip per Node.
+    constexpr size_t rows_per_insert = 256;
+    std::string insertstr;
+    size_t rows = 0;
+    for (auto it = nodehist.begin(); it != nodehist.end(); ++it) {
+        if (rows == 0) {
+            insertstr = "INSERT INTO "+tablename+" VALUES ";
+        }
+        insertstr += "('"+it->first.str()+"',"+chunk_key_list_pq(it->second->chunks)+','+entry_key_list_pq(it->second->entries)+"),";
+        ++rows;
+        if ((rows >= rows_per_insert) || (std::next(it) == nodehist.end())) {
+            insertstr.pop_back();
+            if (!simple_call_pq(apq.conn, insertstr)) {
+                ADDERROR(__func__, "Unable to insert values into histories cache table. Postgres command: "+insertstr.substr(0,1024));
+                STORE_LOG_PQ_RETURN(false);
+            }
+            rows = 0;
         }
     }
 
     STORE_LOG_PQ_RETURN(true);
 }
 
+/// The Log chunk IDs (YYYYmmddHHMM) of the chunks owned by the Node `nidexpr`, for use in a histories cache query.
+std::string owned_chunk_ids_pq(const std::string & schemaname, const std::string & nidexpr) {
+    return "SELECT to_char(c.id,'YYYYMMDDHH24MI') FROM "+schemaname+".Logchunks c WHERE c.nid = "+nidexpr;
+}
+
+/// Log entries without an explicit Node belong to the Node of their chunk.
+const std::string implicit_entry_nid_pq("(e.nid IS NULL OR e.nid = '' OR e.nid = '" NODE_NULLKEY_STR "')");
+
+/**
+ * The Node histories cache table only exists after it has been created with
+ * `fzquerypq -R histories`. Until then, incremental updates are skipped
+ * quietly.
+ * 
+ * @param apq Access object with active database connection and schema name.
+ * @return True if the histories cache table exists.
+ */
+bool Node_history_cache_exists_pq(const active_pq & apq) {
+    return table_exists_pq(apq.conn, apq.pq_schemaname+".histories");
+}
+
+/**
+ * Add a chunk or entry ID to the histories cache row of a Node, creating the
+ * row if necessary. IDs that are already listed are not added again.
+ * 
+ * @param apq Access object with active database connection and schema name.
+ * @param nidexpr A Postgres expression that provides the Node ID.
+ * @param column Either "chunkids" or "entryids".
+ * @param idstr The Log chunk ID or Log entry ID (as stored in the Log tables).
+ * @return True if the row was updated.
+ */
+bool add_to_Node_history_pq(const active_pq & apq, const std::string & nidexpr, const std::string & column, const std::string & idstr) {
+    bool is_chunk = (column == "chunkids");
+    std::string idpq('\''+idstr+(is_chunk ? "'::char(12)" : "'::char(16)"));
+    std::string insertstr("INSERT INTO "+apq.pq_schemaname+".histories AS h VALUES ("+nidexpr+','
+                          +(is_chunk ? "ARRAY["+idpq+"],'{}'" : "'{}',ARRAY["+idpq+']')
+                          +") ON CONFLICT (nid) DO UPDATE SET "+column+" = array_append(h."+column+','+idpq+") WHERE NOT ("+idpq+" = ANY(h."+column+"))");
+    return simple_call_pq(apq.conn, insertstr);
+}
+
+/**
+ * Update the histories cache row of the Node that owns an appended or
+ * inserted Log chunk.
+ * 
+ * @param apq Access object with active database connection and schema name.
+ * @param chunk A Log chunk that was added to the Log chunks table.
+ * @return True if the histories cache was updated.
+ */
+bool append_Node_history_chunk_pq(const active_pq & apq, const Log_chunk & chunk) {
+    ERRTRACE;
+    return add_to_Node_history_pq(apq, '\''+chunk.get_NodeID().str()+'\'', "chunkids", chunk.get_tbegin_str());
+}
+
+/**
+ * Update the histories cache row of the Node that an appended or inserted
+ * Log entry belongs to. That is either the Node specified by the entry, or
+ * else the Node that owns the chunk the entry is in.
+ * 
+ * @param apq Access object with active database connection and schema name.
+ * @param entry A Log entry that was added to the Log entries table.
+ * @return True if the histories cache was updated.
+ */
+bool append_Node_history_entry_pq(const active_pq & apq, const Log_entry & entry) {
+    ERRTRACE;
+    std::string nidexpr;
+    if (entry.get_nodeidkey().isnullkey()) {
+        nidexpr = "(SELECT nid FROM "+apq.pq_schemaname+".Logchunks WHERE id = "+TimeStamp_pq(Log_chunk_ID_key(entry.get_id_key()).get_epoch_time())+')';
+    } else {
+        nidexpr = '\''+entry.get_nodeidkey().str()+'\'';
+    }
+    return add_to_Node_history_pq(apq, nidexpr, "entryids", entry_id_pqparam(entry));
+}
+
+/**
+ * Remove a Log entry from the histories cache.
+ * 
+ * @param apq Access object with active database connection and schema name.
+ * @param entry A Log entry that was deleted or that changed ownership.
+ * @return True if the histories cache was updated.
+ */
+bool remove_Node_history_entry_pq(const active_pq & apq, const Log_entry & entry) {
+    ERRTRACE;
+    std::string idpq('\''+entry_id_pqparam(entry)+"'::char(16)");
+    return simple_call_pq(apq.conn, "UPDATE "+apq.pq_schemaname+".histories SET entryids = array_remove(entryids,"+idpq+") WHERE "+idpq+" = ANY(entryids)");
+}
+
+/**
+ * Rebuild the histories cache rows of specific Nodes from the Log tables.
+ * 
+ * This is used when a modification can change which Node a Log chunk and
+ * the Log entries within it belong to, so that appending IDs is not
+ * enough. Only the rows of the specified Nodes are rewritten.
+ * 
+ * @param apq Access object with active database connection and schema name.
+ * @param nidsquery A Postgres query that returns the Node IDs.
+ * @return True if the histories cache was updated.
+ */
+bool rebuild_Node_histories_pq(const active_pq & apq, const std::string & nidsquery) {
+    ERRTRACE;
+    std::string rebuildstr("INSERT INTO "+apq.pq_schemaname+".histories"
+                           " SELECT n.nid, ARRAY("+owned_chunk_ids_pq(apq.pq_schemaname, "n.nid")+" ORDER BY c.id)::char(12)[],"
+                           " ARRAY(SELECT e.id FROM "+apq.pq_schemaname+".Logentries e WHERE e.nid = n.nid OR ("+implicit_entry_nid_pq
+                           +" AND SUBSTRING(e.id,1,12) IN ("+owned_chunk_ids_pq(apq.pq_schemaname, "n.nid")+")) ORDER BY e.id)::char(16)[]"
+                           " FROM (SELECT DISTINCT q.nid::char(16) AS nid FROM ("+nidsquery+") AS q(nid) WHERE q.nid IS NOT NULL) AS n"
+                           " ON CONFLICT (nid) DO UPDATE SET chunkids = EXCLUDED.chunkids, entryids = EXCLUDED.entryids");
+    return simple_call_pq(apq.conn, rebuildstr);
+}
+
+/**
+ * Sort and deduplicate the histories cache rows that were updated
+ * incrementally, and remove rows of Nodes that no longer have a history.
+ * 
+ * Incremental updates append IDs in the order in which chunks and entries
+ * are added. That order does not matter to readers of the cache, which
+ * collect the IDs into sets, but compaction keeps the table in the same
+ * form that `store_Node_history_pq()` produces. Only rows that are not in
+ * that form, i.e. rows changed out of order since the last compaction,
+ * are rewritten. Nothing is done if the table does not exist. This is carried out
+ * periodically by the Log server (fzserverpq-log) and can be requested
+ * with `fzquerypq -R compacthistories`.
+ * 
+ * @param pa Access object with valid database and schema identifiers.
+ * @return True if the compaction was successful.
+ */
+bool compact_Node_history_cache_pq(Postgres_access & pa) {
+    ERRTRACE;
+    active_pq apq;
+    apq.conn = connection_setup_pq(pa.dbname());
+    if (!apq.conn) return false;
+
+    #define COMPACT_NHCT_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
+    apq.pq_schemaname = pa.pq_schemaname();
+    std::string tablename(apq.pq_schemaname+".histories");
+    if (!Node_history_cache_exists_pq(apq)) {
+        COMPACT_NHCT_PQ_RETURN(true);
+    }
+
+    ERRHERE(".sort");
+    if (!simple_call_pq(apq.conn, "UPDATE "+tablename+" AS h SET chunkids = c.chunkids, entryids = c.entryids FROM"
+                        " (SELECT nid, ARRAY(SELECT DISTINCT unnest(chunkids) ORDER BY 1) AS chunkids,"
+                        " ARRAY(SELECT DISTINCT unnest(entryids) ORDER BY 1) AS entryids FROM "+tablename+") AS c"
+                        " WHERE h.nid = c.nid AND (h.chunkids IS DISTINCT FROM c.chunkids OR h.entryids IS DISTINCT FROM c.entryids)")) {
+        COMPACT_NHCT_PQ_RETURN(false);
+    }
+
+    ERRHERE(".prune");
+    if (!simple_call_pq(apq.conn, "DELETE FROM "+tablename+" WHERE cardinality(chunkids) = 0 AND cardinality(entryids) = 0")) {
+        COMPACT_NHCT_PQ_RETURN(false);
+    }
+
+    COMPACT_NHCT_PQ_RETURN(true);
+}
+
 /**
  * Refresh the Node history cache table.
  * 
+ * The Log modification functions in this file update the affected rows of
+ * the cache table incrementally. A complete refresh is needed to create the
+ * cache table, or to repair it if an incremental update failed.
+ * 
  * @param pa Access object with valid database and schema identifiers.
  * @return True if the refresh was successful.
  */
@@ -1451,7 +1700,7 @@ bool load_Node_chunk_data_pq(Postgres_access& pa, const Node_ID_key& nkey, Log &
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_NODELOG_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define LOAD_NODELOG_PQ_RETURN(r) { connection_release_pq(conn); return r; }
     active_pq apq(conn,pa.pq_schemaname());
 
     // Create Postgres WHERE statement.
@@ -1461,4 +1710,245 @@ bool load_Node_chunk_data_pq(Postgres_access& pa, const Node_ID_key& nkey, Log &
     LOAD_NODELOG_PQ_RETURN(res);
 }
 
+/**
+ * Rebuild the inverted index of Log entry text.
+ * 
+ * The index is normally created with the Log entries table and then kept up
+ * to date by Postgres. Use this to add it to an existing database.
+ * 
+ * @param pa Access object with valid database and schema identifiers.
+ * @return True if the index was rebuilt.
+ */
+bool refresh_Log_text_index_pq(Postgres_access & pa) {
+    ERRTRACE;
+
+    PGconn* conn = connection_setup_pq(pa.dbname());
+    if (!conn) return false;
+
+    #define REFRESH_TEXTINDEX_PQ_RETURN(r) { connection_release_pq(conn); return r; }
+    active_pq apq(conn,pa.pq_schemaname());
+
+    if (!simple_call_pq(conn, "DROP INDEX IF EXISTS "+apq.pq_schemaname+".logentries_text_idx")) {
+        ADDERROR(__func__, "Unable to drop previous Log entry text index");
+        REFRESH_TEXTINDEX_PQ_RETURN(false);
+    }
+    bool res = create_Logentries_text_index_pq(apq);
+    REFRESH_TEXTINDEX_PQ_RETURN(res);
+}
+
+/**
+ * Find the Log entries that contain search terms, using the inverted index
+ * of Log entry text (see create_Logentries_text_index_pq()).
+ * 
+ * Terms are matched as whole words, regardless of case. Without the index,
+ * as before `fzquerypq -R logsearch`, the search still works but is slow.
+ * 
+ * The index holds no word positions. For a term with several words, it
+ * only finds the entries that contain all of those words, and Postgres
+ * rechecks the word sequence against the text of each of those entries.
+ * 
+ * @param[in] pa Access object with valid database and schema identifiers.
+ * @param[in] search A Log search specification with at least one term.
+ * @param[out] entries Receives the IDs of matching Log entries.
+ * @return True if the search was carried out.
+ */
+bool search_Log_entries_pq(Postgres_access & pa, const Log_search & search, Log_entry_ID_key_set & entries) {
+    ERRTRACE;
+    if (search.terms.empty()) {
+        ERRRETURNFALSE(__func__, "missing search terms");
+    }
+
+    PGconn* conn = connection_setup_pq(pa.dbname());
+    if (!conn) return false;
+
+    #define SEARCH_LOG_PQ_RETURN(r) { connection_release_pq(conn); return r; }
+    active_pq apq(conn,pa.pq_schemaname());
+
+    // Each term is a parameter, so the statement is prepared for each number of terms and combination type.
+    std::vector<std::string> params;
+    std::string querystr;
+    for (const auto & term : search.terms) {
+        params.emplace_back(term);
+        if (!querystr.empty()) {
+            querystr += search.all_terms ? " && " : " || ";
+        }
+        querystr += "phraseto_tsquery('simple', $"+std::to_string(params.size())+')';
+    }
+    params.emplace_back((search.t_from == RTt_unspecified) ? "000000000000" : TimeStampYmdHM(search.t_from));
+    params.emplace_back((search.t_to == RTt_unspecified) ? "999999999999" : TimeStampYmdHM(search.t_to));
+    params.emplace_back(std::to_string(search.limit));
+    size_t n = params.size();
+
+    std::string searchstr("SELECT id FROM "+apq.pq_schemaname+".Logentries WHERE "+pq_LEtextvector+" @@ ("+querystr+")"
+                          " AND SUBSTRING(id,1,12) BETWEEN $"+std::to_string(n-2)+" AND $"+std::to_string(n-1)+
+                          " ORDER BY id DESC LIMIT NULLIF($"+std::to_string(n)+"::bigint, 0)");
+    std::string stmtname("search_entries_"+std::to_string(search.terms.size())+(search.all_terms ? "_all_" : "_any_")+apq.pq_schemaname);
+    if (!prepared_query_call_pq(conn, stmtname, searchstr, params, false)) {
+        SEARCH_LOG_PQ_RETURN(false);
+    }
+
+    PGresult *res;
+
+    while ((res = PQgetResult(conn))) {
+
+        const int rows = PQntuples(res);
+        for (int r = 0; r < rows; ++r) {
+            std::string entryid_str(PQgetvalue(res, r, 0));
+            rtrim(entryid_str);
+            try {
+                const Log_entry_ID entryid(entryid_str);
+                entries.emplace(entryid.key());
+            } catch (ID_exception idexception) {
+                ADDERROR(__func__, "entry with invalid Log entry ID (" + entryid_str + "), " + idexception.what());
+            }
+        }
+
+        PQclear(res);
+    }
+
+    SEARCH_LOG_PQ_RETURN(true);
+}
+
+/**
+ * Load specific Log chunks with all of their entries.
+ * 
+ * See for example how this loads the chunks that contain Log entries found
+ * with search_Log_entries_pq().
+ * 
+ * @param log A Log for the Chunks and Entries, can be empty or may be added to.
+ * @param pa Access object with valid database and schema identifiers.
+ * @param chunks The IDs of the Log chunks to load.
+ * @return True if the Log chunks were successfully loaded.
+ */
+bool load_Log_chunks_pq(Log & log, Postgres_access & pa, const Log_chunk_ID_key_set & chunks) {
+    ERRTRACE;
+    if (chunks.empty()) {
+        return true;
+    }
+
+    PGconn* conn = connection_setup_pq(pa.dbname());
+    if (!conn) return false;
+
+    #define LOAD_CHUNKS_PQ_RETURN(r) { connection_release_pq(conn); return r; }
+    active_pq apq(conn,pa.pq_schemaname());
+
+    std::string chunkwherestr(" WHERE id IN (");
+    std::string entrywherestr(" WHERE SUBSTRING(id,1,12) IN (");
+    chunkwherestr.reserve(30+chunks.size()*24);
+    entrywherestr.reserve(60+chunks.size()*24);
+    for (const auto & chunkidkey : chunks) {
+        time_t t = chunkidkey.get_epoch_time();
+        chunkwherestr += TimeStamp_pq(t) + ',';
+        entrywherestr += '\''+TimeStampYmdHM(t) + "',";
+    }
+    chunkwherestr.back() = ')';
+    entrywherestr.back() = ')';
+
+    ERRHERE(".chunks");
+    if (!read_Chunks_pq(apq, log, chunkwherestr)) LOAD_CHUNKS_PQ_RETURN(false);
+
+    ERRHERE(".entries");
+    bool res = read_Entries_pq(apq, log, entrywherestr);
+    LOAD_CHUNKS_PQ_RETURN(res);
+}
+
+/**
+ * Calculate the total time logged for each of a set of Nodes with two
+ * queries, instead of loading a Log excerpt for each Node.
+ * 
+ * The Node history cache table entries of all of the Nodes are loaded
+ * first, then the Log chunks in all of those histories (without their
+ * entries). The totals are the same as `Chunks_total_minutes()` returns
+ * for a Log excerpt per Node (see `Nodes_logged_minutes()`).
+ * 
+ * @param pa Access object with valid database and schema identifiers.
+ * @param nodes The set of Nodes.
+ * @param t_to Only include Log chunks up to this time (if not RTt_unspecified).
+ * @param[out] minutes Receives the total logged minutes for each Node.
+ * @return True if the necessary data was successfully loaded.
+ */
+bool load_Nodes_logged_minutes_pq(Postgres_access & pa, const base_Node_Set & nodes, time_t t_to, Node_minutes_map & minutes) {
+    ERRTRACE;
+    if (nodes.empty()) {
+        return true;
+    }
+
+    PGconn* conn = connection_setup_pq(pa.dbname());
+    if (!conn) return false;
+
+    #define LOAD_MINUTES_PQ_RETURN(r) { connection_release_pq(conn); return r; }
+    active_pq apq(conn,pa.pq_schemaname());
+
+    ERRHERE(".histories");
+    std::string loadstr("SELECT * FROM "+apq.pq_schemaname+".histories WHERE nid IN (");
+    loadstr.reserve(loadstr.size()+nodes.size()*20);
+    for (const auto & nkey : nodes) {
+        loadstr += '\''+nkey.str()+"',";
+    }
+    loadstr.back() = ')';
+    if (!query_call_pq(apq.conn, loadstr, false)) {
+        std::string errstr("Unable to load Node history references from cache table. Perhaps run `fzquerypq -R histories`.");
+        ADDERROR(__func__, errstr);
+        VERBOSEERR(errstr+'\n');
+        LOAD_MINUTES_PQ_RETURN(false);
+    }
+
+    Node_histories histories;
+    PGresult *res;
+    while ((res = PQgetResult(apq.conn))) {
+
+        const int rows = PQntuples(res);
+        if ((PQnfields(res)<3) || (!get_History_pq_field_numbers(res))) {
+            ADDERROR(__func__,"not enough fields in histories cache table");
+            PQclear(res);
+            LOAD_MINUTES_PQ_RETURN(false);
+        }
+
+        for (int r = 0; r < rows; ++r) {
+            std::string nodeid_str;
+            history_ptr nodehist_ptr = std::make_unique<Node_history>();
+            if (!parse_PQValues_to_Node_history(res, r, *(nodehist_ptr.get()), nodeid_str)) {
+                ADDERROR(__func__, "Parsing query response for Node_history failed");
+                PQclear(res);
+                LOAD_MINUTES_PQ_RETURN(false);
+            }
+            try {
+                histories.emplace(Node_ID_key(nodeid_str), std::move(nodehist_ptr));
+            } catch (ID_exception idexception) {
+                ADDERROR(__func__,"Invalid Node ID ["+nodeid_str+"], "+idexception.what());
+                PQclear(res);
+                LOAD_MINUTES_PQ_RETURN(false);
+            }
+        }
+
+        PQclear(res);
+    }
+
+    ERRHERE(".chunks");
+    Log_chunk_ID_key_set chunks;
+    for (const auto & [nkey, nodehist_ptr] : histories) {
+        chunks.insert(nodehist_ptr->chunks.begin(), nodehist_ptr->chunks.end());
+        for (const auto & entry_key : nodehist_ptr->entries) { // chunks that hold the Node's entries, as in add_surrounding_chunks()
+            chunks.emplace(entry_key);
+        }
+    }
+    Log log;
+    if (!chunks.empty()) {
+        std::string chunkwherestr(" WHERE id IN (");
+        chunkwherestr.reserve(30+chunks.size()*24);
+        for (const auto & chunkidkey : chunks) {
+            chunkwherestr += TimeStamp_pq(chunkidkey.get_epoch_time()) + ',';
+        }
+        chunkwherestr.back() = ')';
+        if (t_to != RTt_unspecified) {
+            chunkwherestr += " AND id <= " + TimeStamp_pq(t_to);
+        }
+        if (!read_Chunks_pq(apq, log, chunkwherestr)) LOAD_MINUTES_PQ_RETURN(false);
+    }
+
+    Nodes_logged_minutes(log, histories, nodes, t_to, minutes);
+
+    LOAD_MINUTES_PQ_RETURN(true);
+}
+
 } // namespace fz
@@ -825,6 +825,49 @@ bool Log::add_entries_to_chunks() {
     return true;
 }
 
+/**
+ * Remove a Log chunk and the Log entries it contains.
+ * 
+ * Note that Node chain references of other chunks and entries may refer to
+ * the removed objects until `setup_Chain_nodeprevnext()` is called again.
+ * 
+ * @param chunk_key The ID key of the Log chunk to remove.
+ */
+void Log::remove_Chunk(const Log_chunk_ID_key & chunk_key) {
+    auto it = chunks.find(chunk_key);
+    if (it == chunks.end()) {
+        return;
+    }
+    for (const auto & entryptr : it->second->get_entries()) {
+        entries.erase(entryptr->get_id_key());
+    }
+    chunks.erase(it);
+}
+
+/**
+ * Move the Log chunks and Log entries of another Log into this Log.
+ * 
+ * This is used to extend a memory-resident Log with chunks and entries
+ * loaded separately, e.g. by `load_partial_Log_pq()`. The other Log should
+ * begin after the newest chunk of this Log, and it is empty afterwards.
+ * Entries keep their chunk references, because the chunk objects are
+ * moved, not copied.
+ * 
+ * Call `setup_Chain_nodeprevnext()` afterwards.
+ * 
+ * @param newer A Log with chunks and entries that are newer than those in this Log.
+ */
+void Log::append_Log(Log & newer) {
+    for (auto & [chunk_key, chunkptr] : newer.chunks) {
+        chunks.emplace(chunk_key, std::move(chunkptr));
+    }
+    for (auto & [entry_key, entryptr] : newer.entries) {
+        entries.emplace(entry_key, std::move(entryptr));
+    }
+    newer.chunks.clear();
+    newer.entries.clear();
+}
+
 /*
 *** This was not quite implemented to the point where it works, as it turned out that I didn't need it yet.
 void Log::add_earlier_unique_Chunk(const Log_TimeStamp &_tbegin, const Node_ID &_nodeid, std::time_t _tclose) {
@@ -1083,6 +1126,36 @@ std::string Log_filter::info_str() const {
     return infostr;
 }
 
+/**
+ * Express the filter as the arguments of a Log server API request, e.g.
+ * `from=1617123600&limit=5`. See fzserverpq-log.
+ */
+std::string Log_filter::GET_args() const {
+    std::string argstr;
+    if (t_from != RTt_unspecified) {
+        argstr += "&from="+std::to_string(t_from);
+    }
+    if (t_to != RTt_unspecified) {
+        argstr += "&to="+std::to_string(t_to);
+    }
+    if (!nkey.isnullkey()) {
+        argstr += "&node="+nkey.str();
+    }
+    if (limit > 0) {
+        argstr += "&limit="+std::to_string(limit);
+    }
+    if (back_to_front) {
+        argstr += "&back=true";
+    }
+    if (chunks_only) {
+        argstr += "&chunks_only=true";
+    }
+    if (!argstr.empty()) {
+        argstr.erase(0, 1);
+    }
+    return argstr;
+}
+
 /**
  * Generate a set of Log chunk ID keys that corresponds to the ID keys of all
  * entries in the Log.
@@ -1118,38 +1191,69 @@ void Node_history::add_surrounding_chunks() {
  */
 void Node_histories::init(Log & log, bool explicit_only) {
     for (const auto & [chunk_key, chunk] : log.get_Chunks()) {
-        Node_ID_key nkey(chunk->get_NodeID().key());
-        if (nkey.isnullkey())
-            continue; // This would actually be an error...
-        
-        auto it = find(nkey);
-        if (it == end()) {
-            history_ptr hptr = std::make_unique<Node_history>();
-            hptr->chunks.emplace(chunk->get_tbegin_key());
-            emplace(nkey, std::move(hptr));
+        add_chunk(*chunk);
+    }
+    for (const auto & [entrykey, entryptr] : log.get_Entries()) {
+        add_entry(*entryptr, explicit_only);
+    }
+}
+
+/// Add a Log chunk to the history of the Node it belongs to.
+void Node_histories::add_chunk(const Log_chunk & chunk) {
+    Node_ID_key nkey(chunk.get_NodeID().key());
+    if (nkey.isnullkey())
+        return; // This would actually be an error...
+    
+    auto it = find(nkey);
+    if (it == end()) {
+        history_ptr hptr = std::make_unique<Node_history>();
+        hptr->chunks.emplace(chunk.get_tbegin_key());
+        emplace(nkey, std::move(hptr));
+    } else {
+        it->second->chunks.emplace(chunk.get_tbegin_key());
+    }
+}
+
+/**
+ * Add a Log entry to the history of the Node it belongs to. Unless
+ * `explicit_only`, an entry without Node belongs to the Node of its chunk.
+ */
+void Node_histories::add_entry(Log_entry & entry, bool explicit_only) {
+    Node_ID_key nkey(entry.get_nodeidkey());
+    if (nkey.isnullkey()) { // belongs to the same Node as the surrounding chunk
+        if (explicit_only) {
+            return;
         } else {
-            it->second->chunks.emplace(chunk->get_tbegin_key());
+            nkey = entry.get_Chunk()->get_NodeID().key(); // *** Mildly risky, there should really be no nullptr here.
         }
     }
-    for (const auto & [entrykey, entryptr] : log.get_Entries()) {
+    if (nkey.isnullkey())
+        return; // This would actually be an error...
+    
+    auto it = find(nkey);
+    if (it == end()) {
+        history_ptr hptr = std::make_unique<Node_history>();
+        hptr->entries.emplace(entry.get_id_key());
+        emplace(nkey, std::move(hptr));
+    } else {
+        it->second->entries.emplace(entry.get_id_key());
+    }
+}
+
+/// Remove a Log chunk and the Log entries it contains from the Node histories.
+void Node_histories::remove_chunk(Log_chunk & chunk) {
+    Node_history * chunk_history = history(chunk.get_NodeID().key());
+    if (chunk_history) {
+        chunk_history->chunks.erase(chunk.get_tbegin_key());
+    }
+    for (const auto & entryptr : chunk.get_entries()) {
         Node_ID_key nkey(entryptr->get_nodeidkey());
-        if (nkey.isnullkey()) { // belongs to the same Node as the surrounding chunk
-            if (explicit_only) {
-                continue;
-            } else {
-                nkey = entryptr->get_Chunk()->get_NodeID().key(); // *** Mildly risky, there should really be no nullptr here.
-            }
+        if (nkey.isnullkey()) {
+            nkey = chunk.get_NodeID().key();
         }
-        if (nkey.isnullkey())
-            continue; // This would actually be an error...
-        
-        auto it = find(nkey);
-        if (it == end()) {
-            history_ptr hptr = std::make_unique<Node_history>();
-            hptr->entries.emplace(entrykey);
-            emplace(nkey, std::move(hptr));
-        } else {
-            it->second->entries.emplace(entrykey);
+        Node_history * entry_history = history(nkey);
+        if (entry_history) {
+            entry_history->entries.erase(entryptr->get_id_key());
         }
     }
 }
@@ -1225,6 +1329,212 @@ Log_chain_target Node_histories::newest(const Node_ID_key & nkey) {
     }
 }
 
+/**
+ * Select the Log chunks of a memory-resident Log that satisfy a filter.
+ * 
+ * This follows the same rules as `load_partial_Log_pq()`, so that a Log
+ * server can answer requests with the same Log excerpt that would be
+ * loaded from the database:
+ * - t_from and t_to bound the chunk IDs and override limit.
+ * - limit selects n chunks from the front (or from the back if
+ *   back_to_front, or n before and including t_to).
+ * - nkey selects the n most recent chunks in the Node history, plus the
+ *   chunks that contain the Node's entries, within the t_from and t_to bounds.
+ * 
+ * @param log A memory-resident Log.
+ * @param histories Node histories of the Log (see `Node_histories::init()`).
+ * @param filter A selective Log reading filter structure.
+ * @return The set of ID keys of selected Log chunks.
+ */
+Log_chunk_ID_key_set Log_excerpt_chunks(Log & log, Node_histories & histories, const Log_filter & filter) {
+    Log_chunk_ID_key_set chunkkeys;
+    bool use_t_from = filter.t_from != RTt_unspecified;
+    bool use_t_to = filter.t_to != RTt_unspecified;
+    bool use_nkey = !filter.nkey.isnullkey();
+    if (use_t_from && use_t_to && (filter.t_from > filter.t_to))
+        return chunkkeys;
+    if (use_t_from && (filter.t_from > std::time(nullptr)))
+        return chunkkeys;
+
+    // Chunk IDs have minute resolution, so the bounds are compared as stamps.
+    Log_TimeStamp from_stamp(use_t_from ? (filter.t_from + 59) : 0);
+    Log_TimeStamp to_stamp(use_t_to ? filter.t_to : 0);
+    auto after_t_from = [&](const Log_chunk_ID_key & chunkkey) {
+        return (!use_t_from) || (!(chunkkey.idT < from_stamp));
+    };
+    auto before_t_to = [&](const Log_chunk_ID_key & chunkkey) {
+        return (!use_t_to) || (!(to_stamp < chunkkey.idT));
+    };
+
+    if (use_nkey) {
+        Node_history * nodehist = histories.history(filter.nkey);
+        if (!nodehist)
+            return chunkkeys;
+
+        unsigned long n = 0;
+        for (auto it = nodehist->chunks.rbegin(); it != nodehist->chunks.rend(); ++it) {
+            if ((filter.limit > 0) && (n >= filter.limit))
+                break;
+            chunkkeys.emplace(*it);
+            ++n;
+        }
+        for (const auto & entry_key : nodehist->entries) {
+            chunkkeys.emplace(entry_key);
+        }
+        for (auto it = chunkkeys.begin(); it != chunkkeys.end(); ) {
+            if (after_t_from(*it) && before_t_to(*it)) {
+                ++it;
+            } else {
+                it = chunkkeys.erase(it);
+            }
+        }
+        return chunkkeys;
+    }
+
+    unsigned long limit = filter.limit;
+    if (use_t_from && use_t_to) {
+        limit = 0; // Having both t_from and t_to overrides limit.
+    }
+    bool back_to_front = filter.back_to_front;
+    if (use_t_from || use_t_to) {
+        back_to_front = false; // Selection direction is meaningless if t_from or t_to are specified.
+    }
+    if (use_t_to && (!use_t_from) && (limit > 0)) {
+        back_to_front = true; // Special case to get n before and including t_to.
+    }
+
+    if (back_to_front) {
+        for (auto it = log.get_Chunks().rbegin(); it != log.get_Chunks().rend(); ++it) {
+            if ((limit > 0) && (chunkkeys.size() >= limit))
+                break;
+            if (!before_t_to(it->first))
+                continue;
+            if (!after_t_from(it->first))
+                break;
+            chunkkeys.emplace(it->first);
+        }
+    } else {
+        for (const auto & [chunkkey, chunkptr] : log.get_Chunks()) {
+            if ((limit > 0) && (chunkkeys.size() >= limit))
+                break;
+            if (!after_t_from(chunkkey))
+                continue;
+            if (!before_t_to(chunkkey))
+                break;
+            chunkkeys.emplace(chunkkey);
+        }
+    }
+    return chunkkeys;
+}
+
+/**
+ * Serialize Log chunks and their entries.
+ * 
+ * The format begins with a `FZLOG` line, followed by one line per chunk
+ * and one record per entry, where the entry text is preceded by its length
+ * so that it can contain any characters:
+ * 
+ *   C <chunk-id> <node-id> <t-close>
+ *   E <entry-id> <node-id|-> <text-length>
+ *   <text>
+ * 
+ * @param log A Log that contains the chunks.
+ * @param chunks ID keys of the chunks to serialize (see `Log_excerpt_chunks()`).
+ * @param chunks_only If true then entries are not included.
+ * @return The serialized Log excerpt.
+ */
+std::string serialize_Log_excerpt(Log & log, const Log_chunk_ID_key_set & chunks, bool chunks_only) {
+    std::string serstr("FZLOG\n");
+    for (const auto & chunkkey : chunks) {
+        Log_chunk * chunk = const_cast<Log_chunk *>(log.get_chunk(chunkkey));
+        if (!chunk)
+            continue;
+
+        serstr += "C "+chunk->get_tbegin_str()+' '+chunk->get_NodeID().str()+' '+std::to_string(chunk->get_close_time())+'\n';
+        if (chunks_only)
+            continue;
+
+        for (const auto & entry : chunk->get_entries()) {
+            const std::string & text = entry->get_entrytext();
+            serstr += "E "+entry->get_id_str()+' '+(entry->same_node_as_chunk() ? std::string("-") : entry->get_nodeidkey().str())+' '+std::to_string(text.size())+'\n';
+            serstr += text;
+            serstr += '\n';
+        }
+    }
+    return serstr;
+}
+
+/**
+ * Add the Log chunks and Log entries in a serialized Log excerpt (see
+ * `serialize_Log_excerpt()`) to a Log.
+ * 
+ * Chunks and entries that are already in the Log are skipped, so that
+ * excerpts can be added to the same Log. The entry text was already made
+ * utf8 safe when the serialized Log was loaded.
+ * 
+ * @param serstr A serialized Log excerpt.
+ * @param log A Log for the Chunks and Entries, can be empty or may be added to.
+ * @return True if the excerpt was successfully parsed.
+ */
+bool deserialize_Log_excerpt(const std::string & serstr, Log & log) {
+    ERRTRACE;
+    if (serstr.compare(0, 6, "FZLOG\n") != 0)
+        ERRRETURNFALSE(__func__, "not a serialized Log excerpt");
+
+    size_t pos = 6;
+    while (pos < serstr.size()) {
+        size_t eol = serstr.find('\n', pos);
+        if (eol == std::string::npos)
+            ERRRETURNFALSE(__func__, "truncated serialized Log excerpt");
+
+        std::string recordstr(serstr.substr(pos, eol - pos));
+        pos = eol + 1;
+        auto fields = split(recordstr, ' ');
+        if ((fields.size() != 4) || ((fields[0] != "C") && (fields[0] != "E")))
+            ERRRETURNFALSE(__func__, "unrecognized record in serialized Log excerpt: "+recordstr);
+
+        try {
+            if (fields[0] == "C") {
+                const Log_chunk_ID_key chunkkey(fields[1]);
+                if (!log.get_chunk(chunkkey)) {
+                    log.add_Chunk(chunkkey.idT, Node_ID(fields[2]), std::stol(fields[3]));
+                }
+                continue;
+            }
+
+            size_t textlen = std::stoul(fields[3]);
+            if ((pos + textlen) > serstr.size())
+                ERRRETURNFALSE(__func__, "truncated text of Log entry ["+fields[1]+']');
+            size_t textpos = pos;
+            pos += textlen + 1;
+
+            const Log_entry_ID_key entrykey(fields[1]);
+            if (log.get_Entries().find(entrykey) != log.get_Entries().end())
+                continue;
+
+            const Log_chunk * chunk = log.get_chunk(Log_chunk_ID_key(entrykey));
+            if (!chunk)
+                ERRRETURNFALSE(__func__, "serialized Entry ("+fields[1]+") refers to Log chunk not found in Log");
+
+            std::unique_ptr<Log_entry> entry;
+            if (fields[2] == "-") {
+                entry = std::make_unique<Log_entry>(entrykey.idT, std::string(), chunk);
+            } else {
+                entry = std::make_unique<Log_entry>(entrykey.idT, std::string(), Node_ID_key(fields[2]), chunk);
+            }
+            entry->set_text_unchecked(serstr.substr(textpos, textlen));
+            const_cast<Log_chunk *>(chunk)->add_Entry(*entry);
+            log.get_Entries().insert({entrykey, std::move(entry)}); // entry is now nullptr
+
+        } catch (ID_exception idexception) {
+            ERRRETURNFALSE(__func__, "invalid ID in serialized Log excerpt, "+std::string(idexception.what()));
+        } catch (std::exception & e) {
+            ERRRETURNFALSE(__func__, "invalid number in serialized Log excerpt, "+std::string(e.what()));
+        }
+    }
+    return true;
+}
+
 // +----- begin: friend functions -----+
 
 /**
@@ -1360,6 +1670,37 @@ unsigned long Chunks_total_minutes(Log_chunks_Map & chunks) {
     return std::accumulate(chunks.begin(), chunks.end(), (unsigned long) 0, duration_adder);
 }
 
+/**
+ * Calculate the total time logged for each of a set of Nodes.
+ * 
+ * For each Node, the Log chunks are selected as `Log_excerpt_chunks()`
+ * selects them for a filter that specifies the Node and `t_to`, so that
+ * the result is the same as that of `Chunks_total_minutes()` applied to
+ * a separately requested Log excerpt for each Node. The Log needs to
+ * contain at least those chunks.
+ * 
+ * @param log A Log that contains the Log chunks in the Node histories.
+ * @param histories Node histories that include the specified Nodes.
+ * @param nodes The set of Nodes.
+ * @param t_to Only include Log chunks up to this time (if not RTt_unspecified).
+ * @param[out] minutes Receives the total logged minutes for each Node.
+ */
+void Nodes_logged_minutes(Log & log, Node_histories & histories, const base_Node_Set & nodes, time_t t_to, Node_minutes_map & minutes) {
+    Log_filter filter;
+    filter.t_to = t_to;
+    for (const auto & nkey : nodes) {
+        filter.nkey = nkey;
+        unsigned long total = 0;
+        for (const auto & chunkkey : Log_excerpt_chunks(log, histories, filter)) {
+            const Log_chunk * chunk = log.get_chunk(chunkkey);
+            if (chunk) {
+                total += chunk->duration_minutes();
+            }
+        }
+        minutes[nkey] = total;
+    }
+}
+
 /**
  * Calculate the total number of characters in Log entry description text in the
  * specified map.
@@ -243,8 +243,7 @@ time_t Log_TimeStamp::get_epoch_time() const {
     if (isnullstamp())
         return -1;
 
-    std::tm tm(get_local_time());
-    return mktime(&tm);
+    return local_epoch_time(year, month, day, hour, minute);
 }
 
 
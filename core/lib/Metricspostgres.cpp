@@ -53,7 +53,7 @@ bool store_Metrics_data_pq(const Metrics_data & data, Postgres_access & pa) {
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define STORE_DATA_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define STORE_DATA_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     active_pq apq(conn,pa.pq_schemaname());
     if (!create_Metrics_table(apq, data.tablename, data.layout())) {
@@ -83,7 +83,7 @@ bool read_Metrics_data_pq(Metrics_data & data, Postgres_access & pa) {
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_DATA_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define LOAD_DATA_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     std::string pqcmdstr = "SELECT data FROM "+pa.pq_schemaname()+ "." + data.tablename+" WHERE id="+data.idstr();
     if (!query_call_pq(conn, pqcmdstr, false)) LOAD_DATA_PQ_RETURN(false);
@@ -128,7 +128,7 @@ bool read_Metrics_IDs_pq(Metrics_data & data, Postgres_access & pa, std::vector<
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_DATA_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define LOAD_DATA_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     std::string pqcmdstr = "SELECT id FROM "+pa.pq_schemaname()+ "." + data.tablename;
     if (!query_call_pq(conn, pqcmdstr, false)) LOAD_DATA_PQ_RETURN(false);
@@ -175,7 +175,7 @@ bool read_Metrics_IDs_and_data_interval_pq(Metrics_data_list & datalist, Postgre
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define LOAD_IDS_AND_DATA_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define LOAD_IDS_AND_DATA_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     std::string pqcmdstr = "SELECT id, data FROM "+pa.pq_schemaname()+ "." + datalist.tablename+" WHERE id>='"+id_start+"' AND id<='"+id_end+'\'';
     if (!query_call_pq(conn, pqcmdstr, false)) LOAD_IDS_AND_DATA_PQ_RETURN(false);
@@ -220,7 +220,7 @@ bool delete_Metrics_data_pq(const Metrics_data & data, Postgres_access & pa) {
     if (!apq.conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define DELETE_DATA_PQ_RETURN(r) { PQfinish(apq.conn); return r; }
+    #define DELETE_DATA_PQ_RETURN(r) { connection_release_pq(apq.conn); return r; }
     apq.pq_schemaname = pa.pq_schemaname();
 
     ERRHERE(".delete");
@@ -240,7 +240,7 @@ bool delete_Metrics_table_pq(const std::string& tablename, Postgres_access & pa)
     std::string tstr("DROP TABLE IF EXISTS "+apq.pq_schemaname+"." + tablename);
     bool r = simple_call_pq(apq.conn, tstr);
 
-    PQfinish(apq.conn);
+    connection_release_pq(apq.conn);
     return r;
 }
 
@@ -251,7 +251,7 @@ bool count_Metrics_table_pq(Metrics_data & data, Postgres_access & pa) {
     if (!conn) return false;
 
     // Define a clean return that closes the connection to the database and cleans up.
-    #define COUNT_DATA_PQ_RETURN(r) { PQfinish(conn); return r; }
+    #define COUNT_DATA_PQ_RETURN(r) { connection_release_pq(conn); return r; }
 
     std::string pqcmdstr = "SELECT count(*) AS exact_count FROM "+pa.pq_schemaname()+ "." + data.tablename;
     if (!query_call_pq(conn, pqcmdstr, false)) COUNT_DATA_PQ_RETURN(false);
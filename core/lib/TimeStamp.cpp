@@ -3,6 +3,8 @@
 
 // std
 #include <cerrno>
+#include <climits>
+#include <cstdint>
 #include <tuple>
 
 // core
@@ -86,6 +88,46 @@ const std::tm * safe_localtime(const std::time_t * t_ptr, int * errorcode_ptr) {
     return &safe_max_localtime;
 }
 
+std::time_t local_epoch_time(int year, int month, int day, int hour, int minute, int second) {
+    struct hour_start {
+        uint32_t ymdh = 0;
+        bool regular = false; ///< False if the hour is near a UTC offset change.
+        std::time_t t = 0;
+    };
+    static thread_local hour_start cache[256];
+
+    auto make_time = [&](int min, int sec) {
+        std::tm tm = { 0 };
+        tm.tm_year = year-1900;
+        tm.tm_mon = month-1;
+        tm.tm_mday = day;
+        tm.tm_hour = hour;
+        tm.tm_min = min;
+        tm.tm_sec = sec;
+        tm.tm_isdst = -1; // this tells mktime to determine if DST is in effect
+        return mktime(&tm);
+    };
+
+    uint32_t ymdh = (uint32_t(year) << 20) | (uint32_t(month) << 16) | (uint32_t(day) << 8) | uint32_t(hour);
+    hour_start & slot = cache[(ymdh ^ (ymdh >> 8)) & 0xff];
+    if (slot.ymdh != ymdh) {
+        slot.t = make_time(0, 0);
+        slot.ymdh = ymdh;
+        // Near a UTC offset change local times can be skipped or ambiguous (some zones
+        // shift by half an hour), so leave those hours to mktime().
+        auto gmtoff = [](std::time_t t) {
+            std::tm tm;
+            return (localtime_r(&t, &tm) != nullptr) ? tm.tm_gmtoff : LONG_MIN;
+        };
+        long offset = gmtoff(slot.t);
+        slot.regular = (offset != LONG_MIN) && (gmtoff(slot.t - 2*3600) == offset) && (gmtoff(slot.t + 3*3600) == offset);
+    }
+    if (!slot.regular) {
+        return make_time(minute, second);
+    }
+    return slot.t + 60*minute + second;
+}
+
 /**
  * Convert a Formalizer time stamp string into local Unix time.
  * 
@@ -2,6 +2,8 @@
 // License TBD
 
 // std
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 
@@ -18,26 +20,69 @@ bool mute_error = false;
 Errors ErrQ(DEFAULT_ERRLOGPATH);
 Errors WarnQ(DEFAULT_WARNLOGPATH);
 
-#ifdef NO_ERR_TRACE
-
-std::string errhint;
-
-#else
+/**
+ * Copy a trace record. A milestone that was copied into the source record
+ * is copied into this record's own buffer.
+ */
+Trace_Record & Trace_Record::operator=(const Trace_Record & record) {
+    label = record.label;
+    if (record.milestone == record.milestone_buf) {
+        std::memcpy(milestone_buf, record.milestone_buf, sizeof(milestone_buf));
+        milestone = milestone_buf;
+    } else {
+        milestone = record.milestone;
+    }
+    return *this;
+}
 
-Stack_Tracer errtracer;
+/// Set a label and a milestone composed at run-time, which is copied (and truncated if necessary).
+void Trace_Record::set(const char * _label, const std::string & _milestone) {
+    label = _label;
+    size_t len = std::min(_milestone.size(), sizeof(milestone_buf)-1);
+    std::memcpy(milestone_buf, _milestone.data(), len);
+    milestone_buf[len] = '\0';
+    milestone = milestone_buf;
+}
 
-/// Compose the full stack trace into one string. (Brackets are added by Errors::pretty_print().)
-std::string Stack_Tracer::print() {
+/// Format the trace (or time) at which the error occurred. (Brackets are added by Errors::pretty_print().)
+std::string Error_Instance::tracehint() const {
+    if (timestamped) {
+        return TimeStampYmdHM(t);
+    }
     std::string tracestr;
-    tracestr.reserve(errtracer.num_levels()*20);
-    for (StackTrace::size_type i = 0; i < errtracer.num_levels(); ++i) {
+    tracestr.reserve(trace.size()*20);
+    for (size_t i = 0; i < trace.size(); ++i) {
         if (i!=0)
             tracestr += ':';
-        tracestr += errtracer[i];
+        trace[i].append_to(tracestr);
     }
     return tracestr;
 }
 
+#ifdef NO_ERR_TRACE
+
+thread_local Trace_Record errhint;
+
+#else
+
+thread_local Stack_Tracer errtracer;
+
+/// Copy the recorded levels of the stack trace. Unrecorded deeper levels are indicated by "...".
+Trace_Snapshot Stack_Tracer::snapshot() const {
+    Trace_Snapshot trace(levels, levels + std::min(depth, max_levels));
+    if (depth > max_levels) {
+        trace.emplace_back("...");
+    }
+    return trace;
+}
+
+/// Compose the full stack trace into one string. (Brackets are added by Errors::pretty_print().)
+std::string Stack_Tracer::print() const {
+    Error_Instance e;
+    e.trace = snapshot();
+    return e.tracehint();
+}
+
 #endif
 
 err_configbase::err_configbase(): configbase("error") {
@@ -80,26 +125,21 @@ void Errors::push(std::string f, std::string e) {
     if (e.empty())
         e = "unspecified";
 
-#ifdef NO_ERR_TRACE
+    std::lock_guard<std::recursive_mutex> lock(errq_mutex);
 
     if (trace_or_time) {
+#ifdef NO_ERR_TRACE
         // push the hint on with the function and error message
-        errq.push_back(Error_Instance(errhint, f, e));
-    } else {
-        errq.push_back(TimeStampYmdHM(ActualTime()), f, e);
-    }
-
+        errq.emplace_back(Trace_Snapshot(1, errhint), std::move(f), std::move(e));
 #else
-
-    if (trace_or_time) {
         // push the stack trace on with the function and error message
-        errq.emplace_back(Error_Instance(errtracer.print(),f,e));
+        errq.emplace_back(errtracer.snapshot(), std::move(f), std::move(e));
+#endif
     } else {
-        errq.emplace_back(Error_Instance(TimeStampYmdHM(ActualTime()), f, e));
+        // the time is formatted when errors are printed
+        errq.emplace_back(ActualTime(), std::move(f), std::move(e));
     }
 
-#endif
-
     if (!caching) {
         if (numflushed<1)
             output(ERRWARN_LOG_MODE);
@@ -114,8 +154,9 @@ void Errors::push(std::string f, std::string e) {
  * @return content of the oldest error instance or empty instance if the queue was empty.
  */
 Error_Instance Errors::pop() {
+    std::lock_guard<std::recursive_mutex> lock(errq_mutex);
     if (errq.size() < 1)
-        return Error_Instance("", "", "");
+        return Error_Instance();
     Error_Instance e(errq.front());
     errq.pop_front();
     ++numflushed;
@@ -128,6 +169,7 @@ Error_Instance Errors::pop() {
  * @return number of errors that were in the error queue when it was cleared.
  */
 int Errors::flush() {
+    std::lock_guard<std::recursive_mutex> lock(errq_mutex);
     int s = errq.size();
     numflushed += s;
     errq.clear();
@@ -148,6 +190,7 @@ std::string Errors::print_updated_timecode() {
  * @return string of error content in order of occurrence.
  */
 std::string Errors::pretty_print() {
+    std::lock_guard<std::recursive_mutex> lock(errq_mutex);
     std::string estr;
 
     // If this is the first output, or if a day has passed since the last time code then include one.
@@ -163,7 +206,7 @@ std::string Errors::pretty_print() {
     }
 
     for (auto it = errq.cbegin(); it != errq.cend(); ++it)
-        estr += '[' + it->tracehint + "] " + it->func + ": " + it->err + '\n';
+        estr += '[' + it->tracehint() + "] " + it->func + ": " + it->err + '\n';
 
     return estr;
 }
@@ -178,6 +221,7 @@ std::string Errors::pretty_print() {
  * @param mode output mode.
  */
 void Errors::output(std::ofstream::openmode mode) {
+    std::lock_guard<std::recursive_mutex> lock(errq_mutex);
     if (num()>0) {
 
         if (get_errfilepath().empty()) set_errfilepath(DEFAULT_ERRLOGPATH);
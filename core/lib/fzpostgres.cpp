@@ -3,6 +3,7 @@
 
 // std
 #include <algorithm>
+#include <ctime>
 
 // core
 #include "error.hpp"
@@ -14,40 +15,52 @@ namespace fz {
 
 Simulate_PQ_Changes SimPQ;
 
+pq_connection_pool pq_pool;
+
+std::string pq_application_name;
+
+std::atomic<unsigned long> pq_failed_changes{0};
+
 const std::string pq_commands_str[_pqcommand_NUM] = {
     "runsilent",
     "log",
     "simulate"};
 
 /**
- * Set up a connection with an existing Postgres database.
+ * Open a new connection with an existing Postgres database.
  * 
- * This also prepares a safe search search path. The database needs to exist.
- * If necessary, create it with the command `createdb [databasename]` (which
- * defaults to the user name).
+ * This also prepares a safe search search path.
  * 
  * @param: dbname the identifier of a database in a local Postgres setup.
  * @return a pointer to the connection if successfully created, otherwise NULL.
  */
-PGconn* connection_setup_pq(std::string dbname) {
+PGconn* connection_open_pq(std::string dbname) {
 
     PGconn     *conn;
     PGresult   *res;
 
     if (dbname.empty()) ERRRETURNNULL(__func__, "missing database identifier");
     dbname.insert(0, "dbname = ");
+    if (!pq_application_name.empty()) {
+        dbname += " application_name = "+pq_application_name;
+    }
 
     // Make a connection to the database
     conn = PQconnectdb(dbname.c_str());
 
     //Check to see that the backend connection was successfully made
-    if (PQstatus(conn) != CONNECTION_OK) ERRRETURNNULL(__func__, std::string("connection to database failed: ")+PQerrorMessage(conn));
+    if (PQstatus(conn) != CONNECTION_OK) {
+        ADDERROR(__func__, std::string("connection to database failed: ")+PQerrorMessage(conn));
+        PQfinish(conn);
+        return NULL;
+    }
 
     // Set always-secure search path, so malicious users can't take control
     res = PQexec(conn,"SELECT pg_catalog.set_config('search_path', '', false)");
     if (PQresultStatus(res) != PGRES_TUPLES_OK) {
         ADDERROR(__func__, std::string("SET failed: ")+PQerrorMessage(conn));
         PQclear(res);
+        PQfinish(conn);
         return NULL;
     }
 
@@ -60,6 +73,257 @@ PGconn* connection_setup_pq(std::string dbname) {
     return conn;
 }
 
+/**
+ * Set up a connection with an existing Postgres database.
+ * 
+ * This also prepares a safe search search path. The database needs to exist.
+ * If necessary, create it with the command `createdb [databasename]` (which
+ * defaults to the user name).
+ * 
+ * If the connection pool is enabled then an open connection may be reused.
+ * Either way, hand the connection back with connection_release_pq() when
+ * done, never with PQfinish().
+ * 
+ * @param: dbname the identifier of a database in a local Postgres setup.
+ * @return a pointer to the connection if successfully created, otherwise NULL.
+ */
+PGconn* connection_setup_pq(std::string dbname) {
+    if (pq_pool.enabled()) {
+        return pq_pool.acquire(dbname);
+    }
+    return connection_open_pq(dbname);
+}
+
+/**
+ * Release a connection obtained from connection_setup_pq().
+ * 
+ * The connection is returned to the pool if the pool is enabled and
+ * the connection is healthy. Otherwise, it is closed.
+ * 
+ * @param conn a connection obtained from connection_setup_pq() (may be NULL).
+ */
+void connection_release_pq(PGconn* conn) {
+    if (!conn) {
+        return;
+    }
+    pq_pool.release(conn);
+}
+
+/**
+ * Prepare a statement on a connection, unless it was already prepared there.
+ * 
+ * With pooled connections this means that each statement is parsed and
+ * planned only once per connection instead of once per call.
+ * 
+ * @param conn active database connection.
+ * @param stmtname a name that is unique to the statement.
+ * @param sql the statement with parameters $1, $2, etc.
+ * @param nparams the number of parameters.
+ * @return true if the statement is available on the connection.
+ */
+bool prepare_cached_pq(PGconn* conn, const std::string & stmtname, const std::string & sql, int nparams) {
+    if (!conn) {
+        return false;
+    }
+    if (pq_pool.is_prepared(conn, stmtname)) {
+        return true;
+    }
+
+    PGresult *res = PQprepare(conn, stmtname.c_str(), sql.c_str(), nparams, nullptr);
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+        ADDERROR(__func__, "PQprepare of "+stmtname+" failed: "+PQerrorMessage(conn));
+        PQclear(res);
+        return false;
+    }
+    PQclear(res);
+
+    pq_pool.set_prepared(conn, stmtname);
+    return true;
+}
+
+/**
+ * Find out if a table exists, checking only once per connection.
+ * 
+ * Only tables that exist are remembered, so that a table that is created
+ * later is found on the next call.
+ * 
+ * @param conn active database connection.
+ * @param tablename the table, including its schema.
+ * @return true if the table exists.
+ */
+bool table_exists_pq(PGconn* conn, const std::string & tablename) {
+    if (!conn) {
+        return false;
+    }
+    if (pq_pool.is_known_table(conn, tablename)) {
+        return true;
+    }
+
+    const char * values[1] = { tablename.c_str() };
+    PGresult *res = PQexecParams(conn, "SELECT to_regclass($1) IS NOT NULL", 1, nullptr, values, nullptr, nullptr, 0);
+    bool exists = (PQresultStatus(res) == PGRES_TUPLES_OK) && (PQntuples(res) > 0) && (PQgetvalue(res, 0, 0)[0] == 't');
+    PQclear(res);
+
+    if (exists) {
+        pq_pool.set_known_table(conn, tablename);
+    }
+    return exists;
+}
+
+pq_connection_pool::~pq_connection_pool() {
+    disable();
+}
+
+/**
+ * Begin to keep released connections open for reuse.
+ * 
+ * @param _max_idle maximum number of open connections kept for reuse.
+ */
+void pq_connection_pool::enable(unsigned int _max_idle) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    max_idle = _max_idle;
+}
+
+/**
+ * Close all idle connections and return to one-shot connections.
+ * 
+ * Pooled connections that are still in use are closed when released.
+ */
+void pq_connection_pool::disable() {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    max_idle = 0;
+    for (auto & [dbname, ic] : idle) {
+        close(ic.conn);
+    }
+    idle.clear();
+}
+
+/// Forget what is known about a connection. Call with pool_mutex held.
+void pq_connection_pool::forget(PGconn * conn) {
+    pooled.erase(conn);
+    prepared.erase(conn);
+    tables.erase(conn);
+}
+
+/// Close a connection and forget what is known about it. Call with pool_mutex held.
+void pq_connection_pool::close(PGconn * conn) {
+    forget(conn);
+    PQfinish(conn);
+}
+
+/**
+ * Obtain an open connection to a database, reusing an idle one if possible.
+ * 
+ * Idle connections that the server has closed, or that do not respond to
+ * a ping after being idle a while, are discarded.
+ * 
+ * @param dbname the identifier of a database in a local Postgres setup.
+ * @return a pointer to the connection if available, otherwise NULL.
+ */
+PGconn * pq_connection_pool::acquire(const std::string & dbname) {
+    while (true) {
+        idle_conn ic;
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            auto it = idle.find(dbname);
+            if (it == idle.end()) {
+                break;
+            }
+            ic = it->second;
+            idle.erase(it);
+        }
+
+        // The connection is no longer idle, so other threads cannot obtain it and it
+        // can be checked without holding the lock during a possibly slow round trip.
+        bool healthy = (PQconsumeInput(ic.conn) != 0) && (PQstatus(ic.conn) == CONNECTION_OK);
+        if (healthy && ((std::time(nullptr) - ic.t_idle) > ping_after_idle)) {
+            PGresult *res = PQexec(ic.conn, "SELECT 1");
+            healthy = (PQresultStatus(res) == PGRES_TUPLES_OK);
+            PQclear(res);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            if (healthy) {
+                ++reused;
+                return ic.conn;
+            }
+            forget(ic.conn);
+            ++discarded;
+        }
+        PQfinish(ic.conn);
+    }
+
+    // Open a new connection without holding the lock during the handshake.
+    PGconn * conn = connection_open_pq(dbname);
+    if (!conn) {
+        return NULL;
+    }
+
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    pooled.emplace(conn, dbname);
+    ++opened;
+    return conn;
+}
+
+/**
+ * Return a connection for reuse or close it.
+ * 
+ * Connections that were not opened by the pool, that are not idle, or that
+ * exceed the number of connections to keep, are closed.
+ * 
+ * @param conn a connection obtained from connection_setup_pq().
+ */
+void pq_connection_pool::release(PGconn * conn) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    auto it = pooled.find(conn);
+    if ((it == pooled.end()) || (idle.size() >= max_idle)) {
+        close(conn);
+        return;
+    }
+
+    if ((PQstatus(conn) != CONNECTION_OK) || (PQtransactionStatus(conn) != PQTRANS_IDLE)) {
+        close(conn);
+        ++discarded;
+        return;
+    }
+
+    idle.emplace(it->second, idle_conn{conn, std::time(nullptr)});
+}
+
+bool pq_connection_pool::is_pooled(PGconn * conn) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    return pooled.find(conn) != pooled.end();
+}
+
+bool pq_connection_pool::is_prepared(PGconn * conn, const std::string & stmtname) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    auto it = prepared.find(conn);
+    if (it == prepared.end()) {
+        return false;
+    }
+    return it->second.find(stmtname) != it->second.end();
+}
+
+void pq_connection_pool::set_prepared(PGconn * conn, const std::string & stmtname) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    prepared[conn].emplace(stmtname);
+}
+
+bool pq_connection_pool::is_known_table(PGconn * conn, const std::string & tablename) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    auto it = tables.find(conn);
+    if (it == tables.end()) {
+        return false;
+    }
+    return it->second.find(tablename) != it->second.end();
+}
+
+void pq_connection_pool::set_known_table(PGconn * conn, const std::string & tablename) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    tables[conn].emplace(tablename);
+}
+
 /**
  * Send a simple action call to a Postgres database.
  * 
@@ -84,6 +348,7 @@ bool simple_call_pq(PGconn* conn, std::string astr) {
     if (PQresultStatus(res) != PGRES_COMMAND_OK) {
         ADDERROR(__func__, std::string(astr.substr(0,14)+" failed: ")+PQerrorMessage(conn)+"\nPQ COMMAND = "+astr); 
         PQclear(res);
+        ++pq_failed_changes;
         return false;
     }
     
@@ -119,6 +384,150 @@ bool query_call_pq(PGconn* conn, std::string qstr, bool request_single_row_mode)
 
 }
 
+/**
+ * Substitute parameter values for $1, $2, etc. in a statement.
+ * 
+ * This produces an equivalent plain SQL statement for the simulation log,
+ * so that logged calls look the same as calls that were not prepared.
+ * 
+ * @param conn active database connection (used to escape values).
+ * @param sql a statement with parameters $1, $2, etc.
+ * @param params parameter values in text format.
+ * @return the statement with quoted literal values.
+ */
+std::string literal_statement_pq(PGconn* conn, const std::string & sql, const std::vector<std::string> & params) {
+    std::string literal;
+    literal.reserve(sql.size()+64*params.size());
+    for (size_t i = 0; i < sql.size(); ++i) {
+        if ((sql[i] == '$') && ((i+1) < sql.size()) && isdigit(sql[i+1])) {
+            size_t n = 0;
+            while (((i+1) < sql.size()) && isdigit(sql[i+1])) {
+                n = 10*n + (sql[++i] - '0');
+            }
+            if ((n < 1) || (n > params.size())) {
+                literal += "NULL";
+                continue;
+            }
+            char * escaped = PQescapeLiteral(conn, params[n-1].c_str(), params[n-1].size());
+            if (escaped) {
+                literal += escaped;
+                PQfreemem(escaped);
+            }
+        } else {
+            literal += sql[i];
+        }
+    }
+    return literal;
+}
+
+/**
+ * Send an action call to a Postgres database as a prepared statement.
+ * 
+ * On a pooled connection, the statement is prepared the first time it is
+ * used (see prepare_cached_pq()), after which each call only transmits the
+ * parameter values. A connection that is not pooled is closed again after
+ * a few calls, so there the statement is sent with its parameters in a
+ * single round trip instead. Values never need quoting or escaping.
+ * 
+ * Note: If the global flag simulate_pq_changes==pq_command_simulate then this function does not execute
+ * Postgres calls. Instead, the equivalent plain statement will be added to simulated_pq_calls.
+ * 
+ * @param conn active database connection.
+ * @param stmtname a name that is unique to the statement (include the schema name).
+ * @param sql the statement with parameters $1, $2, etc.
+ * @param params parameter values in text format.
+ * @return true if action call was successful.
+ */
+bool prepared_call_pq(PGconn* conn, const std::string & stmtname, const std::string & sql, const std::vector<std::string> & params) {
+    if (!conn) ERRRETURNFALSE(__func__,"unable to call database action without active database connection");
+
+    if (SimPQ.LoggingPQChanges()) {
+        std::string astr(literal_statement_pq(conn, sql, params));
+        if (SimPQ.SimPQChangesAndLog(astr) == pq_command_simulate)
+            return true;
+    }
+
+    bool pooled = pq_pool.is_pooled(conn);
+    if (pooled && (!prepare_cached_pq(conn, stmtname, sql, params.size()))) {
+        return false;
+    }
+
+    std::vector<const char *> values(params.size());
+    std::vector<int> lengths(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+        values[i] = params[i].c_str();
+        lengths[i] = params[i].size();
+    }
+
+    PGresult* res;
+    if (pooled) {
+        res = PQexecPrepared(conn, stmtname.c_str(), params.size(), values.data(), lengths.data(), nullptr, 0);
+    } else {
+        res = PQexecParams(conn, sql.c_str(), params.size(), nullptr, values.data(), lengths.data(), nullptr, 0);
+    }
+
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+        ADDERROR(__func__, stmtname+" failed: "+PQerrorMessage(conn)+"\nPQ COMMAND = "+sql);
+        PQclear(res);
+        ++pq_failed_changes;
+        return false;
+    }
+
+    PQclear(res);
+    return true;
+}
+
+/**
+ * Dispatch a prepared Postgres query for asynchronous processing in batch or single row mode.
+ * Uses PQsendQueryPrepared() and PQsetSingleRowMode().
+ * 
+ * This is the prepared statement equivalent of query_call_pq(). Receive results in
+ * the same way, with PQgetResult(). As in prepared_call_pq(), the statement is only
+ * prepared on pooled connections and is otherwise sent with PQsendQueryParams().
+ * 
+ * @param conn a valid Postgres connection object.
+ * @param stmtname a name that is unique to the statement (include the schema name).
+ * @param sql the query with parameters $1, $2, etc.
+ * @param params parameter values in text format.
+ * @param request_single_row_mode switches only this query to single row mode if true.
+ * @return true if the query was successfully dispatched.
+ */
+bool prepared_query_call_pq(PGconn* conn, const std::string & stmtname, const std::string & sql, const std::vector<std::string> & params, bool request_single_row_mode) {
+    if (!conn) ERRRETURNFALSE(__func__,"unable to call database action without active database connection");
+
+    if (SimPQ.LoggingPQChanges()) {
+        std::string qstr(literal_statement_pq(conn, sql, params));
+        if (SimPQ.SimPQChangesAndLog(qstr) == pq_command_simulate)
+            return true;
+    }
+
+    bool pooled = pq_pool.is_pooled(conn);
+    if (pooled && (!prepare_cached_pq(conn, stmtname, sql, params.size()))) {
+        return false;
+    }
+
+    std::vector<const char *> values(params.size());
+    std::vector<int> lengths(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+        values[i] = params[i].c_str();
+        lengths[i] = params[i].size();
+    }
+
+    int dispatched;
+    if (pooled) {
+        dispatched = PQsendQueryPrepared(conn, stmtname.c_str(), params.size(), values.data(), lengths.data(), nullptr, 0);
+    } else {
+        dispatched = PQsendQueryParams(conn, sql.c_str(), params.size(), nullptr, values.data(), lengths.data(), nullptr, 0);
+    }
+    if (!dispatched) {
+        ERRRETURNFALSE(__func__,std::string("query dispatch failed: ")+PQerrorMessage(conn)+"\nPQ COMMAND = "+sql);
+    }
+
+    if (request_single_row_mode) PQsetSingleRowMode(conn);
+
+    return true;
+}
+
 /**
  * Helper function that dumps several rows of data to a string buffer for
  * easy inspection. A query_call_pq() or equivalent should precede this.
@@ -221,6 +630,291 @@ time_t epochtime_from_timestamp_pq(std::string pqtimestamp) {
     return time_stamp_time(pqtimestamp);
 }
 
+/**
+ * Convert a Postgres time stamp string to Unix time without intermediate
+ * string processing. See epochtime_from_timestamp_pq(std::string).
+ * 
+ * @param pqtimestamp a time stamp string, e.g. from a COPY TO row.
+ * @return Unix time stamp or -1 when unspecified or invalid format.
+ */
+time_t epochtime_from_timestamp_pq(const char * pqtimestamp) {
+    if (!pqtimestamp) return -1;
+    if ((pqtimestamp[0]<'0') || (pqtimestamp[0]>'9')) return -1;
+
+    char digits[13];
+    int n = 0;
+    for (const char * c = pqtimestamp; (*c != '\0') && (n < 12); ++c) {
+        if ((*c >= '0') && (*c <= '9')) {
+            digits[n++] = *c;
+        }
+    }
+    if (n < 12) return -1;
+    digits[12] = '\0';
+
+    return time_stamp_time(digits);
+}
+
+/**
+ * Append text to a row for COPY FROM in text format, escaping the
+ * characters that have special meaning in that format.
+ * 
+ * @param dest the row being built.
+ * @param text the field value to append.
+ */
+void append_copy_text_pq(std::string & dest, const char * text) {
+    if (!text) return;
+    for (const char * c = text; *c != '\0'; ++c) {
+        switch (*c) {
+            case '\\': {
+                dest += "\\\\";
+                break;
+            }
+            case '\n': {
+                dest += "\\n";
+                break;
+            }
+            case '\r': {
+                dest += "\\r";
+                break;
+            }
+            case '\t': {
+                dest += "\\t";
+                break;
+            }
+            default: {
+                dest += *c;
+            }
+        }
+    }
+}
+
+/**
+ * Split a row received with COPY TO in text format into its fields.
+ * 
+ * This works in place: Field separators are replaced by null-terminators
+ * and escape sequences are resolved, so that the `fields` pointers can
+ * be used directly as C strings. A NULL value (`\N`) yields a nullptr.
+ * 
+ * @param row the row buffer (modified).
+ * @param len the number of bytes in the row.
+ * @param fields receives pointers to the fields.
+ * @param max_fields the size of `fields`.
+ * @return the number of fields found.
+ */
+int copy_fields_pq(char * row, int len, char ** fields, int max_fields) {
+    if ((!row) || (len <= 0)) return 0;
+    if (row[len-1] == '\n') --len;
+
+    int n = 0;
+    char * src = row;
+    char * end = row + len;
+    while (n < max_fields) {
+        char * field = src;
+        char * dst = src;
+        while ((src < end) && (*src != '\t')) {
+            if ((*src == '\\') && ((src+1) < end)) {
+                ++src;
+                switch (*src) {
+                    case 'b': *dst++ = '\b'; break;
+                    case 'f': *dst++ = '\f'; break;
+                    case 'n': *dst++ = '\n'; break;
+                    case 'r': *dst++ = '\r'; break;
+                    case 't': *dst++ = '\t'; break;
+                    case 'v': *dst++ = '\v'; break;
+                    case 'N': {
+                        field = nullptr;
+                        break;
+                    }
+                    default: {
+                        if ((*src >= '0') && (*src <= '7')) { // up to three octal digits
+                            int v = 0;
+                            for (int i = 0; (i < 3) && (src < end) && (*src >= '0') && (*src <= '7'); ++i) {
+                                v = (v << 3) + (*src++ - '0');
+                            }
+                            *dst++ = (char)v;
+                            continue;
+                        }
+                        *dst++ = *src; // includes backslash itself
+                    }
+                }
+                ++src;
+            } else {
+                *dst++ = *src++;
+            }
+        }
+        bool last = (src >= end);
+        if (field) {
+            *dst = '\0';
+        }
+        fields[n++] = field;
+        if (last) break;
+        ++src; // skip tab
+    }
+    return n;
+}
+
+/**
+ * Receive rows from a `COPY ... TO STDOUT` command in text format.
+ * 
+ * Note: If the global flag simulate_pq_changes==pq_command_simulate then this
+ * behaves like query_call_pq() and the command is only logged.
+ * 
+ * @param conn active database connection.
+ * @param copycmd the COPY command.
+ * @param row_func called with each row buffer and its length, may modify the
+ *                 buffer and returns false to signal an error.
+ * @return true if all rows were received and processed successfully.
+ */
+bool copy_to_stdout_pq(PGconn* conn, std::string copycmd, const std::function<bool(char*, int)> & row_func) {
+    if (!conn) ERRRETURNFALSE(__func__,"unable to call database action without active database connection");
+
+    if (SimPQ.SimPQChangesAndLog(copycmd) == pq_command_simulate)
+        return true;
+
+    PGresult* res = PQexec(conn, copycmd.c_str());
+    if (PQresultStatus(res) != PGRES_COPY_OUT) {
+        ADDERROR(__func__, std::string("COPY failed: ")+PQerrorMessage(conn)+"\nPQ COMMAND = "+copycmd);
+        PQclear(res);
+        return false;
+    }
+    PQclear(res);
+
+    bool rows_ok = true;
+    char * row = nullptr;
+    int len;
+    while ((len = PQgetCopyData(conn, &row, 0)) > 0) {
+        if (rows_ok) {
+            rows_ok = row_func(row, len);
+        }
+        PQfreemem(row);
+    }
+    if (len == -2) {
+        ADDERROR(__func__, std::string("COPY data retrieval failed: ")+PQerrorMessage(conn));
+        rows_ok = false;
+    }
+
+    while ((res = PQgetResult(conn))) {
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            ADDERROR(__func__, std::string("COPY failed: ")+PQerrorMessage(conn)+"\nPQ COMMAND = "+copycmd);
+            rows_ok = false;
+        }
+        PQclear(res);
+    }
+
+    return rows_ok;
+}
+
+Copy_in_pq::Copy_in_pq(PGconn* _conn, std::string copycmd): conn(_conn) {
+    if (!conn) {
+        ADDERROR(__func__,"unable to call database action without active database connection");
+        return;
+    }
+
+    if (SimPQ.SimPQChangesAndLog(copycmd) == pq_command_simulate) {
+        simulated = true;
+        return;
+    }
+
+    PGresult* res = PQexec(conn, copycmd.c_str());
+    if (PQresultStatus(res) != PGRES_COPY_IN) {
+        ADDERROR(__func__, std::string("COPY failed: ")+PQerrorMessage(conn)+"\nPQ COMMAND = "+copycmd);
+        ++pq_failed_changes;
+    } else {
+        active = true;
+        buffer.reserve(flush_bytes + 4096);
+    }
+    PQclear(res);
+}
+
+Copy_in_pq::~Copy_in_pq() {
+    abort();
+}
+
+/**
+ * End an unfinished COPY without committing its rows.
+ * 
+ * This must be called before the connection is released, because
+ * afterwards the COPY can no longer be ended on it.
+ */
+void Copy_in_pq::abort() {
+    simulated = false;
+    if (!active) return;
+
+    active = false;
+    ++pq_failed_changes;
+    PQputCopyEnd(conn, "aborted");
+    PGresult* res;
+    while ((res = PQgetResult(conn))) {
+        PQclear(res);
+    }
+}
+
+bool Copy_in_pq::flush() {
+    if (buffer.empty()) return true;
+    if (PQputCopyData(conn, buffer.data(), buffer.size()) != 1) {
+        ERRRETURNFALSE(__func__, std::string("COPY data transmission failed: ")+PQerrorMessage(conn));
+    }
+    buffer.clear();
+    return true;
+}
+
+/**
+ * Add a row to the COPY. The row should not include the terminating newline.
+ * 
+ * @param row tab separated fields in COPY text format.
+ * @return true if the row was buffered or sent successfully.
+ */
+bool Copy_in_pq::put_row(const std::string & row) {
+    if (simulated) {
+        if (SimPQ.LoggingPQChanges()) {
+            std::string rowcopy(row);
+            SimPQ.AddToSimLog(rowcopy);
+        }
+        return true;
+    }
+    if (!active) return false;
+
+    buffer += row;
+    buffer += '\n';
+    if (buffer.size() >= flush_bytes) {
+        return flush();
+    }
+    return true;
+}
+
+/**
+ * Send remaining rows and complete the COPY.
+ * 
+ * @return true if the COPY was completed successfully.
+ */
+bool Copy_in_pq::finish() {
+    if (simulated) {
+        simulated = false;
+        return true;
+    }
+    if (!active) return false;
+
+    bool copy_ok = flush();
+    active = false;
+    if (PQputCopyEnd(conn, copy_ok ? nullptr : "transmission failed") != 1) {
+        ADDERROR(__func__, std::string("COPY completion failed: ")+PQerrorMessage(conn));
+        copy_ok = false;
+    }
+
+    PGresult* res;
+    while ((res = PQgetResult(conn))) {
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            ADDERROR(__func__, std::string("COPY failed: ")+PQerrorMessage(conn));
+            copy_ok = false;
+        }
+        PQclear(res);
+    }
+    if (!copy_ok) {
+        ++pq_failed_changes;
+    }
+    return copy_ok;
+}
+
 fzpq_configurable::fzpq_configurable(formalizer_standard_program & fsp): configurable("fzpostgres", fsp), exit_report_hooked_in(false) { }
 
 /// An exit hook function that ensures any simulated Postgres calls are written to a file.
@@ -0,0 +1,226 @@
+// Copyright 2020 Randal A. Koene
+// License TBD
+
+/**
+ * Counters, histograms and scoped timers for lightweight instrumentation.
+ */
+
+// std
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+// core
+#include "instrument.hpp"
+
+namespace fz {
+
+std::atomic<unsigned int> instrument_next_slot{0};
+
+unsigned int instrument_thread_slot() {
+    thread_local unsigned int slot = instrument_next_slot.fetch_add(1, std::memory_order_relaxed) % instrument_thread_slots;
+    return slot;
+}
+
+/// Registered metrics, in order of construction.
+struct instrument_registry {
+    std::mutex mtx;
+    std::vector<const Instrument_Metric *> metrics;
+};
+
+instrument_registry & metrics_registry() {
+    static instrument_registry reg; // constructed on first use, so that static metrics in any translation unit can register
+    return reg;
+}
+
+Instrument_Metric::Instrument_Metric(instrument_metric_type _type, const char * _name, const char * _help, const char * _labels): name(_name), help(_help), labels(_labels), type(_type) {
+    instrument_registry & reg = metrics_registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    reg.metrics.emplace_back(this);
+}
+
+Instrument_Metric::~Instrument_Metric() {
+    instrument_registry & reg = metrics_registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    for (auto it = reg.metrics.begin(); it != reg.metrics.end(); ++it) {
+        if (*it == this) {
+            reg.metrics.erase(it);
+            break;
+        }
+    }
+}
+
+/// Format a duration in microseconds as seconds.
+std::string us_to_seconds_str(uint64_t us) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.6f", double(us) / 1000000.0);
+    return buf;
+}
+
+/// Format a bucket bound in microseconds as seconds, as in Prometheus `le` labels.
+std::string bound_to_seconds_str(uint64_t us) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%g", double(us) / 1000000.0);
+    return buf;
+}
+
+/// Prometheus label set with an optional additional label.
+std::string prometheus_labels(const char * labels, const std::string & extra = "") {
+    std::string labels_str(labels ? labels : "");
+    if (!extra.empty()) {
+        if (!labels_str.empty()) {
+            labels_str += ',';
+        }
+        labels_str += extra;
+    }
+    if (labels_str.empty()) {
+        return labels_str;
+    }
+    return '{'+labels_str+'}';
+}
+
+/**
+ * Convert a Prometheus label set, such as `path="nodes",mode="read"`, into
+ * a JSON object, such as `{"path":"nodes","mode":"read"}`.
+ */
+std::string json_labels(const char * labels) {
+    std::string json_str("{");
+    if (labels) {
+        bool in_value = false;
+        bool at_key = true;
+        for (const char * c = labels; *c; ++c) {
+            if (in_value) {
+                json_str += *c;
+                if ((*c == '"') && (*(c-1) != '\\')) {
+                    in_value = false;
+                }
+                continue;
+            }
+            if (at_key) {
+                json_str += '"';
+                at_key = false;
+            }
+            switch (*c) {
+                case '=': {
+                    json_str += "\":";
+                    break;
+                }
+                case '"': {
+                    json_str += '"';
+                    in_value = true;
+                    break;
+                }
+                case ',': {
+                    json_str += ',';
+                    at_key = true;
+                    break;
+                }
+                default: {
+                    json_str += *c;
+                }
+            }
+        }
+    }
+    return json_str + '}';
+}
+
+/// The beginning of a JSON metric object, up to and including the labels.
+std::string json_metric_head(const Instrument_Metric & metric, const char * type_str) {
+    return std::string("{\"name\":\"")+metric.get_name()+"\",\"type\":\""+type_str+"\",\"labels\":"+json_labels(metric.get_labels());
+}
+
+uint64_t Instrument_Counter::value() const {
+    uint64_t n = 0;
+    for (const auto & s : slots) {
+        n += s.n.load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+void Instrument_Counter::prometheus(std::string & out) const {
+    out += std::string(name)+prometheus_labels(labels)+' '+std::to_string(value())+'\n';
+}
+
+void Instrument_Counter::json(std::string & out) const {
+    out += json_metric_head(*this, "counter")+",\"value\":"+std::to_string(value())+'}';
+}
+
+void Instrument_Histogram::observe_us(uint64_t us) {
+    unsigned int b = 0;
+    while ((b < instrument_num_bounds) && (us > instrument_bounds_us[b])) {
+        ++b;
+    }
+    slot & s = slots[instrument_thread_slot()];
+    s.buckets[b].fetch_add(1, std::memory_order_relaxed);
+    s.sum_us.fetch_add(us, std::memory_order_relaxed);
+}
+
+void Instrument_Histogram::totals(uint64_t (&cumulative)[instrument_num_bounds+1], uint64_t & sum_us) const {
+    for (auto & c : cumulative) {
+        c = 0;
+    }
+    sum_us = 0;
+    for (const auto & s : slots) {
+        for (unsigned int b = 0; b <= instrument_num_bounds; ++b) {
+            cumulative[b] += s.buckets[b].load(std::memory_order_relaxed);
+        }
+        sum_us += s.sum_us.load(std::memory_order_relaxed);
+    }
+    for (unsigned int b = 1; b <= instrument_num_bounds; ++b) {
+        cumulative[b] += cumulative[b-1];
+    }
+}
+
+void Instrument_Histogram::prometheus(std::string & out) const {
+    uint64_t cumulative[instrument_num_bounds+1];
+    uint64_t sum_us;
+    totals(cumulative, sum_us);
+    for (unsigned int b = 0; b < instrument_num_bounds; ++b) {
+        out += std::string(name)+"_bucket"+prometheus_labels(labels, "le=\""+bound_to_seconds_str(instrument_bounds_us[b])+'"')+' '+std::to_string(cumulative[b])+'\n';
+    }
+    out += std::string(name)+"_bucket"+prometheus_labels(labels, "le=\"+Inf\"")+' '+std::to_string(cumulative[instrument_num_bounds])+'\n';
+    out += std::string(name)+"_sum"+prometheus_labels(labels)+' '+us_to_seconds_str(sum_us)+'\n';
+    out += std::string(name)+"_count"+prometheus_labels(labels)+' '+std::to_string(cumulative[instrument_num_bounds])+'\n';
+}
+
+void Instrument_Histogram::json(std::string & out) const {
+    uint64_t cumulative[instrument_num_bounds+1];
+    uint64_t sum_us;
+    totals(cumulative, sum_us);
+    out += json_metric_head(*this, "histogram")+",\"count\":"+std::to_string(cumulative[instrument_num_bounds])+",\"sum_seconds\":"+us_to_seconds_str(sum_us)+",\"buckets\":[";
+    for (unsigned int b = 0; b < instrument_num_bounds; ++b) {
+        out += "{\"le\":"+bound_to_seconds_str(instrument_bounds_us[b])+",\"count\":"+std::to_string(cumulative[b])+"},";
+    }
+    out += "{\"le\":\"+Inf\",\"count\":"+std::to_string(cumulative[instrument_num_bounds])+"}]}";
+}
+
+std::string metrics_prometheus() {
+    instrument_registry & reg = metrics_registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    std::string out;
+    const char * family = nullptr;
+    for (const auto & metric : reg.metrics) {
+        if ((!family) || (std::string(family) != metric->get_name())) { // HELP and TYPE once per metric family
+            family = metric->get_name();
+            out += std::string("# HELP ")+family+' '+metric->get_help()+'\n';
+            out += std::string("# TYPE ")+family+((metric->get_type() == instrument_counter) ? " counter\n" : " histogram\n");
+        }
+        metric->prometheus(out);
+    }
+    return out;
+}
+
+std::string metrics_json() {
+    instrument_registry & reg = metrics_registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    std::string out("{\"metrics\":[");
+    for (size_t i = 0; i < reg.metrics.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        reg.metrics[i]->json(out);
+    }
+    return out + "]}\n";
+}
+
+} // namespace fz
@@ -100,18 +100,46 @@ bool client_socket_shmem_request(std::string request_str, std::string server_ip_
  *       memory, which is (outside of shared-memory clusters) only
  *       possible on the same machine.
  * 
+ * If the request was prepared in a slot of the server's request ring
+ * (see allocate_Graph_modifications_in_shared_memory()) then it is
+ * submitted through the ring instead of over TCP.
+ * 
  * @param segname The unique shared memory segment label.
  * @param port_number The port number at which the server is expected to be listening.
  * @return The request outcome, expressed in exit codes (exit_ok, exit_general_error, etc).
  */
 exit_status_code server_request_with_shared_data(std::string segname, uint16_t port_number) {
 
+    std::string requestname(graphmod_request_name(segname));
+    if (requestname != segname) {
+        auto ret = server_response_with_shared_data(requestname, submit_Graphmod_ring_request(requestname));
+        release_Graphmod_ring_request(requestname);
+        return ret;
+    }
+
     std::string response_str;
     if (!client_socket_shmem_request(segname, "127.0.0.1", port_number, response_str)) {
         VERBOSEERR("Communication error.\n");
         return exit_communication_error;
     }
 
+    return server_response_with_shared_data(segname, response_str);
+}
+
+/**
+ * Report the outcome of a Graph modification request with shared memory.
+ * 
+ * @param segname The shared memory segment label or ring request name.
+ * @param response_str The server response.
+ * @return The request outcome, expressed in exit codes (exit_ok, exit_general_error, etc).
+ */
+exit_status_code server_response_with_shared_data(const std::string & segname, const std::string & response_str) {
+
+    if (response_str.empty()) {
+        VERBOSEERR("Communication error.\n");
+        return exit_communication_error;
+    }
+
     if (response_str == "RESULTS") {
         VERBOSEOUT("Successful response received.\n");
         Graphmod_results * resdata = find_results_response_in_shared_memory(segname);
@@ -8,10 +8,15 @@
 //#include <string.h> 
 #include <sys/socket.h> 
 #include <unistd.h> // This provides socket close() and such.
+#include <fcntl.h>
+#include <sys/epoll.h>
 #include <arpa/inet.h>
 #include <cstring>
 #include <map>
 #include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
 
 // core
 #include "standard.hpp"
@@ -171,11 +176,141 @@ bool find_server_address(std::string & ipaddr_str) {
 }
 
 
+/**
+ * A client connection whose request is still being received.
+ */
+struct pending_request {
+    std::string buf;
+    std::chrono::steady_clock::time_point t_accepted;
+    std::chrono::steady_clock::time_point t_last;
+    bool eof = false;
+
+    pending_request() : t_accepted(std::chrono::steady_clock::now()), t_last(t_accepted) {}
+};
+
+constexpr size_t max_request_size = 1024*1024;        ///< Larger requests are refused.
+constexpr std::chrono::milliseconds raw_request_settle(100);  ///< Unterminated non-HTTP requests are complete after this pause.
+constexpr std::chrono::seconds request_timeout(10);   ///< Clients that do not complete a request in time are dropped.
+constexpr std::chrono::milliseconds idle_wakeup(1000);  ///< Longest wait for events while no requests are incomplete.
+
+/// Returns true if the request begins like an HTTP request line.
+bool is_http_request(const std::string & buf) {
+    for (const char * method : {"GET ", "PATCH ", "POST ", "PUT ", "HEAD ", "DELETE "}) {
+        if (buf.compare(0, strlen(method), method) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Determine if a complete request has been received.
+ * 
+ * HTTP requests are complete when the header and a body of `Content-Length`
+ * bytes (if specified) have arrived. Other requests, such as those sent by
+ * Formalizer TCP clients, are complete at a terminating zero or newline.
+ * 
+ * @param buf Data received so far.
+ * @return True if the request is complete.
+ */
+bool request_complete(const std::string & buf) {
+    if (is_http_request(buf)) {
+        size_t header_end = buf.find("\r\n\r\n");
+        size_t separator_len = 4;
+        if (header_end == std::string::npos) {
+            header_end = buf.find("\n\n");
+            separator_len = 2;
+        }
+        if (header_end == std::string::npos) {
+            return false;
+        }
+
+        size_t content_length = 0;
+        std::string header(buf.substr(0, header_end));
+        std::transform(header.begin(), header.end(), header.begin(), ::tolower);
+        auto clpos = header.find("\ncontent-length:");
+        if (clpos != std::string::npos) {
+            content_length = std::strtoul(header.c_str() + clpos + 16, nullptr, 10);
+        }
+        return buf.size() >= (header_end + separator_len + content_length);
+    }
+
+    return buf.find_first_of(std::string("\0\n", 2)) != std::string::npos;
+}
+
+/// Set a socket to non-blocking (or blocking) mode.
+bool set_nonblocking(int fd, bool nonblocking) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) {
+        return false;
+    }
+    flags = nonblocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(fd, F_SETFL, flags) == 0;
+}
+
+/**
+ * Hand a complete request to the server.
+ * 
+ * The socket is returned to blocking mode, because handlers send
+ * their responses with blocking calls.
+ * 
+ * @param new_socket The client socket.
+ * @param buf The complete request data.
+ * @param server A shared_memory_server derived server object to handle the request.
+ */
+void dispatch_request(int new_socket, const std::string & buf, shared_memory_server & server) {
+    set_nonblocking(new_socket, false);
+
+    std::string request_str(buf.c_str()); // up to a terminating zero, if there is one
+    if ((!request_str.empty()) && (request_str.back() == '\n')) {
+        request_str.pop_back(); // closing newline is optional
+    }
+
+    if (is_http_request(request_str) || (request_str.substr(0,3) == "FZ ")) { // a special purpose request from a browser interface
+        server.handle_special_purpose_request(new_socket, request_str);
+        if (!server.handles_close) {
+            close(new_socket);
+        }
+        return;
+    }
+
+    if (request_str == "STOP") {
+        server.listen = false;
+        VERYVERBOSEOUT("STOP request received. Exiting server listen loop.\n");
+        std::string response_str("STOPPING");
+        send(new_socket, response_str.c_str(), response_str.size()+1, 0);
+        close(new_socket);
+        return;
+    }
+
+    if (request_str == "PING") {
+        VERYVERBOSEOUT("PING request received. Responding.\n");
+        std::string response_str("LISTENING");
+        send(new_socket, response_str.c_str(), response_str.size()+1, 0);
+        close(new_socket);
+        return;
+    }
+
+    // If it was not (one of) the specific requests handled above then it specifies the
+    // segment name for a request stack in shared memory.
+    server.handle_request_with_data_share(new_socket, request_str);
+    if (!server.handles_close) {
+        close(new_socket);
+    }
+}
+
 /**
  * Set up an IPv4 TCP socket on specified port and listen for client connections from any address.
  * 
  * See https://man7.org/linux/man-pages/man7/ip.7.html.
  * 
+ * Connections are accepted and read in an epoll event loop with non-blocking
+ * sockets, so that many clients can connect at once and a slow client does not
+ * hold up the others. A request is handed to the server object only once it has
+ * been received completely (see request_complete()). Unterminated non-HTTP
+ * requests are considered complete after a short pause, and clients that do
+ * not complete a request within `request_timeout` are dropped.
+ * 
  * Note: Only some errors return a detailed error message in an error data structure. Those
  *       are typically errors that were caught during validation of the request data. Other
  *       errors may not do so, although they will typically still log the error on the
@@ -188,19 +323,19 @@ bool find_server_address(std::string & ipaddr_str) {
  * 
  * @param port_number The port number to listen on.
  * @param server A shared_memory_server derived server object to handle requests with data share.
+ * @param backlog Maximum length of the queue of connections waiting to be accepted.
  * @return Server listen outcome, expressed in exit codes (exit_ok, exit_general_error, etc).
  */
-exit_status_code server_socket_listen(uint16_t port_number, shared_memory_server & server) {
-    #define str_SIZE 1024
-    int server_fd, new_socket, valread;
+exit_status_code server_socket_listen(uint16_t port_number, shared_memory_server & server, int backlog) {
+    #define MAX_EVENTS 64
+    int server_fd;
     struct sockaddr_in address;
-    char str[str_SIZE];
     int addrlen = sizeof(address);
 
     VERYVERBOSEOUT("Socket listening is using: "+server.identify());
-  
-    // Creating socket file descriptor 
-    if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == 0) {
+
+    // Creating socket file descriptor
+    if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
         standard_error("Socket failed.", __func__);
         return exit_communication_error;
     }
@@ -222,88 +357,146 @@ exit_status_code server_socket_listen(uint16_t port_number, shared_memory_server
     address.sin_port = htons(port_number);
 
     // Forcefully attaching socket to the port 8090.
-    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0) { 
-        standard_error("Port bind failed.", __func__); 
-        return exit_communication_error; 
-    } 
-  
-    // puts the server socket in passive mode 
-    if (listen(server_fd, 3) < 0) {
-        standard_error("The listen() call returned an error.", __func__); 
+    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        standard_error("Port bind failed.", __func__);
+        return exit_communication_error;
+    }
+
+    // puts the server socket in passive mode
+    if (listen(server_fd, backlog) < 0) {
+        standard_error("The listen() call returned an error.", __func__);
+        return exit_communication_error;
+    }
+
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) {
+        standard_error("The epoll_create1() call returned an error.", __func__);
+        close(server_fd);
+        return exit_communication_error;
+    }
+    set_nonblocking(server_fd, true);
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = server_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_fd, &ev) < 0) {
+        standard_error("Unable to add the server socket to epoll.", __func__);
+        close(epoll_fd);
+        close(server_fd);
         return exit_communication_error;
     }
 
+    std::map<int, pending_request> pending;
+    char str[4096];
+    struct epoll_event events[MAX_EVENTS];
+
+    // Stop watching a client socket before handing it on or closing it.
+    auto forget = [&](int fd) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        pending.erase(fd);
+    };
+
+    VERYVERBOSEOUT("\nBound and listening to all incoming addresses.\n\n");
+
     while (server.listen) {
-        VERYVERBOSEOUT("\nBound and listening to all incoming addresses.\n\n");
-        
-        // This is receiving the address that is connecting. https://man7.org/linux/man-pages/man2/accept.2.html
-        // As described in the man page, if the socket is blocking (as it is here) then it will block,
-        // i.e. wait, until a connection request appears. Alternatively, there are several ways
-        // described in the Description section of the man page for non-blocking approaches that
-        // can involve polling or an interrupt to give attention to a connection request.
-        // While blocked, the process consumes no CPU (e.g. see https://stackoverflow.com/questions/23108140/why-do-blocking-functions-not-use-100-cpu).
-        if ((new_socket = accept(server_fd, (struct sockaddr*)&address, (socklen_t*)&addrlen)) < 0) {
-            standard_error("The accept() call returned an error.", __func__); 
-            return exit_communication_error;
-        }
-        VERYVERBOSEOUT("Connection accepted from: "+std::string(inet_ntoa(address.sin_addr))+'\n');
-
-        // read string send by client
-        memset(str, 0, str_SIZE); // just playing it safe
-        valread = read(new_socket, str, sizeof(str)); // *** right now, this read often hangs until some timeout
-        if (valread==0) {
-            ADDWARNING(__func__, "EOF encountered");
-            VERYVERBOSEOUT("Read encountered EOF.\n");
-            close(new_socket); // *** possibly remove these... best read up about this some more
-            continue;
-        }
-        if (valread<0) {
-            standard_error("Socket read error", __func__);
-            close(new_socket);
-            continue;
-        }
 
-        std::string request_str(str);
-        if (request_str.back() == '\n') {
-            request_str.pop_back(); // closing newline is optional
+        // While requests are incomplete wake up regularly to check timeouts. Otherwise, wake up
+        // once in a while to notice if a request handling thread stopped listening.
+        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, pending.empty() ? idle_wakeup.count() : raw_request_settle.count()/2);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            standard_error("The epoll_wait() call returned an error.", __func__);
+            break;
         }
 
-        if ((request_str.substr(0,4) == "GET ") || (request_str.substr(0,6) == "PATCH ") || (request_str.substr(0,3) == "FZ ")) { // a special purpose request from a browser interface
-            server.handle_special_purpose_request(new_socket, request_str);
-            if (!server.handles_close) {
-                close(new_socket);
+        for (int i = 0; (i < n) && server.listen; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == server_fd) {
+                int new_socket;
+                while ((new_socket = accept4(server_fd, (struct sockaddr*)&address, (socklen_t*)&addrlen, SOCK_NONBLOCK)) >= 0) {
+                    VERYVERBOSEOUT("Connection accepted from: "+std::string(inet_ntoa(address.sin_addr))+'\n');
+                    ev.events = EPOLLIN | EPOLLRDHUP;
+                    ev.data.fd = new_socket;
+                    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, new_socket, &ev) < 0) {
+                        standard_error("Unable to add a client socket to epoll.", __func__);
+                        close(new_socket);
+                        continue;
+                    }
+                    pending.emplace(new_socket, pending_request());
+                }
+                if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                    standard_error("The accept() call returned an error.", __func__);
+                }
+                continue;
             }
-            continue;
-        }
 
-        if (request_str == "STOP") {
-            server.listen = false;
-            VERYVERBOSEOUT("STOP request received. Exiting server listen loop.\n");
-            std::string response_str("STOPPING");
-            send(new_socket, response_str.c_str(), response_str.size()+1, 0);
-            //sleep(1); // this might actually be necessary for the client to receive the whole response
-            close(new_socket);
-            break;
-        }
+            auto it = pending.find(fd);
+            if (it == pending.end()) {
+                continue;
+            }
+            pending_request & req = it->second;
 
-        if (request_str == "PING") {
-            VERYVERBOSEOUT("PING request received. Responding.\n");
-            std::string response_str("LISTENING");
-            send(new_socket, response_str.c_str(), response_str.size()+1, 0);
-            //sleep(1); // this might actually be necessary for the client to receive the whole response
-            close(new_socket);
-            continue;           
+            ssize_t valread;
+            while ((valread = read(fd, str, sizeof(str))) > 0) {
+                req.buf.append(str, valread);
+                req.t_last = std::chrono::steady_clock::now();
+            }
+            if (valread == 0) {
+                req.eof = true;
+            } else if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                standard_error("Socket read error", __func__);
+                forget(fd);
+                close(fd);
+                continue;
+            }
+
+            if (req.buf.size() > max_request_size) {
+                ADDWARNING(__func__, "Request exceeds maximum size, connection closed");
+                forget(fd);
+                close(fd);
+                continue;
+            }
+
+            if (request_complete(req.buf) || (req.eof && (!req.buf.empty()))) {
+                std::string buf(std::move(req.buf));
+                forget(fd);
+                dispatch_request(fd, buf, server);
+                continue;
+            }
+
+            if (req.eof) {
+                ADDWARNING(__func__, "EOF encountered");
+                VERYVERBOSEOUT("Read encountered EOF.\n");
+                forget(fd);
+                close(fd);
+            }
         }
 
-        // If it was not (one of) the specific requests handled above then it specifies the
-        // segment name for a request stack in shared memory.
-        server.handle_request_with_data_share(new_socket, request_str);
-        if (!server.handles_close) {
-            close(new_socket);
+        // Complete unterminated non-HTTP requests and drop stalled clients.
+        auto t_now = std::chrono::steady_clock::now();
+        for (auto it = pending.begin(); (it != pending.end()) && server.listen; ) {
+            int fd = it->first;
+            pending_request & req = it->second;
+            ++it;
+            if ((!req.buf.empty()) && (!is_http_request(req.buf)) && ((t_now - req.t_last) >= raw_request_settle)) {
+                std::string buf(std::move(req.buf));
+                forget(fd);
+                dispatch_request(fd, buf, server);
+            } else if ((t_now - req.t_accepted) >= request_timeout) {
+                VERYVERBOSEOUT("Client did not complete its request in time. Connection closed.\n");
+                forget(fd);
+                close(fd);
+            }
         }
 
     }
 
+    for (const auto & [fd, req] : pending) {
+        close(fd);
+    }
+    close(epoll_fd);
     close(server_fd);
 
     return exit_ok;
@@ -30,29 +30,50 @@ namespace fz {
  * attempted eevn if `vars` contains no variable values. This is useful
  * when a template may contain no variable labels to substitute.
  * 
+ * Note: When the same template is rendered repeatedly, it is faster to
+ *       `compile()` it once and to render the `compiled_template`.
+ * 
  * @param temp a template containing {{ varname }} to be replaced.
  * @param vars a map of variable names and variable values.
  * @param proceed_if_emptyvars if true attempts to render even if `vars` is empty.
  * @return the rendered string composing template and variables (or empty if error).
  */
-std::string render_environment::render(const std::string temp, template_varvalues vars, bool proceed_if_emptyvars) {
-    render_error = rerr_ok;
+std::string render_environment::render(const std::string & temp, const template_varvalues & vars, bool proceed_if_emptyvars) {
+    compiled_template compiled;
+    compile(temp, compiled);
 
-    if (temp.empty()) {
-        ADDWARNING(__func__,"empty template, unable to render "+std::to_string(vars.size())+" variables");
-        render_error = rerr_empty_template;
-        return temp;
+    std::string rendered;
+    if (!render(compiled, vars, rendered, proceed_if_emptyvars)) {
+        return "";
     }
+    return rendered;
+}
 
-    if ((!proceed_if_emptyvars) && (vars.empty())) {
-        ADDWARNING(__func__,"no variables to render into template ("+temp.substr(0,20)+") [`proceed_if_emptyvars` can relax this requirement]");
-        render_error = rerr_no_variable_values;
-        return temp;
+/**
+ * Returns the index of a variable label in a compiled template,
+ * or -1 if the template contains no such variable.
+ */
+int compiled_template::variable_index(const std::string & varlabel) const {
+    auto it = varindex.find(varlabel);
+    if (it == varindex.end()) {
+        return -1;
     }
+    return it->second;
+}
+
+/**
+ * Split a template into literal segments and variable slots.
+ * 
+ * Slots with empty variable labels are kept, so that rendering can warn
+ * about them as it would when rendering the template string.
+ * 
+ * @param temp a template containing {{ varname }} to be replaced.
+ * @param compiled Reference to the compiled template to (re)build.
+ */
+void render_environment::compile(const std::string & temp, compiled_template & compiled) {
+    compiled = compiled_template();
+    compiled.source = temp;
 
-    std::string rendered;
-    // Find all of the variable to replace in the template
-    //template_varpos replacethese;
     std::string::size_type p = 0, br_open, br_close, vstart, vlen;
     while (p<temp.size()) {
 
@@ -69,49 +90,202 @@ std::string render_environment::render(const std::string temp, template_varvalue
         std::string vlabel = temp.substr(vstart,vlen);
         trim(vlabel);
 
-        rendered += temp.substr(p, br_open - p);
-        p = br_open;
+        compiled.literals.emplace_back(temp, p, br_open - p);
+        p = br_close + varclose.size();
 
-        if (vlabel.empty()) {
-            ADDWARNING(__func__,"empty variable label at position "+std::to_string(br_open)+" in template ("+temp.substr(0,20)+')');
-            rendered += temp.substr(p, br_close - p + varclose.size());
-            p = br_close + varclose.size();
-            render_error = rerr_empty_variable_label;
+        unsigned int var = compiled_template::empty_label;
+        if (!vlabel.empty()) {
+            auto [var_it, inserted] = compiled.varindex.emplace(vlabel, compiled.varlabels.size());
+            if (inserted) {
+                compiled.varlabels.emplace_back(vlabel);
+            }
+            var = var_it->second;
+        }
+        compiled.slots.push_back({var, br_open, temp.substr(br_open, p - br_open)});
+    }
+    compiled.literals.emplace_back(temp, p);
+}
 
+/**
+ * Append the literal segments of a compiled template and the values in
+ * `values_by_index` for its variable slots. A nullptr value is missing.
+ * 
+ * @param compiled A compiled template.
+ * @param rendered Reference to a string to which the result is appended (unchanged if error).
+ * @return False if a value was missing and `skipmissing` is false.
+ */
+bool render_environment::render_slots(const compiled_template & compiled, std::string & rendered) {
+    auto rendered_size = rendered.size();
+    for (size_t i = 0; i < compiled.slots.size(); ++i) {
+        rendered += compiled.literals[i];
+        const compiled_template::variable_slot & slot = compiled.slots[i];
+        if (slot.var == compiled_template::empty_label) {
+            ADDWARNING(__func__,"empty variable label at position "+std::to_string(slot.pos)+" in template ("+compiled.source.substr(0,20)+')');
+            rendered += slot.raw;
+            render_error = rerr_empty_variable_label;
+            continue;
+        }
+        const std::string * value = values_by_index[slot.var];
+        if (value) {
+            rendered += *value;
         } else {
-            auto var_it = vars.find(vlabel);
-            if (var_it==vars.end()) {
-                if (skipmissing) {
-                    ADDWARNING(__func__,"no value specified for variable label {{ "+vlabel+" }} in template ("+temp.substr(0,20)+')');
-                    rendered += temp.substr(p, br_close - p + varclose.size());
-                    p = br_close + varclose.size();
-                    render_error = rerr_missing_value;
-
-                } else {
-                    ADDERROR(__func__,"no value specified for variable label {{ "+vlabel+" }} in template ("+temp.substr(0,20)+')');                    
-                    render_error = rerr_missing_value;
-                    return "";
-
-                }
+            const std::string & vlabel = compiled.varlabels[slot.var];
+            if (skipmissing) {
+                ADDWARNING(__func__,"no value specified for variable label {{ "+vlabel+" }} in template ("+compiled.source.substr(0,20)+')');
+                rendered += slot.raw;
+                render_error = rerr_missing_value;
+
             } else {
-                rendered += var_it->second.varvalue;
-                var_it->second.n_applied++;
-                p = br_close + varclose.size();
+                ADDERROR(__func__,"no value specified for variable label {{ "+vlabel+" }} in template ("+compiled.source.substr(0,20)+')');
+                render_error = rerr_missing_value;
+                rendered.resize(rendered_size);
+                return false;
+
             }
         }
     }
-    rendered += temp.substr(p);
+    rendered += compiled.literals.back();
+    return true;
+}
+
+static const std::string & varvalue_of(const template_variable_values & v) { return v.varvalue; }
+static const std::string & varvalue_of(const std::string & v) { return v; }
+
+/**
+ * Render a compiled template with values looked up once per distinct
+ * variable label, and report unused variable values.
+ */
+template <typename Varmap>
+bool render_environment::render_from_map(const compiled_template & compiled, const Varmap & vars, std::string & rendered, bool proceed_if_emptyvars) {
+    render_error = rerr_ok;
+
+    if (compiled.empty()) {
+        ADDWARNING(__func__,"empty template, unable to render "+std::to_string(vars.size())+" variables");
+        render_error = rerr_empty_template;
+        return true;
+    }
+
+    if ((!proceed_if_emptyvars) && (vars.empty())) {
+        ADDWARNING(__func__,"no variables to render into template ("+compiled.source.substr(0,20)+") [`proceed_if_emptyvars` can relax this requirement]");
+        render_error = rerr_no_variable_values;
+        rendered += compiled.source;
+        return true;
+    }
+
+    size_t n_applied = 0;
+    values_by_index.resize(compiled.varlabels.size());
+    for (size_t i = 0; i < compiled.varlabels.size(); ++i) {
+        auto var_it = vars.find(compiled.varlabels[i]);
+        if (var_it == vars.end()) {
+            values_by_index[i] = nullptr;
+        } else {
+            values_by_index[i] = &varvalue_of(var_it->second);
+            ++n_applied;
+        }
+    }
+
+    if (!render_slots(compiled, rendered)) {
+        return false;
+    }
 
-    for (auto v : vars) {
-        if (v.second.n_applied == 0) {
-            ADDWARNING(__func__,"unused variable value ("+v.first+','+v.second.varvalue+") with template ("+temp.substr(0,20)+')');
-            render_error = rerr_unused_variable_value;
+    if (n_applied < vars.size()) {
+        for (const auto & [ vlabel, value ] : vars) {
+            if (compiled.varindex.find(vlabel) == compiled.varindex.end()) {
+                ADDWARNING(__func__,"unused variable value ("+vlabel+','+varvalue_of(value)+") with template ("+compiled.source.substr(0,20)+')');
+                render_error = rerr_unused_variable_value;
+            }
         }
     }
 
+    return true;
+}
+
+/**
+ * Render a compiled template, appending the result to a reusable output
+ * string. Errors and warnings are as for rendering a template string.
+ * 
+ * @param compiled A compiled template.
+ * @param vars A map of variable names and variable values.
+ * @param rendered Reference to a string to which the result is appended (unchanged if error).
+ * @param proceed_if_emptyvars If true attempts to render even if `vars` is empty.
+ * @return False if rendering failed.
+ */
+bool render_environment::render(const compiled_template & compiled, const template_varvalues & vars, std::string & rendered, bool proceed_if_emptyvars) {
+    return render_from_map(compiled, vars, rendered, proceed_if_emptyvars);
+}
+
+/**
+ * Render a compiled template with values given by variable index (see
+ * `compiled_template::variable_index()`), appending the result to a
+ * reusable output string. Variables beyond the end of `values` are
+ * missing.
+ * 
+ * @param compiled A compiled template.
+ * @param values Variable values by variable index.
+ * @param rendered Reference to a string to which the result is appended (unchanged if error).
+ * @return False if rendering failed.
+ */
+bool render_environment::render(const compiled_template & compiled, const std::vector<std::string> & values, std::string & rendered) {
+    render_error = rerr_ok;
+
+    if (compiled.empty()) {
+        ADDWARNING(__func__,"empty template, unable to render "+std::to_string(values.size())+" variables");
+        render_error = rerr_empty_template;
+        return true;
+    }
+
+    values_by_index.resize(compiled.varlabels.size());
+    for (size_t i = 0; i < compiled.varlabels.size(); ++i) {
+        values_by_index[i] = (i < values.size()) ? &values[i] : nullptr;
+    }
+    return render_slots(compiled, rendered);
+}
+
+/**
+ * Render a compiled template into an output sink, which writes out its
+ * buffer as it fills.
+ * 
+ * @param compiled A compiled template.
+ * @param vars A map of variable names and variable values.
+ * @param sink The output sink to which the result is added.
+ * @param proceed_if_emptyvars If true attempts to render even if `vars` is empty.
+ * @return False if rendering failed.
+ */
+bool render_environment::render(const compiled_template & compiled, const template_varvalues & vars, render_sink & sink, bool proceed_if_emptyvars) {
+    bool rendered = render(compiled, vars, sink.buffer, proceed_if_emptyvars);
+    sink.flush_if_full();
     return rendered;
 }
 
+/**
+ * Write buffered content to the output stream.
+ * 
+ * @return True if the output stream is in a good state.
+ */
+bool render_sink::flush() {
+    if (!out) {
+        return true;
+    }
+    if (!buffer.empty()) {
+        out->write(buffer.data(), buffer.size());
+        num_written += buffer.size();
+        buffer.clear();
+    }
+    out->flush();
+    return out->good();
+}
+
+/**
+ * Write content that is at least as large as the buffer directly to the
+ * output stream, after writing out what is already buffered.
+ */
+render_sink & render_sink::write_through(const std::string & s) {
+    flush();
+    out->write(s.data(), s.size());
+    num_written += s.size();
+    return *this;
+}
+
 /**
  * Load a template.
  * 
@@ -172,4 +346,20 @@ bool render_environment::fill_preloaded_template_from_map(const std::string & pr
     return true;
 }
 
+/**
+ * Use a prepared map of template tags and template data to fill a compiled template.
+ * 
+ * Example: See how this is used in fzloghtml.
+ * 
+ * @param compiled The compiled template.
+ * @param tag_data_map A string:string map of tags and data.
+ * @param rendered Reference to a string to hold the filled template.
+ * @return True if successfully filled.
+ */
+bool render_environment::fill_compiled_template_from_map(const compiled_template & compiled, const std::map<std::string, std::string> & tag_data_map, std::string & rendered) {
+    rendered.clear();
+    render_from_map(compiled, tag_data_map, rendered, true);
+    return true;
+}
+
 } // namespace fz
@@ -8,6 +8,9 @@
 
 //#define USE_COMPILEDPING
 
+// std
+#include <fstream>
+
 // core
 #include "error.hpp"
 #include "general.hpp"
@@ -136,14 +139,19 @@ const std::map<td_property, std::string> td_property_class_map = {
  * Notes:
  * 1. Rendering of the head of the page is done after collecting the rendered
  *    Nodes, because some of the information in the head may require information
- *    that is collected along the way, such as 'days_rendered'.
+ *    that is collected along the way, such as 'days_rendered'. When the head
+ *    template does not use such information, the head is rendered first and
+ *    lines are streamed out as they are rendered (see prep()).
  */
 struct line_render_parameters {
     Graph *graph_ptr;                ///< Pointer to the Graph in which the Node resides.
     const std::string srclist;       ///< The Named Node List being rendered (or "" when that is not the case).
     render_environment env;          ///< Rendering environment in use.
     fzgraphhtml_templates templates; ///< Loaded rendering templates in use.
-    std::string rendered_page;       ///< String to which the rendered line is appended.
+    compiled_templates<template_id_enum> compiled; ///< Compiled templates for lines rendered repeatedly.
+    std::ofstream destfile;          ///< Output file, if streaming to a file.
+    render_sink rendered_page;       ///< Sink to which the rendered line is appended.
+    bool streaming = false;          ///< True if the head was rendered and lines are streamed out.
     std::string datestamp;
     std::string tdstamp;
     size_t actual_num_render = 0;
@@ -168,6 +176,7 @@ struct line_render_parameters {
         if (!load_templates(templates)) {
             standard_exit_error(exit_file_error, "Missing template file.", problem__func__);
         }
+        env.compile(templates, compiled);
         t_render = ActualTime();
     }
 
@@ -206,12 +215,17 @@ struct line_render_parameters {
 
     void prep(unsigned int num_render) {
         actual_num_render = num_render;
-        if (fzgh.config.embeddable) {
-            rendered_page.reserve(num_render * (2 * templates[node_pars_in_list_temp].size()));
+        // See Note 1.
+        if ((!fzgh.cache_it) && (fzgh.config.embeddable || (compiled[node_pars_in_list_head_temp].variable_index("days_shown") < 0))) {
+            rendered_page.out = open_output();
+            streaming = rendered_page.out != nullptr;
+        }
+        if (streaming) {
+            if (!fzgh.config.embeddable) {
+                rendered_page += rendered_head();
+            }
         } else {
-            rendered_page.reserve(num_render * (2 * templates[node_pars_in_list_temp].size()) +
-                            templates[node_pars_in_list_head_temp].size() +
-                            templates[node_pars_in_list_tail_temp].size());
+            rendered_page.buffer.reserve(num_render * (2 * templates[node_pars_in_list_temp].size()));
         }
         // 2026-01-24 Added -S arg specific test here so that having a default subtrees_list_name
         //            in config.json does not automatically include this.
@@ -259,7 +273,7 @@ struct line_render_parameters {
         varvals.emplace("fzserverpq","");
         //varvals.emplace("srclist","");
         varvals.emplace("do_link", "");
-        rendered_page += env.render(templates[node_pars_in_list_sep_temp], varvals);
+        env.render(compiled[node_pars_in_list_sep_temp], varvals, rendered_page);
         day_total_hrs = 0.0;
         for (auto & [ flag, hours ] : day_category_hrs) {
             day_category_hrs[flag] = 0.0;
@@ -288,7 +302,7 @@ struct line_render_parameters {
             varvals.emplace("fzserverpq","");
             //varvals.emplace("srclist","");
             varvals.emplace("do_link", "");
-            rendered_page += env.render(templates[node_pars_in_list_sep_temp], varvals);
+            env.render(compiled[node_pars_in_list_sep_temp], varvals, rendered_page);
         }
     }
 
@@ -380,12 +394,12 @@ struct line_render_parameters {
             varvals.emplace("list_pos", "");
             // -- Render
             if (fzgh.no_javascript) {
-                rendered_page += env.render(templates[node_pars_in_list_nojs_temp], varvals);
+                env.render(compiled[node_pars_in_list_nojs_temp], varvals, rendered_page);
             } else {
                 if (include_remove_button) {
-                    rendered_page += env.render(templates[node_pars_in_list_with_remove_temp], varvals);
+                    env.render(compiled[node_pars_in_list_with_remove_temp], varvals, rendered_page);
                 } else {
-                    rendered_page += env.render(templates[node_pars_in_list_temp], varvals);
+                    env.render(compiled[node_pars_in_list_temp], varvals, rendered_page);
                 }
             }
         }
@@ -556,15 +570,15 @@ struct line_render_parameters {
 
         // -- Render
         if (fzgh.test_cards) {
-            rendered_page += env.render(templates[node_pars_in_list_card_temp], varvals);
+            env.render(compiled[node_pars_in_list_card_temp], varvals, rendered_page);
         } else {
             if (fzgh.no_javascript) {
-                rendered_page += env.render(templates[node_pars_in_list_nojs_temp], varvals);
+                env.render(compiled[node_pars_in_list_nojs_temp], varvals, rendered_page);
             } else {
                 if (remove_button) {
-                    rendered_page += env.render(templates[node_pars_in_list_with_remove_temp], varvals);
+                    env.render(compiled[node_pars_in_list_with_remove_temp], varvals, rendered_page);
                 } else {
-                    rendered_page += env.render(templates[node_pars_in_list_temp], varvals);
+                    env.render(compiled[node_pars_in_list_temp], varvals, rendered_page);
                 }
             }
         }
@@ -593,7 +607,7 @@ struct line_render_parameters {
             varvals.emplace("add_to_node","");
         }
 
-        rendered_page += env.render(templates[topic_pars_in_list_temp], varvals);
+        env.render(compiled[topic_pars_in_list_temp], varvals, rendered_page);
     }
 
     void render_List(const std::string & list_name) {
@@ -621,31 +635,45 @@ struct line_render_parameters {
             }
             varvals.emplace("features", feature_str);
         }
-        rendered_page += env.render(templates[named_node_list_in_list_temp], varvals);
+        env.render(compiled[named_node_list_in_list_temp], varvals, rendered_page);
     }
 
-    bool send_to_output(const std::string& rendered_output) {
+    /// Returns the output stream selected by fzgh.config.rendered_out_path (or nullptr if none).
+    std::ostream * open_output() {
         if (fzgh.config.rendered_out_path == "STDOUT") {
-            FZOUT(rendered_output);
-        } else {
-            if (!string_to_file(fzgh.config.rendered_out_path, rendered_output))
-                ERRRETURNFALSE(__func__,"unable to write rendered page to file");
+            return base.out;
         }
-        return true;
+        destfile.open(fzgh.config.rendered_out_path);
+        if (!destfile) {
+            ADDERROR(__func__,"unable to write rendered page to file");
+            return nullptr;
+        }
+        return &destfile;
     }
 
     /**
-     * See Note 1 for the reason why the head is only generated here.
+     * See Note 1 for the reason why the head is usually only generated here.
      */
     bool present() {
+        if (!streaming) {
+            rendered_page.out = open_output();
+            if ((!rendered_page.out) && (fzgh.config.rendered_out_path != "STDOUT")) {
+                ERRRETURNFALSE(__func__,"unable to write rendered page to file");
+            }
+            if (!fzgh.config.embeddable) {
+                std::string rendered_lines(std::move(rendered_page.buffer));
+                rendered_page.buffer.clear();
+                rendered_page += rendered_head();
+                rendered_page += rendered_lines;
+            }
+        }
         if (!fzgh.config.embeddable) {
-            std::string rendered_page_with_head_and_tail;
-            rendered_page_with_head_and_tail.reserve(3000 + rendered_page.size());
-            rendered_page_with_head_and_tail = rendered_head() + rendered_page + rendered_tail();
-            return send_to_output(rendered_page_with_head_and_tail);
-        } else {
-            return send_to_output(rendered_page);
+            rendered_page += rendered_tail();
+        }
+        if (!rendered_page.flush()) {
+            ERRRETURNFALSE(__func__,"unable to write rendered page to file");
         }
+        return true;
     }
 
 };
@@ -787,7 +815,7 @@ bool render_named_node_list() {
     }
 
     if (fzgh.cache_it) {
-        fzgh.cache_str = std::move(lrp.rendered_page);
+        fzgh.cache_str = std::move(lrp.rendered_page.buffer);
         return true;
     } else {
         return lrp.present();
@@ -45,15 +45,15 @@ fzloghtml fzlh;
  * For `add_option_args`, add command line option identifiers as expected by `optarg()`.
  * For `add_usage_top`, add command line option usage format specifiers.
  * 
- * Command line arguments used: 12ABCDEFHNQRTVWacdefghijlnoqrstvwxz
- * Command line arguments still available: 03456789GIJKLMOPUXYZbkmpuy
+ * Command line arguments used: 12ABCDEFHNQRTVWacdefghijklnoqrstvwxz
+ * Command line arguments still available: 03456789GIJKLMOPUXYZbmpuy
  */
 fzloghtml::fzloghtml() : formalizer_standard_program(false), config(*this), flowcontrol(flow_log_interval), ga(*this, add_option_args, add_usage_top),
                          iscale(interval_none), interval(0), noframe(false), recent_format(most_recent_html) {
-    add_option_args += "e:n:g:l:1:2:a:o:D:H:w:Nc:rRf:x:ACi:jtF:T:IS:B:z";
+    add_option_args += "e:n:g:l:1:2:a:o:D:H:w:Nc:rRf:k:x:ACi:jtF:T:IS:B:z";
     add_usage_top += " [-e <log-stamp>] [-n <node-ID>] [-g <topic>] [-l <list-name>] [-I] [-1 <time-stamp-1>] [-2 <time-stamp-2>]"
                      " [-a <time-stamp>] [-D <days>|-H <hours>|-w <weeks>] [-o <outputfile>] [-N] [-c <num>] [-r] [-R]"
-                     " [-f <search-text>] [-x <regex-pattern>|FILE:<file-path>] [-A] [-C] [-B <BTF-flag>] [-z] [-i <date-stamp>]"
+                     " [-f <search-text>] [-k <search-words>] [-x <regex-pattern>|FILE:<file-path>] [-A] [-C] [-B <BTF-flag>] [-z] [-i <date-stamp>]"
                      " [-j] [-t] [-F <raw|txt|html>] [-T <file|'STR:string'>] [-S <selections-processor>]";
     usage_head.push_back("Generate HTML representation of requested Log records.\n");
     usage_tail.push_back(
@@ -87,6 +87,10 @@ fzloghtml::fzloghtml() : formalizer_standard_program(false), config(*this), flow
         "      <a href=\"@FZSERVER@/doc/lists/lists.html\">\n"
         "12. If the FILE: tag is encountered wiht the '-x' option then the RegEx\n"
         "    pattern is obtained from the specified file.\n"
+        "13. The '-k' option searches the Log entry text index for words, with\n"
+        "    '-A' for all of them, and loads only the Log chunks with matching\n"
+        "    entries within the interval. Use '_' to join words that must appear\n"
+        "    in sequence. Create the index with `fzquerypq -R logsearch`.\n"
         "\n"
         "Examples:\n"
         "\n"
@@ -126,6 +130,7 @@ void fzloghtml::usage_hook() {
           "    -r interval from most recent\n"
           "    -R most recent Log data\n"
           "    -f Filter by search text\n"
+          "    -k Find whole words in the Log entry text index\n"
           "    -x Use RegEx to filter by search text\n"
           "    -A All search terms must be in a Log chunk\n"
           "    -C Case insensitive search\n"
@@ -320,6 +325,14 @@ bool fzloghtml::options_hook(char c, std::string cargs) {
         return true;
     }
 
+    case 'k': {
+        index_search.terms = parse_search_strings(cargs);
+        for (auto & term : index_search.terms) {
+            std::replace(term.begin(), term.end(), '_', ' '); // words in sequence
+        }
+        return true;
+    }
+
     case 'x': {
         regex_pattern = parse_regex_pattern(cargs);
         if (regex_pattern.empty()) return false;
@@ -563,7 +576,14 @@ time_t fzloghtml::time_zone_adjusted(time_t t) {
 
 bool fzloghtml::get_Log_interval() {
 
-    edata.log_ptr = ga.request_Log_excerpt(filter);
+    if (!index_search.terms.empty()) {
+        index_search.all_terms = mustcontainall;
+        index_search.t_from = filter.t_from;
+        index_search.t_to = filter.t_to;
+        edata.log_ptr = ga.request_Log_search_excerpt(index_search);
+    } else {
+        edata.log_ptr = ga.request_Log_excerpt(filter);
+    }
 
     if (!edata.log_ptr) {
         standard_error("Missing Log excerpt.", __func__);
@@ -101,6 +101,8 @@ struct fzloghtml: public formalizer_standard_program {
     bool mustcontainall = false;
     bool caseinsensitive = false;
 
+    Log_search index_search;
+
     Boolean_Tag_Flags::boolean_flag btf = Boolean_Tag_Flags::none;
 
     std::string regex_pattern;
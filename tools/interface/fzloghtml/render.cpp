@@ -12,6 +12,7 @@
 #endif
 
 // std
+#include <fstream>
 #include <locale>
 
 // core
@@ -195,7 +196,7 @@ const std::vector<std::string> special_urls = {
     "@FZSERVER@"
 };
 
-std::string render_Log_entry(Log_entry & entry, std::locale & loc, const std::string & active_entry_template) {
+std::string render_Log_entry(Log_entry & entry, std::locale & loc, const compiled_template & active_entry_template) {
     std::map<std::string, std::string> log_entry_data = {
         { "minor_id", std::to_string(entry.get_minor_id()) },
         { "entry_id", entry.get_id_str() },
@@ -240,7 +241,7 @@ std::string render_Log_entry(Log_entry & entry, std::locale & loc, const std::st
     }
 
     std::string rendered_entry;
-    if (!env.fill_preloaded_template_from_map(active_entry_template, log_entry_data, rendered_entry)) {
+    if (!env.fill_compiled_template_from_map(active_entry_template, log_entry_data, rendered_entry)) {
         return "";
     }
     return rendered_entry;
@@ -260,6 +261,43 @@ bool send_rendered_to_output(std::string & rendered_text) {
     return true;
 }
 
+/**
+ * Open the destination for rendered content that is streamed out while
+ * it is rendered (see `render_sink`).
+ * 
+ * @param destfile File stream to open if the destination is a file.
+ * @return Pointer to the output stream.
+ */
+std::ostream * open_output_stream(std::ofstream & destfile) {
+    if ((fzlh.config.dest.empty()) || (fzlh.config.dest == "STDOUT")) { // to STDOUT
+        return base.out;
+    }
+
+    destfile.open(fzlh.config.dest);
+    if (!destfile) {
+        ADDERROR(__func__,"unable to write to "+fzlh.config.dest);
+        standard.exit(exit_file_error);
+    }
+    return &destfile;
+}
+
+/**
+ * Write out the remainder of streamed rendered content.
+ * 
+ * @param sink Output sink that was prepared with `open_output_stream()`.
+ * @return True if successful.
+ */
+bool finish_streamed_output(render_sink & sink) {
+    if (!sink.flush()) {
+        ADDERROR(__func__,"unable to write to "+fzlh.config.dest);
+        standard.exit(exit_file_error);
+    }
+    if ((!fzlh.config.dest.empty()) && (fzlh.config.dest != "STDOUT")) {
+        VERBOSEOUT("Rendered content written to "+fzlh.config.dest+".\n\n");
+    }
+    return true;
+}
+
 /**
  * At a minimum, show the Node ID. Depending on configuration and available
  * memory-resident Graph, also show a short exerpt of Node description.
@@ -500,23 +538,32 @@ bool render_Log_interval() {
         }
     }
 
-    report_interval();
+    // Chunk and entry templates are rendered many times, so they are compiled once.
+    compiled_template compiled_chunk_template, compiled_entry_template;
+    env.compile(customtemplate.empty() ? active_chunk_template : customtemplate, compiled_chunk_template);
+    env.compile(active_entry_template, compiled_entry_template);
 
-    // Prepare rendering head
-
-    std::string rendered_logcontent;
-    rendered_logcontent.reserve(256*1024);
-
-    std::string render_notes;
+    report_interval();
 
+    std::string head_template, tail_template;
     if (!fzlh.noframe) {
-        std::string head_template;
         if (!env.load_template(template_path_from_id(LogHTML_head_temp), head_template)) {
             return false;
         }
-        rendered_logcontent += head_template;
+        if (!env.load_template(template_path_from_id(LogHTML_tail_temp), tail_template)) {
+            return false;
+        }
     }
 
+    // Prepare rendering head
+
+    std::ofstream destfile;
+    render_sink rendered_logcontent(open_output_stream(destfile));
+
+    std::string render_notes;
+
+    rendered_logcontent += head_template;
+
     if (fzlh.show_total_time_applied) {
         std::string time_applied_str = std::to_string(fzlh.total_minutes_applied/60) + ':' + std::to_string(fzlh.total_minutes_applied % 60);
         rendered_logcontent += "<tr><td><p><b>Actual time applied to Log Chunks: "+time_applied_str+"<b></p></td></tr>\n";
@@ -632,7 +679,7 @@ bool render_Log_interval() {
                     }
                 }
                 if (fzlh.recent_format != most_recent_json) {
-                    combined_entries += render_Log_entry(*entryptr, loc, active_entry_template);
+                    combined_entries += render_Log_entry(*entryptr, loc, compiled_entry_template);
                 }
             }
         }
@@ -710,13 +757,9 @@ bool render_Log_interval() {
         }
         varvals.emplace("entries",combined_entries);
         if (fzlh.get_log_entry && fzlh.noframe && (fzlh.recent_format == most_recent_raw)) {
-            rendered_logcontent = combined_entries; // very minimal output
+            rendered_logcontent.buffer = combined_entries; // very minimal output (never large enough to have been written out)
         } else {
-            if (customtemplate.empty()) {
-                rendered_logcontent += env.render(active_chunk_template, varvals);
-            } else {
-                rendered_logcontent += env.render(customtemplate, varvals);
-            }
+            env.render(compiled_chunk_template, varvals, rendered_logcontent);
         }
 
     }
@@ -735,19 +778,13 @@ bool render_Log_interval() {
         rendered_logcontent += "<tr><td><hr><pre>"+render_notes+"</pre></td></tr>\n";
     }
 
-    if (!fzlh.noframe) {
-        std::string tail_template;
-        if (!env.load_template(template_path_from_id(LogHTML_tail_temp), tail_template)) {
-            return false;
-        }
-        rendered_logcontent += tail_template;
-    }
+    rendered_logcontent += tail_template;
 
     if (fzlh.recent_format == most_recent_json) {
         rendered_logcontent += data.json_str();
     }
     
-    return send_rendered_to_output(rendered_logcontent);
+    return finish_streamed_output(rendered_logcontent);
 }
 
 const std::map<most_recent_format, template_id_enum> log_most_recent_tmap = {
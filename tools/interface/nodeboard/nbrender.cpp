@@ -784,7 +784,11 @@ std::string nodeboard::encode_modified_topic_filters(bool _shownonmilestone) con
 }
 
 bool nodeboard::render_init() {
-    return load_templates(templates);
+    if (!load_templates(templates)) {
+        return false;
+    }
+    env.compile(templates, compiled);
+    return true;
 }
 
 bool nodeboard::to_output(const std::string & rendered_board) {
@@ -874,7 +878,7 @@ bool nodeboard::get_Node_card(const Node * node_ptr, std::string & rendered_card
     nodevars.emplace("filter-substr", include_filter_substr);
 
     // For each node: Create a Kanban card and add it to the output HTML.
-    rendered_cards += env.render(templates[node_card_temp], nodevars);
+    env.render(compiled[node_card_temp], nodevars, rendered_cards);
     return true;
 }
 
@@ -1125,9 +1129,9 @@ Node_render_result nodeboard::get_Node_alt_card(const Node * node_ptr, std::time
 
     // For each node: Create a Kanban card and add it to the output HTML.
     if (progress_analysis) {
-        rendered_cards += env.render(templates[node_analysis_card_temp], nodevars);
+        env.render(compiled[node_analysis_card_temp], nodevars, rendered_cards);
     } else {
-        rendered_cards += env.render(templates[node_alt_card_temp], nodevars);
+        env.render(compiled[node_alt_card_temp], nodevars, rendered_cards);
     }
     if (node_ptr->is_active()) {
         return node_rendered_active;
@@ -1213,7 +1217,7 @@ bool nodeboard::get_Schedule_card(const CSV_Data & entry_data, std::string & ren
     nodevars.emplace("fzserverpq", graph().get_server_full_address());
 
     // For each node: Create a Kanban card and add it to the output HTML.
-    rendered_cards += env.render(templates[schedule_card_temp], nodevars);
+    env.render(compiled[schedule_card_temp], nodevars, rendered_cards);
     return true;
 }
 
@@ -1225,7 +1229,7 @@ bool nodeboard::get_column(const std::string & column_header, const std::string
     column.emplace("column-cards", rendered_cards);
 
     // For each node: Create a Kanban card and add it to the output HTML.
-    rendered_columns += env.render(templates[column_template], column);
+    env.render(compiled[column_template], column, rendered_columns);
     num_columns++;
     return true;
 }
@@ -1285,13 +1289,36 @@ In fzloghtml, this is done by:
 6. total_minutes_applied = Chunks_total_minutes(edata.log_ptr->get_Chunks());
 */
 
+/**
+ * Obtain the total logged minutes of many Nodes with a single request, so
+ * that rendering a board with progress analysis does not need a Log excerpt
+ * per Node card.
+ * 
+ * @param nodes The set of Nodes that will be shown with progress analysis.
+ * @return True if the totals were obtained.
+ */
+bool nodeboard::prefetch_Node_total_minutes_applied(const base_Node_Set & nodes) {
+    base_Node_Set missing;
+    for (const auto & nkey : nodes) {
+        if (minutes_applied.find(nkey) == minutes_applied.end()) {
+            missing.emplace(nkey);
+        }
+    }
+    return ga.request_Nodes_logged_minutes(missing, (t_before > 0) ? t_before : RTt_unspecified, minutes_applied);
+}
+
 unsigned long nodeboard::get_Node_total_minutes_applied(const Node_ID_key nkey) {
-    filter.nkey = nkey;
-    if (t_before > 0) {
-        filter.t_to = t_before;
+    auto it = minutes_applied.find(nkey);
+    if (it == minutes_applied.end()) {
+        if (!prefetch_Node_total_minutes_applied({ nkey })) {
+            standard_exit_error(exit_database_error, "Unable to obtain logged time of Node "+nkey.str(), __func__);
+        }
+        it = minutes_applied.find(nkey);
+        if (it == minutes_applied.end()) {
+            return 0;
+        }
     }
-    std::unique_ptr<Log> log_uptr = ga.request_Log_excerpt(filter);
-    return Chunks_total_minutes(log_uptr->get_Chunks());
+    return it->second;
 }
 
 void nodeboard::progress_state_update() {
@@ -2061,6 +2088,16 @@ bool node_board_render_NNL_dependencies(nodeboard & nb) {
         nb.node_total = nb.map_of_subtrees.total_node_count();
     }
 
+    if (nb.progress_analysis) {
+        base_Node_Set subtree_nodes;
+        for (const auto & [subtree_key, subtree] : nb.map_of_subtrees.map_of_subtrees) {
+            for (const auto & [nkey, branch] : subtree.map_by_key) {
+                subtree_nodes.emplace(nkey);
+            }
+        }
+        nb.prefetch_Node_total_minutes_applied(subtree_nodes);
+    }
+
     Threads_Board_Data data;
     data.nnl = nb.list_name;
 
@@ -218,9 +218,11 @@ struct nodeboard: public formalizer_standard_program {
     Graph *graph_ptr;
 
     Log_filter filter;
+    Node_minutes_map minutes_applied; ///< Total logged minutes obtained in batches (see prefetch_Node_total_minutes_applied()).
 
     render_environment env;
     nodeboard_templates templates;
+    compiled_templates<template_id_enum> compiled; ///< Compiled templates for cards and columns.
 
     unsigned int num_columns = 0;
     unsigned int num_rows = 0;
@@ -283,6 +285,8 @@ struct nodeboard: public formalizer_standard_program {
 
     bool get_dependencies_column(const std::string & column_header, const Node * column_node, std::string & rendered_columns, const std::string extra_header);
 
+    bool prefetch_Node_total_minutes_applied(const base_Node_Set & nodes);
+
     unsigned long get_Node_total_minutes_applied(const Node_ID_key nkey);
 
     void progress_state_update();